@@ -0,0 +1,402 @@
+// EncoderBench.cpp - Encoder throughput benchmark over the quality presets
+// Find out which presets this box can record in real time before the show, not during
+
+#include "recorder/VideoRecorder.hpp"
+#include "recorder/EncoderSettings.hpp"
+#include "core/Logger.hpp"
+#include "util/FileUtils.hpp"
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+#include <toml++/toml.h>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace vc;
+
+namespace {
+
+struct BenchOptions {
+    u32 frames{240};
+    std::string filter;     // Substring of the preset name
+    fs::path outputDir;
+    fs::path jsonPath;      // Empty = stdout
+    bool keep{false};
+    bool sweep{false};      // Also try every x264/x265 speed preset
+};
+
+struct BenchCase {
+    std::string name;
+    EncoderSettings settings;
+};
+
+// Distinct synthetic frames cycled through the encoder; enough that
+// inter prediction can't just copy the previous frame
+constexpr u32 SYNTHETIC_FRAME_COUNT = 8;
+
+void printUsage() {
+    std::cerr << R"(vibechad-encoder-bench - Encoder throughput over the quality presets
+
+Usage: vibechad-encoder-bench [options]
+
+Options:
+  -h, --help              Show this help message
+  -n, --frames <count>    Frames per preset (default 240)
+  -f, --filter <text>     Only presets whose name contains <text>
+  -o, --output-dir <dir>  Where encoded files go (default /dev/shm or temp dir)
+  -j, --json <path>       Write results to <path> instead of stdout
+  -k, --keep              Keep encoded files
+  -s, --sweep             Also run every x264/x265 speed preset per entry
+
+Each preset runs in its own process so peak RSS and CPU time don't leak between runs.
+)";
+}
+
+Result<BenchOptions> parseArgs(int argc, char* argv[]) {
+    BenchOptions opts;
+    opts.outputDir = fs::is_directory("/dev/shm") ? fs::path("/dev/shm") : fs::temp_directory_path();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            std::exit(0);
+        }
+        else if (arg == "-n" || arg == "--frames") {
+            if (!hasValue) return Result<BenchOptions>::err("--frames requires a count");
+            opts.frames = static_cast<u32>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "-f" || arg == "--filter") {
+            if (!hasValue) return Result<BenchOptions>::err("--filter requires a name");
+            opts.filter = argv[++i];
+        }
+        else if (arg == "-o" || arg == "--output-dir") {
+            if (!hasValue) return Result<BenchOptions>::err("--output-dir requires a path");
+            opts.outputDir = argv[++i];
+        }
+        else if (arg == "-j" || arg == "--json") {
+            if (!hasValue) return Result<BenchOptions>::err("--json requires a path");
+            opts.jsonPath = argv[++i];
+        }
+        else if (arg == "-k" || arg == "--keep") {
+            opts.keep = true;
+        }
+        else if (arg == "-s" || arg == "--sweep") {
+            opts.sweep = true;
+        }
+        else {
+            return Result<BenchOptions>::err(std::string("Unknown option: ") + std::string(arg));
+        }
+    }
+
+    return Result<BenchOptions>::ok(std::move(opts));
+}
+
+std::vector<BenchCase> buildCases(const BenchOptions& opts) {
+    std::vector<BenchCase> cases;
+
+    for (const auto& preset : getQualityPresets()) {
+        if (!opts.filter.empty() && preset.name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+
+        cases.push_back({preset.name, preset.settings});
+
+        const auto& video = preset.settings.video;
+        bool x26x = video.codec == VideoCodec::H264 || video.codec == VideoCodec::H265;
+        if (!opts.sweep || !x26x) continue;
+
+        for (int p = static_cast<int>(EncoderPreset::Ultrafast);
+             p <= static_cast<int>(EncoderPreset::Veryslow); ++p) {
+            if (p == static_cast<int>(video.preset)) continue;
+
+            BenchCase variant{preset.name, preset.settings};
+            variant.settings.video.preset = static_cast<EncoderPreset>(p);
+            variant.name += " @" + variant.settings.video.presetName();
+            cases.push_back(std::move(variant));
+        }
+    }
+
+    return cases;
+}
+
+// Plasma with a little grain, roughly what a busy preset looks like to an encoder
+std::vector<std::vector<u8>> makeSyntheticFrames(u32 width, u32 height) {
+    std::vector<std::vector<u8>> frames(SYNTHETIC_FRAME_COUNT);
+    u32 seed = 0x9e3779b9u;
+
+    for (u32 f = 0; f < frames.size(); ++f) {
+        auto& data = frames[f];
+        data.resize(static_cast<usize>(width) * height * 4);
+        f32 t = static_cast<f32>(f) * 0.35f;
+
+        for (u32 y = 0; y < height; ++y) {
+            u8* row = data.data() + static_cast<usize>(y) * width * 4;
+            f32 fy = static_cast<f32>(y) / height;
+
+            for (u32 x = 0; x < width; ++x) {
+                f32 fx = static_cast<f32>(x) / width;
+                f32 v = std::sin(fx * 12.0f + t) +
+                        std::sin(fy * 9.0f - t * 1.3f) +
+                        std::sin((fx + fy) * 7.0f + t * 0.7f);
+
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                int grain = static_cast<int>(seed & 0x0f);
+
+                int base = static_cast<int>(120.0f + 36.0f * v);
+                row[x * 4 + 0] = static_cast<u8>(std::clamp(base + grain, 0, 255));
+                row[x * 4 + 1] = static_cast<u8>(std::clamp(255 - base + grain, 0, 255));
+                row[x * 4 + 2] = static_cast<u8>(std::clamp(base / 2 + 64 + grain, 0, 255));
+                row[x * 4 + 3] = 255;
+            }
+        }
+    }
+
+    return frames;
+}
+
+std::string fileSafe(const std::string& name) {
+    std::string out;
+    for (char c : name) {
+        out += std::isalnum(static_cast<unsigned char>(c))
+               ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : '_';
+    }
+    return out;
+}
+
+f64 seconds(const timeval& tv) {
+    return static_cast<f64>(tv.tv_sec) + static_cast<f64>(tv.tv_usec) / 1e6;
+}
+
+std::string toJson(const toml::table& tbl) {
+    std::ostringstream ss;
+    ss << toml::json_formatter{tbl};
+    return ss.str();
+}
+
+toml::table describeCase(const BenchCase& bc) {
+    const auto& s = bc.settings;
+    return toml::table{
+        {"name", bc.name},
+        {"codec", s.video.codecName()},
+        {"preset", s.video.presetName()},
+        {"pixel_format", s.video.pixelFormatName()},
+        {"container", s.containerExtension().substr(1)},
+        {"width", static_cast<i64>(s.video.width)},
+        {"height", static_cast<i64>(s.video.height)},
+        {"target_fps", static_cast<i64>(s.video.fps)},
+    };
+}
+
+// Runs in the forked child
+toml::table runCase(const BenchCase& bc, const BenchOptions& opts) {
+    toml::table result = describeCase(bc);
+
+    EncoderSettings settings = bc.settings;
+    settings.adaptiveQuality = false;  // Measure the preset as configured
+    settings.outputPath = opts.outputDir / ("vibechad_bench_" + fileSafe(bc.name) +
+                                            settings.containerExtension());
+
+    u32 width = settings.video.width;
+    u32 height = settings.video.height;
+    auto frames = makeSyntheticFrames(width, height);
+
+    VideoRecorder recorder;
+
+    rusage before{};
+    getrusage(RUSAGE_SELF, &before);
+    auto start = std::chrono::steady_clock::now();
+
+    if (auto res = recorder.start(settings); !res) {
+        result.insert("error", res.error().message);
+        return result;
+    }
+
+    // Synchronous path: conversion, encode and mux on this thread
+    for (u32 i = 0; i < opts.frames; ++i) {
+        recorder.submitVideoFrame(frames[i % frames.size()].data(), width, height, 0);
+    }
+    recorder.stop();
+
+    f64 wall = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    rusage after{};
+    getrusage(RUSAGE_SELF, &after);
+
+    const auto& stats = recorder.stats();
+    f64 written = static_cast<f64>(std::max<u64>(stats.framesWritten, 1));
+    f64 fps = wall > 0.0 ? stats.framesWritten / wall : 0.0;
+    f64 cpuUser = seconds(after.ru_utime) - seconds(before.ru_utime);
+    f64 cpuSys = seconds(after.ru_stime) - seconds(before.ru_stime);
+    f64 mediaSeconds = static_cast<f64>(stats.framesWritten) / settings.video.fps;
+
+    result.insert("frames", static_cast<i64>(stats.framesWritten));
+    result.insert("wall_s", wall);
+    result.insert("fps", fps);
+    result.insert("realtime_factor", fps / settings.video.fps);
+    result.insert("realtime", fps >= settings.video.fps);
+    result.insert("cpu_user_s", cpuUser);
+    result.insert("cpu_sys_s", cpuSys);
+    result.insert("cpu_cores_used", wall > 0.0 ? (cpuUser + cpuSys) / wall : 0.0);
+    result.insert("stage_ms_per_frame", toml::table{
+        {"convert", stats.convertMs / written},
+        {"encode", stats.encodeMs / written},
+        {"mux", stats.muxMs / written},
+    });
+    result.insert("bytes", static_cast<i64>(stats.bytesWritten));
+    result.insert("bytes_per_sec", wall > 0.0 ? stats.bytesWritten / wall : 0.0);
+    result.insert("bitrate_kbps", mediaSeconds > 0.0 ? stats.bytesWritten * 8.0 / 1000.0 / mediaSeconds : 0.0);
+    result.insert("peak_rss_kb", static_cast<i64>(after.ru_maxrss));
+    result.insert("synthetic_frames_kb",
+                  static_cast<i64>(frames.size() * frames.front().size() / 1024));
+
+    if (!opts.keep) {
+        std::error_code ec;
+        fs::remove(settings.outputPath, ec);
+    }
+
+    return result;
+}
+
+std::string runIsolated(const BenchCase& bc, const BenchOptions& opts) {
+    auto failure = [&](const std::string& why) {
+        toml::table tbl = describeCase(bc);
+        tbl.insert("error", why);
+        return toJson(tbl);
+    };
+
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return failure("pipe() failed");
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return failure("fork() failed");
+    }
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        std::string json = toJson(runCase(bc, opts));
+
+        const char* p = json.data();
+        usize left = json.size();
+        while (left > 0) {
+            ssize_t n = ::write(fds[1], p, left);
+            if (n <= 0) break;
+            p += n;
+            left -= static_cast<usize>(n);
+        }
+        ::close(fds[1]);
+        ::_exit(0);
+    }
+
+    ::close(fds[1]);
+    std::string json;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fds[0], buf, sizeof(buf))) > 0) {
+        json.append(buf, static_cast<usize>(n));
+    }
+    ::close(fds[0]);
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+
+    if (WIFSIGNALED(status)) {
+        return failure("crashed with signal " + std::to_string(WTERMSIG(status)));
+    }
+    if (json.empty()) {
+        return failure("no result");
+    }
+    return json;
+}
+
+std::string cpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            auto colon = line.find(':');
+            if (colon != std::string::npos) {
+                return line.substr(line.find_first_not_of(' ', colon + 1));
+            }
+        }
+    }
+    return "unknown";
+}
+
+toml::table hostInfo(const BenchOptions& opts) {
+    char hostname[256] = {};
+    ::gethostname(hostname, sizeof(hostname) - 1);
+
+    return toml::table{
+        {"hostname", std::string(hostname)},
+        {"cpu", cpuModel()},
+        {"threads", static_cast<i64>(std::thread::hardware_concurrency())},
+        {"ffmpeg", std::string(av_version_info())},
+        {"frames_per_preset", static_cast<i64>(opts.frames)},
+        {"output_dir", opts.outputDir.string()},
+    };
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto parsed = parseArgs(argc, argv);
+    if (!parsed) {
+        std::cerr << parsed.error().message << "\n\n";
+        printUsage();
+        return 1;
+    }
+    const auto& opts = *parsed;
+
+    Logger::init("vibechad-bench", false);
+
+    if (!fs::is_directory(opts.outputDir)) {
+        std::cerr << "Output directory does not exist: " << opts.outputDir << "\n";
+        return 1;
+    }
+
+    auto cases = buildCases(opts);
+    if (cases.empty()) {
+        std::cerr << "No presets match '" << opts.filter << "'\n";
+        return 1;
+    }
+
+    std::string json = "{\n\"host\": " + toJson(hostInfo(opts)) + ",\n\"results\": [\n";
+    for (usize i = 0; i < cases.size(); ++i) {
+        std::cerr << "[" << (i + 1) << "/" << cases.size() << "] " << cases[i].name << std::endl;
+        json += runIsolated(cases[i], opts);
+        json += i + 1 < cases.size() ? ",\n" : "\n";
+    }
+    json += "]\n}\n";
+
+    if (opts.jsonPath.empty()) {
+        std::cout << json;
+    } else if (auto res = file::writeText(opts.jsonPath, json); !res) {
+        std::cerr << res.error().message << "\n";
+        return 1;
+    }
+
+    Logger::shutdown();
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "AlbumArtCache.hpp"
+#include "MediaMetadata.hpp"
+
+#include <QBuffer>
+#include <QImageReader>
+#include <algorithm>
+
+namespace vc {
+
+namespace {
+
+u64 fnv1a(const QByteArray& data) {
+    u64 hash = 14695981039346656037ull;
+    for (char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Decode at (about) the target size: JPEG can skip most of the work
+// when told the output size up front
+QImage decode(QByteArray& data, u32 size) {
+    QBuffer buffer(&data);
+    QImageReader reader(&buffer);
+    
+    QSize full = reader.size();
+    QSize target(static_cast<int>(size), static_cast<int>(size));
+    if (full.isValid() && (full.width() > target.width() || full.height() > target.height())) {
+        reader.setScaledSize(full.scaled(target, Qt::KeepAspectRatio));
+    }
+    
+    QImage image = reader.read();
+    if (image.width() > target.width() || image.height() > target.height()) {
+        image = image.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+} // namespace
+
+AlbumArtCache::AlbumArtCache(usize budgetBytes)
+    : budget_(budgetBytes)
+{
+}
+
+AlbumArtCache::~AlbumArtCache() {
+    std::lock_guard lock(mutex_);
+    queue_.clear();
+}
+
+std::optional<QImage> AlbumArtCache::find(const fs::path& track, u32 size) {
+    std::lock_guard lock(mutex_);
+    
+    auto cover = coverOf_.find(track.native());
+    if (cover != coverOf_.end()) {
+        if (cover->second == 0) return std::nullopt;  // Read before, no art
+        
+        auto it = entries_.find({cover->second, size});
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->image;
+        }
+    }
+    
+    if (queued_.emplace(track.native(), size).second) {
+        queue_.emplace_back(track, size);
+        if (!worker_.joinable()) {
+            worker_ = std::jthread([this](std::stop_token stop) { run(stop); });
+        }
+        wake_.notify_one();
+    }
+    return std::nullopt;
+}
+
+void AlbumArtCache::setBudget(usize bytes) {
+    std::lock_guard lock(mutex_);
+    budget_ = bytes;
+    evict();
+}
+
+usize AlbumArtCache::bytes() const {
+    std::lock_guard lock(mutex_);
+    return bytes_;
+}
+
+void AlbumArtCache::run(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        std::pair<fs::path, u32> job;
+        {
+            std::unique_lock lock(mutex_);
+            if (!wake_.wait(lock, stop, [this] { return !queue_.empty(); })) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        const auto& [track, size] = job;
+        
+        // Hashing the encoded bytes finds a shared cover before decoding it
+        auto data = MetadataReader::readAlbumArt(track);
+        u64 hash = data ? std::max<u64>(fnv1a(*data), 1) : 0;
+        
+        bool cached;
+        {
+            std::lock_guard lock(mutex_);
+            coverOf_[track.native()] = hash;
+            cached = hash == 0 || entries_.contains({hash, size});
+        }
+        
+        QImage image;
+        if (!cached) {
+            image = decode(*data, size);
+            if (image.isNull()) hash = 0;
+        }
+        
+        {
+            std::lock_guard lock(mutex_);
+            queued_.erase({track.native(), size});
+            if (hash == 0) {
+                coverOf_[track.native()] = 0;
+                continue;
+            }
+            if (!cached) {
+                insert({hash, size}, std::move(image));
+            }
+        }
+        
+        ready.emitSignal(track);
+    }
+}
+
+void AlbumArtCache::insert(const Key& key, QImage image) {
+    if (entries_.contains(key)) return;
+    
+    bytes_ += static_cast<usize>(image.sizeInBytes());
+    lru_.push_front({key, std::move(image)});
+    entries_.emplace(key, lru_.begin());
+    evict();
+}
+
+void AlbumArtCache::evict() {
+    // The newest entry stays even if it alone is over budget
+    while (bytes_ > budget_ && lru_.size() > 1) {
+        auto& victim = lru_.back();
+        bytes_ -= static_cast<usize>(victim.image.sizeInBytes());
+        entries_.erase(victim.key);
+        lru_.pop_back();
+    }
+}
+
+} // namespace vc
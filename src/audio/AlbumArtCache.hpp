@@ -0,0 +1,75 @@
+#pragma once
+// AlbumArtCache.hpp - Cover art, decoded on demand at the size it's shown
+// A 1500px cover per track times a 2000-track playlist is not a feature
+
+#include "util/Types.hpp"
+#include "util/Signal.hpp"
+
+#include <QImage>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace vc {
+
+// Art is read from the track on a worker thread, decoded straight to the
+// requested size and kept in an LRU bounded by bytes. Covers are keyed by
+// a hash of the embedded image, so an album's tracks share one copy.
+class AlbumArtCache {
+public:
+    static constexpr usize DEFAULT_BUDGET = 32u << 20;
+    
+    explicit AlbumArtCache(usize budgetBytes = DEFAULT_BUDGET);
+    ~AlbumArtCache();
+    
+    // Non-copyable
+    AlbumArtCache(const AlbumArtCache&) = delete;
+    AlbumArtCache& operator=(const AlbumArtCache&) = delete;
+    
+    // The track's art scaled to fit size x size, if it's cached. A miss
+    // queues a load and `ready` fires when it's in; tracks without art
+    // stay a miss without being read again. Any thread.
+    std::optional<QImage> find(const fs::path& track, u32 size);
+    
+    void setBudget(usize bytes);
+    usize bytes() const;
+    
+    // Emitted on the worker thread once a requested image is cached
+    Signal<const fs::path&> ready;
+    
+private:
+    struct Key {
+        u64 hash;
+        u32 size;
+        bool operator==(const Key&) const = default;
+    };
+    struct KeyHash {
+        usize operator()(const Key& key) const { return key.hash ^ (u64(key.size) << 48); }
+    };
+    struct Entry {
+        Key key;
+        QImage image;
+    };
+    
+    void run(std::stop_token stop);
+    void insert(const Key& key, QImage image);  // Locked
+    void evict();                               // Locked
+    
+    usize budget_;
+    usize bytes_{0};
+    std::list<Entry> lru_;                                          // Front = most recent
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entries_;
+    std::unordered_map<std::string, u64> coverOf_;                  // Track -> hash, 0 = no art
+    
+    std::deque<std::pair<fs::path, u32>> queue_;
+    std::set<std::pair<std::string, u32>> queued_;
+    mutable std::mutex mutex_;
+    std::condition_variable_any wake_;
+    std::jthread worker_;
+};
+
+} // namespace vc
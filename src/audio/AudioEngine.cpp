@@ -50,6 +50,18 @@ Result<void> AudioEngine::init() {
         onPlaylistCurrentChanged(index);
     });
     
+    // Tags are read on the importer's threads; apply them here, a batch at a time
+    playlist_.importer().imported.connect([this](const std::vector<ImportedTrack>& tracks) {
+        QMetaObject::invokeMethod(this, [this, tracks] {
+            playlist_.applyMetadata(tracks);
+        });
+    });
+    
+    // Late tags for the playing track: refresh what shows it, don't reload it
+    playlist_.currentMetadataChanged.connect([this] {
+        trackChanged.emitSignal();
+    });
+    
     LOG_INFO("Audio engine initialized");
     return Result<void>::ok();
 }
@@ -187,9 +199,14 @@ void AudioEngine::processAudioBuffer(const QAudioBuffer& buffer) {
         }
     }
     
+    if (samples.empty()) return;
+    
     // Analyze audio
     currentSpectrum_ = analyzer_.analyze(samples, sampleRate, channels);
     spectrumUpdated.emitSignal(currentSpectrum_);
+    
+    // Raw PCM for anyone recording it
+    pcmReceived.emitSignal(samples, static_cast<u32>(channels), static_cast<u32>(sampleRate));
 }
 
 } // namespace vc
@@ -7,6 +7,7 @@
 #include "util/Signal.hpp"
 #include "AudioAnalyzer.hpp"
 #include "Playlist.hpp"
+#include "AlbumArtCache.hpp"
 
 #include <QMediaPlayer>
 #include <QAudioOutput>
@@ -52,6 +53,9 @@ public:
     Playlist& playlist() { return playlist_; }
     const Playlist& playlist() const { return playlist_; }
     
+    // Cover art for any track, loaded when asked for
+    AlbumArtCache& albumArt() { return albumArt_; }
+    
     // Audio analysis for visualizer
     const AudioSpectrum& currentSpectrum() const { return currentSpectrum_; }
     const std::vector<f32>& currentPCM() const { return analyzer_.pcmData(); }
@@ -61,6 +65,7 @@ public:
     Signal<Duration> positionChanged;
     Signal<Duration> durationChanged;
     Signal<const AudioSpectrum&> spectrumUpdated;
+    Signal<const std::vector<f32>&, u32, u32> pcmReceived;  // Interleaved samples, channels, rate
     Signal<> trackChanged;
     Signal<std::string> error;
     
@@ -82,6 +87,7 @@ private:
     std::unique_ptr<QAudioBufferOutput> bufferOutput_;
     
     Playlist playlist_;
+    AlbumArtCache albumArt_;
     AudioAnalyzer analyzer_;
     AudioSpectrum currentSpectrum_;
     
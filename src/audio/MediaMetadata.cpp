@@ -11,7 +11,6 @@
 #include <taglib/flacfile.h>
 #include <taglib/flacpicture.h>
 
-#include <QBuffer>
 
 namespace vc {
 
@@ -84,8 +83,7 @@ Result<MediaMetadata> MetadataReader::read(const fs::path& path) {
         meta.title = path.stem().string();
     }
     
-    // Try to extract album art
-    meta.albumArt = extractAlbumArt(path);
+    // Art is left to AlbumArtCache, which reads it when it's shown
     
     LOG_DEBUG("Read metadata for: {} - {}", meta.artist, meta.title);
     return Result<MediaMetadata>::ok(std::move(meta));
@@ -97,42 +95,37 @@ bool MetadataReader::canRead(const fs::path& path) {
     return file::audioExtensions.contains(ext);
 }
 
-std::optional<QPixmap> MetadataReader::extractAlbumArt(const fs::path& path) {
-    auto ext = path.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    
+std::optional<QByteArray> MetadataReader::readAlbumArt(const fs::path& path) {
+    TagLib::FileRef file(path.c_str());
+    if (file.isNull()) return std::nullopt;
+    return extractAlbumArt(file.file());
+}
+
+std::optional<QByteArray> MetadataReader::extractAlbumArt(TagLib::File* file) {
     // Try MPEG/ID3v2
-    if (ext == ".mp3") {
-        TagLib::MPEG::File mpegFile(path.c_str());
-        if (mpegFile.isValid() && mpegFile.ID3v2Tag()) {
-            auto* tag = mpegFile.ID3v2Tag();
+    if (auto* mpegFile = dynamic_cast<TagLib::MPEG::File*>(file)) {
+        if (mpegFile->isValid() && mpegFile->ID3v2Tag()) {
+            auto* tag = mpegFile->ID3v2Tag();
             auto frames = tag->frameListMap()["APIC"];
             if (!frames.isEmpty()) {
                 auto* pic = dynamic_cast<TagLib::ID3v2::AttachedPictureFrame*>(frames.front());
-                if (pic) {
-                    QPixmap pixmap;
-                    if (pixmap.loadFromData(
-                        reinterpret_cast<const uchar*>(pic->picture().data()),
-                        pic->picture().size())) {
-                        return pixmap;
-                    }
+                if (pic && !pic->picture().isEmpty()) {
+                    return QByteArray(pic->picture().data(),
+                                      static_cast<qsizetype>(pic->picture().size()));
                 }
             }
         }
     }
     
     // Try FLAC
-    if (ext == ".flac") {
-        TagLib::FLAC::File flacFile(path.c_str());
-        if (flacFile.isValid()) {
-            auto pictures = flacFile.pictureList();
+    if (auto* flacFile = dynamic_cast<TagLib::FLAC::File*>(file)) {
+        if (flacFile->isValid()) {
+            auto pictures = flacFile->pictureList();
             if (!pictures.isEmpty()) {
                 auto* pic = pictures.front();
-                QPixmap pixmap;
-                if (pixmap.loadFromData(
-                    reinterpret_cast<const uchar*>(pic->data().data()),
-                    pic->data().size())) {
-                    return pixmap;
+                if (!pic->data().isEmpty()) {
+                    return QByteArray(pic->data().data(),
+                                      static_cast<qsizetype>(pic->data().size()));
                 }
             }
         }
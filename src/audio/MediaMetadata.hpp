@@ -4,7 +4,9 @@
 
 #include "util/Types.hpp"
 #include "util/Result.hpp"
-#include <QPixmap>
+#include <QByteArray>
+
+namespace TagLib { class File; }
 
 namespace vc {
 
@@ -19,7 +21,6 @@ struct MediaMetadata {
     u32 bitrate{0};         // kbps
     u32 sampleRate{0};      // Hz
     u32 channels{0};
-    std::optional<QPixmap> albumArt;
     
     // Formatted display strings
     std::string displayTitle() const;
@@ -28,13 +29,17 @@ struct MediaMetadata {
     std::string formatLine(const std::string& format) const;
 };
 
+// Thread-safe: MetadataImporter and AlbumArtCache call it from their workers
 class MetadataReader {
 public:
-    static Result<MediaMetadata> read(const fs::path& path);
+    static Result<MediaMetadata> read(const fs::path& path);  // Tags only, no art
     static bool canRead(const fs::path& path);
     
+    // Embedded cover, still encoded; AlbumArtCache decodes it at display size
+    static std::optional<QByteArray> readAlbumArt(const fs::path& path);
+    
 private:
-    static std::optional<QPixmap> extractAlbumArt(const fs::path& path);
+    static std::optional<QByteArray> extractAlbumArt(TagLib::File* file);
 };
 
 } // namespace vc
@@ -0,0 +1,90 @@
+#include "MetadataImporter.hpp"
+#include "core/Logger.hpp"
+#include "util/ParallelScan.hpp"
+
+namespace vc {
+
+MetadataImporter::~MetadataImporter() {
+    cancel();
+    workers_.clear();   // Stop and join before the queue and locks go away
+}
+
+void MetadataImporter::enqueue(std::vector<std::pair<u64, fs::path>> jobs) {
+    if (jobs.empty()) return;
+    
+    std::lock_guard lock(mutex_);
+    if (workers_.empty()) {
+        u32 count = std::min(workerCount(), MAX_THREADS);
+        for (u32 i = 0; i < count; ++i) {
+            workers_.emplace_back([this](std::stop_token stop) { run(stop); });
+        }
+    }
+    
+    for (auto& job : jobs) {
+        queue_.push_back(std::move(job));
+    }
+    wake_.notify_all();
+}
+
+void MetadataImporter::cancel() {
+    std::lock_guard lock(mutex_);
+    queue_.clear();
+}
+
+bool MetadataImporter::busy() const {
+    std::lock_guard lock(mutex_);
+    return !queue_.empty() || active_ > 0;
+}
+
+void MetadataImporter::run(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        std::pair<u64, fs::path> job;
+        {
+            std::unique_lock lock(mutex_);
+            if (!wake_.wait(lock, stop, [this] { return !queue_.empty(); })) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            ++active_;
+        }
+        
+        ImportedTrack track{job.first, std::nullopt};
+        if (auto result = MetadataReader::read(job.second)) {
+            track.metadata = std::move(*result);
+        } else {
+            LOG_WARN("Failed to read metadata: {}", result.error().message);
+        }
+        
+        {
+            std::lock_guard lock(doneMutex_);
+            if (done_.empty()) batchStart_ = chr::steady_clock::now();
+            done_.push_back(std::move(track));
+        }
+        
+        // Results are in before active_ drops, so whoever sees the queue
+        // run dry last also sees every result
+        bool idle;
+        {
+            std::lock_guard lock(mutex_);
+            --active_;
+            idle = queue_.empty() && active_ == 0;
+        }
+        flush(idle);
+    }
+}
+
+void MetadataImporter::flush(bool force) {
+    std::vector<ImportedTrack> batch;
+    {
+        std::lock_guard lock(doneMutex_);
+        if (done_.empty()) return;
+        
+        bool due = force || done_.size() >= BATCH_SIZE ||
+                   chr::steady_clock::now() - batchStart_ >= chr::milliseconds(BATCH_MS);
+        if (!due) return;
+        batch.swap(done_);
+    }
+    
+    imported.emitSignal(batch);
+}
+
+} // namespace vc
@@ -0,0 +1,61 @@
+#pragma once
+// MetadataImporter.hpp - Tag reading on a worker pool
+// Dropping a 40-album folder shouldn't freeze the visualizer mid-drop
+
+#include "util/Types.hpp"
+#include "util/Signal.hpp"
+#include "MediaMetadata.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vc {
+
+struct ImportedTrack {
+    u64 id{0};                              // As given to enqueue
+    std::optional<MediaMetadata> metadata;  // Empty when the file couldn't be read
+};
+
+// Reads tags for queued tracks on a few worker threads, in queue order.
+// Results are gathered into batches (every BATCH_MS, or BATCH_SIZE tracks,
+// or when the queue runs dry) so the receiver updates once per batch.
+class MetadataImporter {
+public:
+    static constexpr usize BATCH_SIZE = 256;
+    static constexpr u32 BATCH_MS = 100;
+    static constexpr u32 MAX_THREADS = 8;  // Tag reading waits on the disk more than the CPU
+    
+    MetadataImporter() = default;
+    ~MetadataImporter();
+    
+    // Non-copyable
+    MetadataImporter(const MetadataImporter&) = delete;
+    MetadataImporter& operator=(const MetadataImporter&) = delete;
+    
+    // Workers start with the first job
+    void enqueue(std::vector<std::pair<u64, fs::path>> jobs);
+    void cancel();      // Drop whatever hasn't been started
+    bool busy() const;
+    
+    // Emitted on a worker thread; hop to the owner's thread before applying
+    Signal<const std::vector<ImportedTrack>&> imported;
+    
+private:
+    void run(std::stop_token stop);
+    void flush(bool force);     // Emits the pending batch if it's due
+    
+    std::vector<std::jthread> workers_;
+    std::deque<std::pair<u64, fs::path>> queue_;
+    usize active_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable_any wake_;
+    
+    std::vector<ImportedTrack> done_;
+    TimePoint batchStart_;
+    std::mutex doneMutex_;
+};
+
+} // namespace vc
@@ -1,9 +1,12 @@
 #include "Playlist.hpp"
 #include "core/Logger.hpp"
 #include "util/FileUtils.hpp"
+#include "util/FileWatcher.hpp"
 #include <algorithm>
 #include <fstream>
 #include <numeric>
+#include <set>
+#include <unordered_map>
 
 namespace vc {
 
@@ -13,26 +16,29 @@ Playlist::Playlist()
 }
 
 void Playlist::addFile(const fs::path& path) {
+    if (auto index = append(path)) {
+        startImport();
+        itemAdded.emitSignal(*index);
+        changed.emitSignal();
+    }
+}
+
+std::optional<usize> Playlist::append(const fs::path& path) {
     if (!fs::exists(path)) {
         LOG_WARN("File not found: {}", path.string());
-        return;
+        return std::nullopt;
     }
     
     if (!MetadataReader::canRead(path)) {
         LOG_WARN("Unsupported file format: {}", path.string());
-        return;
+        return std::nullopt;
     }
     
     PlaylistItem item;
     item.path = path;
-    
-    auto metaResult = MetadataReader::read(path);
-    if (metaResult) {
-        item.metadata = std::move(*metaResult);
-    } else {
-        LOG_WARN("Failed to read metadata: {}", metaResult.error().message);
-        item.metadata.title = path.stem().string();
-    }
+    item.metadata.title = path.stem().string();
+    item.id = nextId_++;
+    toImport_.emplace_back(item.id, path);
     
     usize index = items_.size();
     items_.push_back(std::move(item));
@@ -45,15 +51,65 @@ void Playlist::addFile(const fs::path& path) {
         }
     }
     
-    itemAdded.emitSignal(index);
-    changed.emitSignal();
-    
     LOG_DEBUG("Added to playlist: {}", path.filename().string());
+    return index;
+}
+
+void Playlist::applyChanges(const FileChanges& changes) {
+    usize before = items_.size();
+    
+    if (!changes.removed.empty() || !changes.removedDirs.empty()) {
+        std::optional<fs::path> currentPath;
+        if (const auto* item = currentItem()) currentPath = item->path;
+        
+        std::erase_if(items_, [&changes](const auto& item) { return changes.isRemoved(item.path); });
+        
+        // Same as removeAt: a removed current track leaves nothing current
+        currentIndex_ = std::nullopt;
+        for (usize i = 0; currentPath && i < items_.size(); ++i) {
+            if (items_[i].path == *currentPath) {
+                currentIndex_ = i;
+                break;
+            }
+        }
+        if (shuffle_) {
+            regenerateShuffleOrder();
+        }
+    }
+    bool removedAny = items_.size() != before;
+    
+    std::set<fs::path> known;
+    for (const auto& item : items_) {
+        known.insert(item.path);
+    }
+    
+    usize first = items_.size();
+    for (const auto& path : changes.added) {
+        if (!known.contains(path)) {
+            append(path);
+        }
+    }
+    bool addedAny = items_.size() != first;
+    startImport();
+    
+    if (addedAny) {
+        itemsAdded.emitSignal(first, items_.size() - first);
+    }
+    if (removedAny || addedAny) {
+        changed.emitSignal();
+    }
 }
 
 void Playlist::addFiles(const std::vector<fs::path>& paths) {
+    usize first = items_.size();
     for (const auto& path : paths) {
-        addFile(path);
+        append(path);
+    }
+    startImport();
+    
+    if (items_.size() != first) {
+        itemsAdded.emitSignal(first, items_.size() - first);
+        changed.emitSignal();
     }
 }
 
@@ -78,7 +134,42 @@ void Playlist::removeAt(usize index) {
     changed.emitSignal();
 }
 
+void Playlist::startImport() {
+    importer_.enqueue(std::exchange(toImport_, {}));
+}
+
+void Playlist::applyMetadata(const std::vector<ImportedTrack>& tracks) {
+    std::unordered_map<u64, const ImportedTrack*> byId;
+    byId.reserve(tracks.size());
+    for (const auto& track : tracks) {
+        byId.emplace(track.id, &track);
+    }
+    
+    // Tracks removed since they were queued simply don't match
+    usize updated = 0;
+    bool currentUpdated = false;
+    for (usize i = 0; i < items_.size() && updated < byId.size(); ++i) {
+        auto it = byId.find(items_[i].id);
+        if (it == byId.end()) continue;
+        
+        if (it->second->metadata) {
+            items_[i].metadata = *it->second->metadata;
+        }
+        items_[i].loaded = true;
+        ++updated;
+        currentUpdated |= currentIndex_ == i;
+    }
+    
+    if (updated > 0) {
+        changed.emitSignal();
+    }
+    if (currentUpdated) {
+        currentMetadataChanged.emitSignal();
+    }
+}
+
 void Playlist::clear() {
+    importer_.cancel();
     items_.clear();
     currentIndex_ = std::nullopt;
     shuffleOrder_.clear();
@@ -280,6 +371,7 @@ Result<void> Playlist::loadM3U(const fs::path& path) {
         return Result<void>::err("Failed to open file");
     }
     
+    std::vector<fs::path> paths;
     std::string line;
     while (std::getline(file, line)) {
         if (line.empty() || line[0] == '#') continue;
@@ -289,8 +381,9 @@ Result<void> Playlist::loadM3U(const fs::path& path) {
             filePath = path.parent_path() / filePath;
         }
         
-        addFile(filePath);
+        paths.push_back(std::move(filePath));
     }
+    addFiles(paths);
     
     return Result<void>::ok();
 }
@@ -5,16 +5,21 @@
 #include "util/Types.hpp"
 #include "util/Signal.hpp"
 #include "MediaMetadata.hpp"
+#include "MetadataImporter.hpp"
 #include <vector>
 #include <random>
 #include <optional>
 
 namespace vc {
 
+struct FileChanges;
+
 struct PlaylistItem {
     fs::path path;
-    MediaMetadata metadata;
+    MediaMetadata metadata;     // Title from the file name until the tags are read
     bool valid{true};
+    bool loaded{false};         // Tags read (or found unreadable)
+    u64 id{0};                  // Stable across moves; matches import results
 };
 
 enum class RepeatMode {
@@ -29,11 +34,20 @@ public:
     
     // Modification
     void addFile(const fs::path& path);
-    void addFiles(const std::vector<fs::path>& paths);
+    void addFiles(const std::vector<fs::path>& paths);  // One itemsAdded for the batch
     void removeAt(usize index);
     void clear();
     void move(usize from, usize to);
     
+    // Drop deleted files, append new ones: one changed for the whole batch
+    void applyChanges(const FileChanges& changes);
+    
+    // Added files show up at once with placeholder metadata; tags are read
+    // by the importer. Its results arrive on a worker thread: hand them to
+    // applyMetadata on the thread that owns the playlist.
+    MetadataImporter& importer() { return importer_; }
+    void applyMetadata(const std::vector<ImportedTrack>& tracks);
+    
     // Navigation
     std::optional<usize> currentIndex() const { return currentIndex_; }
     const PlaylistItem* currentItem() const;
@@ -64,9 +78,13 @@ public:
     Signal<> changed;
     Signal<usize> currentChanged;
     Signal<usize> itemAdded;
+    Signal<usize, usize> itemsAdded;    // First index, count: appended as a batch
+    Signal<> currentMetadataChanged;    // Tags for the current track came in late
     Signal<usize> itemRemoved;
     
 private:
+    std::optional<usize> append(const fs::path& path);  // No signals, queues the tags
+    void startImport();                                 // Hands queued tags to the importer
     void regenerateShuffleOrder();
     usize shuffleIndexToReal(usize shuffleIdx) const;
     usize realIndexToShuffle(usize realIdx) const;
@@ -80,6 +98,10 @@ private:
     
     RepeatMode repeatMode_{RepeatMode::Off};
     std::mt19937 rng_;
+    
+    u64 nextId_{1};
+    std::vector<std::pair<u64, fs::path>> toImport_;
+    MetadataImporter importer_;
 };
 
 } // namespace vc
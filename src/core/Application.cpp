@@ -8,11 +8,16 @@
 #include "recorder/VideoRecorder.hpp"
 #include "ui/MainWindow.hpp"
 #include "util/FileUtils.hpp"
+#include "visualizer/ShaderCache.hpp"
+#include "visualizer/PresetCensus.hpp"
 
 #include <QStyleFactory>
 #include <QFontDatabase>
 #include <QFile>
 #include <QDir>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <format>
 #include <iostream>
 
 namespace vc {
@@ -58,6 +63,9 @@ Result<AppOptions> Application::parseArgs() {
         else if (arg == "--headless") {
             opts.headless = true;
         }
+        else if (arg == "--preset-census") {
+            opts.presetCensus = true;
+        }
         else if (arg == "-r" || arg == "--record") {
             opts.startRecording = true;
         }
@@ -114,6 +122,17 @@ Result<void> Application::init(const AppOptions& opts) {
         CONFIG.setDebug(true);
     }
     
+    // Driver shader caches (ProjectM's presets) live with ours; env vars
+    // are read when the GL driver loads, so this has to happen first
+    if (u32 mb = CONFIG.visualizer().shaderCacheMB; mb > 0) {
+        ProgramBinaryCache::configureDriverCache(file::cacheDir() / "shaders",
+                                                 ProgramBinaryCache::shareOf(mb));
+    }
+    
+    // The visualizer renders on its own thread; its context shares with
+    // the global one so frames survive widget context recreation
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    
     // Create Qt application
     qapp_ = std::make_unique<QApplication>(argc_, argv_);
     qapp_->setApplicationName("VibeChad");
@@ -121,6 +140,16 @@ Result<void> Application::init(const AppOptions& opts) {
     qapp_->setOrganizationName("VibeChad");
     qapp_->setOrganizationDomain("github.com/vibechad");
     
+    // Batch tool: measure presets and exit, no UI
+    if (opts.presetCensus) {
+        auto result = runPresetCensus();
+        if (!result) {
+            LOG_ERROR("Preset census failed: {}", result.error().message);
+        }
+        batchExitCode_ = result ? 0 : 1;
+        return Result<void>::ok();
+    }
+    
     // Setup styling
     setupStyle();
     
@@ -177,6 +206,9 @@ Result<void> Application::init(const AppOptions& opts) {
 }
 
 int Application::exec() {
+    if (batchExitCode_) {
+        return *batchExitCode_;
+    }
     if (!qapp_) {
         LOG_ERROR("Application not initialized");
         return 1;
@@ -263,6 +295,78 @@ void Application::setupStyle() {
     }
 }
 
+Result<void> Application::runPresetCensus() {
+    const auto& vizConfig = CONFIG.visualizer();
+    
+    PresetManager presets;
+    if (auto result = presets.scan(vizConfig.presetPath); !result) {
+        return result;
+    }
+    
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        return Result<void>::err("No OpenGL context for the census");
+    }
+    
+    glewExperimental = GL_TRUE;
+    if (GLenum err = glewInit(); err != GLEW_OK) {
+        return Result<void>::err(std::string("GLEW init failed: ") +
+                                 reinterpret_cast<const char*>(glewGetErrorString(err)));
+    }
+    
+    // Merge into earlier results, so an interrupted run isn't wasted
+    auto censusPath = file::cacheDir() / "preset_census.tsv";
+    presets.loadCensus(censusPath);
+    
+    std::vector<fs::path> paths;
+    for (const auto& p : presets.allPresets()) {
+        paths.push_back(p.path);
+    }
+    
+    CensusOptions options;
+    options.width = vizConfig.width;
+    options.height = vizConfig.height;
+    options.fps = vizConfig.fps;
+    options.meshX = vizConfig.meshWidth;
+    options.meshY = vizConfig.meshHeight;
+    
+    f32 budgetMs = 1000.0f / std::max(vizConfig.fps, 1u);
+    usize slow = 0;
+    
+    LOG_INFO("Preset census: {} presets at {}x{}, {} frames each",
+             paths.size(), options.width, options.height, options.frames);
+    
+    PresetCensus census;
+    census.measured.connect([&](const fs::path& path, const PresetCost& cost, usize i, usize total) {
+        presets.setCost(path, cost);
+        if (cost.p99FrameMs > budgetMs) {
+            ++slow;
+        }
+        
+        std::cout << std::format("[{}/{}] {:7.2f} ms avg {:7.2f} ms p99 {:8.1f} ms compile  {}{}\n",
+                                 i + 1, total, cost.avgFrameMs, cost.p99FrameMs, cost.compileMs,
+                                 presets.keyOf(path), cost.p99FrameMs > budgetMs ? "  (slow)" : "");
+        
+        // Save as we go; a full census can take a long time
+        if ((i + 1) % 25 == 0) {
+            presets.saveCensus(censusPath);
+        }
+    });
+    
+    auto result = census.run(paths, options);
+    context.doneCurrent();
+    
+    if (auto saved = presets.saveCensus(censusPath); !saved) {
+        return saved;
+    }
+    
+    LOG_INFO("Preset census done: {} of {} presets over {:.2f} ms, results in {}",
+             slow, paths.size(), budgetMs, censusPath.string());
+    return result;
+}
+
 void Application::printVersion() {
     std::cout << "VibeChad Audio Player v1.0.0\n";
     std::cout << "Built with Qt " << qVersion() << "\n";
@@ -284,6 +388,8 @@ Options:
   -r, --record            Start recording immediately
   -o, --output <path>     Output file for recording
   --headless              Run without GUI (for batch processing)
+  --preset-census         Time every preset offscreen and exit; slow ones
+                          are then skipped by next/random (see config)
 
 Examples:
   vibechad ~/Music/*.flac
@@ -23,6 +23,7 @@ struct AppOptions {
     std::optional<fs::path> configFile;
     std::vector<fs::path> inputFiles;
     std::optional<std::string> presetName;
+    bool presetCensus{false};
 };
 
 class Application : public QObject {
@@ -56,6 +57,7 @@ public slots:
     
 private:
     void setupStyle();
+    Result<void> runPresetCensus();
     void printVersion();
     void printHelp();
     
@@ -69,6 +71,7 @@ private:
     
     int argc_;
     char** argv_;
+    std::optional<int> batchExitCode_;  // Set when a batch task ran instead of the GUI
 };
 
 // Global shortcut
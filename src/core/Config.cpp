@@ -132,6 +132,8 @@ void Config::parseAudio(const toml::table& tbl) {
         audio_.device = get(*audio, "device", std::string("default"));
         audio_.bufferSize = get(*audio, "buffer_size", 2048u);
         audio_.sampleRate = get(*audio, "sample_rate", 44100u);
+        audio_.watchFolders = get(*audio, "watch_folders", true);
+        audio_.albumArtCacheMB = get(*audio, "album_art_cache_mb", 32u);
     }
 }
 
@@ -146,6 +148,25 @@ void Config::parseVisualizer(const toml::table& tbl) {
         visualizer_.presetDuration = get(*viz, "preset_duration", 30u);
         visualizer_.smoothPresetDuration = get(*viz, "smooth_preset_duration", 5u);
         visualizer_.shufflePresets = get(*viz, "shuffle_presets", true);
+        visualizer_.vsyncAlign = get(*viz, "vsync_align", true);
+        visualizer_.preloadPresets = get(*viz, "preload_presets", 3u);
+        visualizer_.shaderCacheMB = get(*viz, "shader_cache_mb", 512u);
+        visualizer_.meshWidth = get(*viz, "mesh_width", 128u);
+        visualizer_.meshHeight = get(*viz, "mesh_height", 96u);
+        visualizer_.autoMesh = get(*viz, "auto_mesh", true);
+        visualizer_.skipSlowPresets = get(*viz, "skip_slow_presets", true);
+        visualizer_.watchPresets = get(*viz, "watch_presets", true);
+        visualizer_.pacePresets = get(*viz, "pace_presets", true);
+        visualizer_.presetThumbnails = get(*viz, "preset_thumbnails", true);
+        
+        if (auto dyn = (*viz)["dynamic_resolution"].as_table()) {
+            auto& dr = visualizer_.dynamicResolution;
+            dr.enabled = get(*dyn, "enabled", true);
+            dr.minScale = get(*dyn, "min_scale", 0.5f);
+            dr.maxScale = get(*dyn, "max_scale", 1.0f);
+            dr.sharpness = get(*dyn, "sharpness", 0.3f);
+            dr.whileRecording = get(*dyn, "while_recording", true);
+        }
     }
 }
 
@@ -156,6 +177,8 @@ void Config::parseRecording(const toml::table& tbl) {
         recording_.outputDirectory = expandPath(outDir);
         recording_.defaultFilename = get(*rec, "default_filename", std::string("vibechad_{date}_{time}"));
         recording_.container = get(*rec, "container", std::string("mp4"));
+        recording_.adaptiveQuality = get(*rec, "adaptive_quality", true);
+        recording_.minRenderScale = get(*rec, "min_render_scale", 0.5f);
         
         if (auto video = (*rec)["video"].as_table()) {
             recording_.video.codec = get(*video, "codec", std::string("libx264"));
@@ -171,6 +194,21 @@ void Config::parseRecording(const toml::table& tbl) {
             recording_.audio.codec = get(*audio, "codec", std::string("aac"));
             recording_.audio.bitrate = get(*audio, "bitrate", 320u);
         }
+        
+        if (auto stream = (*rec)["stream"].as_table()) {
+            recording_.stream.target = get(*stream, "target", std::string("file"));
+            recording_.stream.path = expandPath(get(*stream, "path", std::string("/tmp/vibechad.sock")));
+            recording_.stream.container = get(*stream, "container", std::string("mpegts"));
+            recording_.stream.dropPolicy = get(*stream, "drop_policy", std::string("drop"));
+            recording_.stream.bufferKB = get(*stream, "buffer_kb", 4096u);
+        }
+        
+        if (auto preview = (*rec)["preview"].as_table()) {
+            recording_.preview.enabled = get(*preview, "enabled", false);
+            recording_.preview.interval = get(*preview, "interval", 10u);
+            recording_.preview.width = get(*preview, "width", 160u);
+            recording_.preview.columns = get(*preview, "columns", 10u);
+        }
     }
 }
 
@@ -249,7 +287,9 @@ toml::table Config::serialize() const {
     root.insert("audio", toml::table{
         {"device", audio_.device},
         {"buffer_size", static_cast<i64>(audio_.bufferSize)},
-        {"sample_rate", static_cast<i64>(audio_.sampleRate)}
+        {"sample_rate", static_cast<i64>(audio_.sampleRate)},
+        {"watch_folders", audio_.watchFolders},
+        {"album_art_cache_mb", static_cast<i64>(audio_.albumArtCacheMB)}
     });
     
     // Visualizer
@@ -261,7 +301,24 @@ toml::table Config::serialize() const {
         {"beat_sensitivity", static_cast<double>(visualizer_.beatSensitivity)},
         {"preset_duration", static_cast<i64>(visualizer_.presetDuration)},
         {"smooth_preset_duration", static_cast<i64>(visualizer_.smoothPresetDuration)},
-        {"shuffle_presets", visualizer_.shufflePresets}
+        {"shuffle_presets", visualizer_.shufflePresets},
+        {"vsync_align", visualizer_.vsyncAlign},
+        {"preload_presets", static_cast<i64>(visualizer_.preloadPresets)},
+        {"shader_cache_mb", static_cast<i64>(visualizer_.shaderCacheMB)},
+        {"mesh_width", static_cast<i64>(visualizer_.meshWidth)},
+        {"mesh_height", static_cast<i64>(visualizer_.meshHeight)},
+        {"auto_mesh", visualizer_.autoMesh},
+        {"skip_slow_presets", visualizer_.skipSlowPresets},
+        {"watch_presets", visualizer_.watchPresets},
+        {"pace_presets", visualizer_.pacePresets},
+        {"preset_thumbnails", visualizer_.presetThumbnails},
+        {"dynamic_resolution", toml::table{
+            {"enabled", visualizer_.dynamicResolution.enabled},
+            {"min_scale", static_cast<double>(visualizer_.dynamicResolution.minScale)},
+            {"max_scale", static_cast<double>(visualizer_.dynamicResolution.maxScale)},
+            {"sharpness", static_cast<double>(visualizer_.dynamicResolution.sharpness)},
+            {"while_recording", visualizer_.dynamicResolution.whileRecording}
+        }}
     });
     
     // Recording
@@ -280,13 +337,32 @@ toml::table Config::serialize() const {
         {"bitrate", static_cast<i64>(recording_.audio.bitrate)}
     };
     
+    toml::table recStream{
+        {"target", recording_.stream.target},
+        {"path", recording_.stream.path.string()},
+        {"container", recording_.stream.container},
+        {"drop_policy", recording_.stream.dropPolicy},
+        {"buffer_kb", static_cast<i64>(recording_.stream.bufferKB)}
+    };
+    
+    toml::table recPreview{
+        {"enabled", recording_.preview.enabled},
+        {"interval", static_cast<i64>(recording_.preview.interval)},
+        {"width", static_cast<i64>(recording_.preview.width)},
+        {"columns", static_cast<i64>(recording_.preview.columns)}
+    };
+    
     root.insert("recording", toml::table{
         {"enabled", recording_.enabled},
         {"output_directory", recording_.outputDirectory.string()},
         {"default_filename", recording_.defaultFilename},
         {"container", recording_.container},
+        {"adaptive_quality", recording_.adaptiveQuality},
+        {"min_render_scale", static_cast<double>(recording_.minRenderScale)},
         {"video", recVideo},
-        {"audio", recAudio}
+        {"audio", recAudio},
+        {"stream", recStream},
+        {"preview", recPreview}
     });
     
     // Overlay elements
@@ -42,14 +42,44 @@ struct AudioEncoderConfig {
     u32 bitrate{320};
 };
 
+// Live stream output (instead of a file)
+struct StreamOutputConfig {
+    std::string target{"file"};         // file, stdout, pipe, socket
+    fs::path path{"/tmp/vibechad.sock"};
+    std::string container{"mpegts"};   // mpegts, flv
+    std::string dropPolicy{"drop"};     // drop, block
+    u32 bufferKB{4096};
+};
+
+// Seek-bar thumbnails written alongside recordings
+struct PreviewConfig {
+    bool enabled{false};
+    u32 interval{10};           // Seconds between thumbnails
+    u32 width{160};             // Thumbnail width, height follows the video aspect
+    u32 columns{10};            // Sheets are columns x columns thumbnails
+};
+
 // Recording configuration
 struct RecordingConfig {
     bool enabled{true};
     fs::path outputDirectory;
     std::string defaultFilename{"vibechad_{date}_{time}"};
     std::string container{"mp4"};
+    bool adaptiveQuality{true};     // Degrade gracefully when the encoder falls behind
+    f32 minRenderScale{0.5f};       // Lowest internal render scale the governor may use
     VideoEncoderConfig video;
     AudioEncoderConfig audio;
+    StreamOutputConfig stream;
+    PreviewConfig preview;
+};
+
+// Internal ProjectM resolution that follows render load
+struct DynamicResolutionConfig {
+    bool enabled{true};
+    f32 minScale{0.5f};
+    f32 maxScale{1.0f};
+    f32 sharpness{0.3f};            // Unsharp amount when upscaling, 0 = plain bilinear
+    bool whileRecording{true};      // Turn off for offline renders that want full quality
 };
 
 // Visualizer configuration
@@ -62,6 +92,17 @@ struct VisualizerConfig {
     u32 presetDuration{30};
     u32 smoothPresetDuration{5};
     bool shufflePresets{true};
+    bool vsyncAlign{true};          // Phase-lock frames to the display when rates match
+    u32 preloadPresets{3};          // Upcoming presets read and shader-warmed in the background
+    u32 shaderCacheMB{512};         // Disk budget for compiled shaders (ours + driver's), 0 = driver defaults
+    u32 meshWidth{128};             // Per-vertex equation grid
+    u32 meshHeight{96};
+    bool autoMesh{true};            // Coarser mesh for presets too slow at full size
+    bool skipSlowPresets{true};     // Auto-switching passes over presets the census found too slow
+    bool watchPresets{true};        // Pick up presets added to or removed from the folder live
+    bool pacePresets{true};         // Timed switches keep heavy presets apart
+    bool presetThumbnails{true};    // Preset browser previews, rendered in the background
+    DynamicResolutionConfig dynamicResolution;
 };
 
 // Audio configuration
@@ -69,6 +110,8 @@ struct AudioConfig {
     std::string device{"default"};
     u32 bufferSize{2048};
     u32 sampleRate{44100};
+    bool watchFolders{true};        // Folders added to the playlist follow new and deleted files
+    u32 albumArtCacheMB{32};        // Decoded cover art kept in memory
 };
 
 // UI configuration
@@ -11,8 +11,8 @@ void Logger::init(std::string_view appName, bool debug) {
         // Create sinks
         std::vector<spdlog::sink_ptr> sinks;
         
-        // Console sink with colors
-        auto console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        // Console sink with colors (stderr, stdout may be carrying a video stream)
+        auto console = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
         console->set_pattern("%^[%H:%M:%S.%e] [%l]%$ %v");
         sinks.push_back(console);
         
@@ -45,7 +45,7 @@ void Logger::init(std::string_view appName, bool debug) {
         
     } catch (const spdlog::spdlog_ex& ex) {
         // Fallback to console only
-        logger_ = spdlog::stdout_color_mt(std::string(appName));
+        logger_ = spdlog::stderr_color_mt(std::string(appName));
         logger_->set_level(spdlog::level::debug);
         logger_->warn("Failed to create file logger: {}", ex.what());
     }
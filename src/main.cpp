@@ -22,7 +22,7 @@ vc::Application* g_app = nullptr;
 
 void signalHandler(int signal) {
     if (signal == SIGINT || signal == SIGTERM) {
-        std::cout << "\nReceived signal " << signal << ", shutting down gracefully...\n";
+        std::cerr << "\nReceived signal " << signal << ", shutting down gracefully...\n";
         if (g_app) {
             g_app->quit();
         }
@@ -25,15 +25,18 @@ void OverlayEngine::init() {
 
 void OverlayEngine::update(f32 deltaTime) {
     if (!enabled_) return;
+    std::lock_guard lock(mutex_);
     animator_.update(deltaTime);
 }
 
 void OverlayEngine::onBeat(f32 intensity) {
     if (!enabled_) return;
+    std::lock_guard lock(mutex_);
     animator_.onBeat(intensity);
 }
 
 void OverlayEngine::updateMetadata(const MediaMetadata& meta) {
+    std::lock_guard lock(mutex_);
     currentMetadata_ = meta;
     
     // Update all elements with new metadata
@@ -42,8 +45,11 @@ void OverlayEngine::updateMetadata(const MediaMetadata& meta) {
     }
 }
 
-void OverlayEngine::render(u32 width, u32 height) {
-    if (!enabled_ || config_.empty()) return;
+bool OverlayEngine::render(u32 width, u32 height) {
+    if (!enabled_) return false;
+    
+    std::lock_guard lock(mutex_);
+    if (config_.empty()) return false;
     
     // Recreate canvas if size changed
     if (width != lastWidth_ || height != lastHeight_) {
@@ -70,10 +76,14 @@ void OverlayEngine::render(u32 width, u32 height) {
     painter.end();
     
     needsTextureUpdate_ = true;
+    return true;
 }
 
 void OverlayEngine::renderToImage(QImage& image) {
-    if (!enabled_ || config_.empty()) return;
+    if (!enabled_) return;
+    
+    std::lock_guard lock(mutex_);
+    if (config_.empty()) return;
     
     QPainter painter(&image);
     painter.setRenderHint(QPainter::Antialiasing);
@@ -13,6 +13,7 @@
 #include "util/GLIncludes.hpp"
 #include <QOpenGLTexture>
 #include <memory>
+#include <mutex>
 
 namespace vc {
 
@@ -36,10 +37,13 @@ public:
     void onBeat(f32 intensity);
     void updateMetadata(const MediaMetadata& meta);
     
-    // Rendering
-    void render(u32 width, u32 height);
+    // Rendering. Returns false when there's nothing to draw.
+    bool render(u32 width, u32 height);
     void renderToImage(QImage& image);
     
+    // Last rasterized frame, for the compositor (render thread only)
+    const QImage* canvas() const { return canvas_.get(); }
+    
     // GL texture for compositing (call after render)
     GLuint texture() const;
     
@@ -47,6 +51,9 @@ public:
     bool enabled() const { return enabled_; }
     void setEnabled(bool e) { enabled_ = e; }
     
+    // Hold while editing elements; the render thread rasterizes concurrently
+    std::unique_lock<std::mutex> lock() { return std::unique_lock(mutex_); }
+    
 private:
     void renderElement(QPainter& painter, TextElement& element,
                        u32 canvasWidth, u32 canvasHeight);
@@ -65,6 +72,7 @@ private:
     bool needsTextureUpdate_{false};
     
     MediaMetadata currentMetadata_;
+    std::mutex mutex_;
 };
 
 } // namespace vc
\ No newline at end of file
@@ -60,10 +60,30 @@ std::string EncoderSettings::containerExtension() const {
         case Container::WebM: return ".webm";
         case Container::MOV:  return ".mov";
         case Container::AVI:  return ".avi";
+        case Container::MPEGTS: return ".ts";
+        case Container::FLV:  return ".flv";
     }
     return ".mp4";
 }
 
+std::string EncoderSettings::containerFormatName() const {
+    switch (container) {
+        case Container::MPEGTS: return "mpegts";
+        case Container::FLV:    return "flv";
+        default:                return "";
+    }
+}
+
+std::string StreamSettings::describe() const {
+    switch (target) {
+        case OutputTarget::File:       return "file";
+        case OutputTarget::Stdout:     return "stdout";
+        case OutputTarget::Pipe:       return "pipe:" + path.string();
+        case OutputTarget::UnixSocket: return "unix:" + path.string();
+    }
+    return "file";
+}
+
 Result<void> EncoderSettings::validate() const {
     // Check codec/container compatibility
     if (container == Container::WebM) {
@@ -81,6 +101,25 @@ Result<void> EncoderSettings::validate() const {
         }
     }
     
+    if (container == Container::FLV) {
+        if (video.codec != VideoCodec::H264) {
+            return Result<void>::err("FLV requires H.264 video codec");
+        }
+        if (audio.codec != AudioCodec::AAC && audio.codec != AudioCodec::MP3) {
+            return Result<void>::err("FLV requires AAC or MP3 audio codec");
+        }
+    }
+    
+    // Non-seekable outputs can't have their header patched after the fact
+    if (stream.isStream()) {
+        if (container != Container::MPEGTS && container != Container::FLV) {
+            return Result<void>::err("Stream output requires MPEG-TS or FLV container");
+        }
+        if (stream.target != OutputTarget::Stdout && stream.path.empty()) {
+            return Result<void>::err("Stream output requires a pipe or socket path");
+        }
+    }
+    
     // Check dimensions
     if (video.width == 0 || video.height == 0) {
         return Result<void>::err("Invalid video dimensions");
@@ -137,10 +176,46 @@ EncoderSettings EncoderSettings::fromConfig() {
     else if (recCfg.container == "mkv") settings.container = Container::MKV;
     else if (recCfg.container == "webm") settings.container = Container::WebM;
     else if (recCfg.container == "mov") settings.container = Container::MOV;
+    else if (recCfg.container == "ts" || recCfg.container == "mpegts") settings.container = Container::MPEGTS;
+    else if (recCfg.container == "flv") settings.container = Container::FLV;
+    
+    settings.adaptiveQuality = recCfg.adaptiveQuality;
+    settings.minRenderScale = recCfg.minRenderScale;
+    
+    settings.preview.enabled = recCfg.preview.enabled;
+    settings.preview.intervalSec = recCfg.preview.interval;
+    settings.preview.thumbWidth = recCfg.preview.width;
+    settings.preview.columns = recCfg.preview.columns;
+    
+    // Stream output
+    const auto& streamCfg = recCfg.stream;
+    if (streamCfg.target == "stdout") settings.stream.target = OutputTarget::Stdout;
+    else if (streamCfg.target == "pipe") settings.stream.target = OutputTarget::Pipe;
+    else if (streamCfg.target == "socket") settings.stream.target = OutputTarget::UnixSocket;
+    
+    settings.stream.path = streamCfg.path;
+    settings.stream.dropPolicy = streamCfg.dropPolicy == "block" 
+                                 ? StreamDropPolicy::Block : StreamDropPolicy::DropFrames;
+    settings.stream.bufferKB = streamCfg.bufferKB;
+    
+    if (settings.stream.isStream()) {
+        settings.container = streamCfg.container == "flv" ? Container::FLV : Container::MPEGTS;
+        settings.applyLiveTuning();
+    }
     
     return settings;
 }
 
+void EncoderSettings::applyLiveTuning() {
+    // One keyframe per second so a relay can join quickly,
+    // and no B-frames so nothing waits on future frames
+    video.gopSize = video.fps;
+    video.bFrames = 0;
+    if (container != Container::MPEGTS && container != Container::FLV) {
+        container = Container::MPEGTS;
+    }
+}
+
 EncoderSettings EncoderSettings::youtube1080p60() {
     EncoderSettings s;
     s.video.codec = VideoCodec::H264;
@@ -224,6 +299,23 @@ EncoderSettings EncoderSettings::editing() {
     return s;
 }
 
+EncoderSettings EncoderSettings::liveStream(OutputTarget target, const fs::path& path) {
+    EncoderSettings s;
+    s.video.codec = VideoCodec::H264;
+    s.video.width = 1280;
+    s.video.height = 720;
+    s.video.fps = 30;
+    s.video.crf = 23;
+    s.video.preset = EncoderPreset::Veryfast;
+    s.audio.codec = AudioCodec::AAC;
+    s.audio.bitrate = 160;
+    s.container = Container::MPEGTS;
+    s.stream.target = target;
+    s.stream.path = path;
+    s.applyLiveTuning();
+    return s;
+}
+
 std::vector<QualityPreset> getQualityPresets() {
     return {
         {"YouTube 1080p60", "High quality for YouTube uploads", EncoderSettings::youtube1080p60()},
@@ -33,7 +33,23 @@ enum class Container {
     MKV,
     WebM,
     MOV,
-    AVI
+    AVI,
+    MPEGTS,     // Live streaming, survives truncation
+    FLV         // Live streaming, what RTMP relays expect
+};
+
+// Where the muxed bytes go
+enum class OutputTarget {
+    File,       // Regular seekable file at outputPath
+    Stdout,     // Pipe into another process: vibechad ... | ffplay -
+    Pipe,       // Named pipe (FIFO), created if missing
+    UnixSocket  // Connect to a relay listening on a Unix domain socket
+};
+
+// What to do when the stream reader can't keep up
+enum class StreamDropPolicy {
+    Block,      // Stall the encoder (frames pile up in the grabber instead)
+    DropFrames  // Skip encoding video frames until the backlog drains
 };
 
 // Encoder speed preset
@@ -90,11 +106,34 @@ struct AudioSettings {
     std::string codecName() const;
 };
 
+struct StreamSettings {
+    OutputTarget target{OutputTarget::File};
+    fs::path path;              // FIFO or socket path (ignored for File/Stdout)
+    StreamDropPolicy dropPolicy{StreamDropPolicy::DropFrames};
+    u32 bufferKB{4096};         // Queued bytes before backpressure kicks in
+    
+    bool isStream() const { return target != OutputTarget::File; }
+    std::string describe() const;
+};
+
+struct PreviewSettings {
+    bool enabled{false};
+    u32 intervalSec{10};
+    u32 thumbWidth{160};
+    u32 columns{10};
+};
+
 struct EncoderSettings {
     VideoSettings video;
     AudioSettings audio;
     Container container{Container::MP4};
     fs::path outputPath;
+    StreamSettings stream;
+    PreviewSettings preview;
+    
+    // Let the recording governor trade quality for keeping up
+    bool adaptiveQuality{true};
+    f32 minRenderScale{0.5f};
     
     // Metadata
     std::string title;
@@ -104,6 +143,9 @@ struct EncoderSettings {
     // Get container extension
     std::string containerExtension() const;
     
+    // FFmpeg muxer name, empty = guess from outputPath
+    std::string containerFormatName() const;
+    
     // Validate settings compatibility
     Result<void> validate() const;
     
@@ -117,6 +159,10 @@ struct EncoderSettings {
     static EncoderSettings discord8mb();
     static EncoderSettings lossless();
     static EncoderSettings editing();
+    static EncoderSettings liveStream(OutputTarget target, const fs::path& path = {});
+    
+    // Small GOPs, no B-frames, stream-friendly container
+    void applyLiveTuning();
 };
 
 // Quality presets
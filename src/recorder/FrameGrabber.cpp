@@ -80,6 +80,12 @@ void FrameGrabber::grabScreen(u32 width, u32 height, i64 timestamp) {
     queueCond_.notify_one();
 }
 
+void FrameGrabber::skip() {
+    if (running_) {
+        ++frameNumber_;
+    }
+}
+
 bool FrameGrabber::getNextFrame(GrabbedFrame& frame, u32 timeoutMs) {
     std::unique_lock lock(queueMutex_);
     
@@ -36,12 +36,16 @@ public:
     // Grab from current framebuffer
     void grabScreen(u32 width, u32 height, i64 timestamp);
     
+    // Count a frame without reading it back (decimation keeps the numbering)
+    void skip();
+    
     // Get next frame (blocking)
     bool getNextFrame(GrabbedFrame& frame, u32 timeoutMs = 100);
     
     // Check if frames available
     bool hasFrames() const;
     usize queueSize() const;
+    usize queueCapacity() const { return MAX_QUEUE_SIZE; }
     
     // Statistics
     u32 droppedFrames() const { return droppedFrames_; }
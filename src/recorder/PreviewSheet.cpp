@@ -0,0 +1,357 @@
+#include "PreviewSheet.hpp"
+#include "core/Logger.hpp"
+#include "util/FileUtils.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <format>
+
+namespace vc {
+
+namespace {
+
+std::string vttTime(f64 seconds) {
+    auto ms = static_cast<i64>(seconds * 1000.0 + 0.5);
+    return std::format("{:02}:{:02}:{:02}.{:03}",
+                       ms / 3600000, (ms / 60000) % 60, (ms / 1000) % 60, ms % 1000);
+}
+
+// File names come from the user, quotes and all
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<u8>(c) < 0x20) {
+                    out += std::format("\\u{:04x}", static_cast<u32>(static_cast<u8>(c)));
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+// One-shot MJPEG encode of an RGBA image
+Result<void> writeJpeg(const fs::path& path, const std::vector<u8>& rgba, u32 width, u32 height) {
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        return Result<void>::err("MJPEG encoder not available");
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    SwsContext* sws = nullptr;
+
+    auto cleanup = [&] {
+        sws_freeContext(sws);
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&ctx);
+    };
+
+    if (!ctx || !frame || !packet) {
+        cleanup();
+        return Result<void>::err("Failed to allocate JPEG encoder");
+    }
+
+    ctx->width = width;
+    ctx->height = height;
+    ctx->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    ctx->time_base = AVRational{1, 1};
+    ctx->flags |= AV_CODEC_FLAG_QSCALE;
+    ctx->global_quality = FF_QP2LAMBDA * 4;  // Catalogue quality, not archival
+
+    int ret = avcodec_open2(ctx, codec, nullptr);
+    if (ret < 0) {
+        cleanup();
+        return Result<void>::err("Failed to open JPEG encoder");
+    }
+
+    frame->format = ctx->pix_fmt;
+    frame->width = width;
+    frame->height = height;
+    frame->pts = 0;
+    frame->quality = ctx->global_quality;
+
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        cleanup();
+        return Result<void>::err("Failed to allocate JPEG frame");
+    }
+
+    sws = sws_getContext(width, height, AV_PIX_FMT_RGBA,
+                         width, height, AV_PIX_FMT_YUVJ420P,
+                         SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws) {
+        cleanup();
+        return Result<void>::err("Failed to create JPEG converter");
+    }
+
+    const u8* src[1] = { rgba.data() };
+    int srcStride[1] = { static_cast<int>(width * 4) };
+    sws_scale(sws, src, srcStride, 0, height, frame->data, frame->linesize);
+
+    if (avcodec_send_frame(ctx, frame) < 0 || avcodec_send_frame(ctx, nullptr) < 0 ||
+        avcodec_receive_packet(ctx, packet) < 0) {
+        cleanup();
+        return Result<void>::err("Failed to encode JPEG");
+    }
+
+    auto result = file::writeBinary(path, packet->data, static_cast<usize>(packet->size));
+    cleanup();
+    return result;
+}
+
+} // namespace
+
+PreviewSheet::PreviewSheet() = default;
+
+PreviewSheet::~PreviewSheet() {
+    cancel();
+}
+
+Result<void> PreviewSheet::start(const PreviewSettings& settings, const fs::path& outputPath,
+                                 u32 videoWidth, u32 videoHeight) {
+    cancel();
+
+    if (videoWidth == 0 || videoHeight == 0) {
+        return Result<void>::err("Invalid video size for previews");
+    }
+
+    settings_ = settings;
+    settings_.intervalSec = std::max<u32>(settings_.intervalSec, 1);
+    settings_.columns = std::clamp<u32>(settings_.columns, 1, 32);
+
+    outputPath_ = outputPath;
+    thumbWidth_ = std::max<u32>(settings_.thumbWidth, 16) & ~1u;
+    thumbHeight_ = std::max<u32>(thumbWidth_ * videoHeight / videoWidth, 2) & ~1u;
+    perSheet_ = settings_.columns * settings_.columns;
+
+    sheet_.assign(static_cast<usize>(thumbWidth_) * settings_.columns *
+                  thumbHeight_ * settings_.columns * 4, 0);
+    sheetIndex_ = 0;
+    sheetSlots_ = 0;
+    thumbs_.clear();
+    thumbCount_ = 0;
+    nextDue_ = 0.0;
+
+    stopping_ = false;
+    active_ = true;
+    worker_ = std::thread(&PreviewSheet::workerThread, this);
+
+    LOG_DEBUG("Preview sheet: {}x{} thumbnails every {}s",
+              thumbWidth_, thumbHeight_, settings_.intervalSec);
+    return Result<void>::ok();
+}
+
+bool PreviewSheet::due(f64 seconds) const {
+    return active_ && seconds >= nextDue_;
+}
+
+void PreviewSheet::submit(const AVFrame* frame, f64 seconds) {
+    if (!active_) return;
+
+    // Schedule from the interval grid so a late tap doesn't shift the rest
+    while (nextDue_ <= seconds) {
+        nextDue_ += settings_.intervalSec;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        if (queue_.size() >= MAX_PENDING) {
+            return;
+        }
+
+        // Shares the encoder input's buffers; the worker owns this reference
+        AVFrame* ref = av_frame_clone(frame);
+        if (!ref) return;
+        queue_.push_back({ref, seconds});
+    }
+    cond_.notify_one();
+}
+
+Result<void> PreviewSheet::finish() {
+    if (!active_) {
+        return Result<void>::ok();
+    }
+
+    stopWorker();
+    active_ = false;
+
+    if (sheetSlots_ > 0) {
+        if (auto result = flushSheet(); !result) {
+            return result;
+        }
+    }
+
+    if (thumbs_.empty()) {
+        return Result<void>::ok();
+    }
+
+    if (auto result = writeIndex(); !result) {
+        return result;
+    }
+
+    LOG_INFO("Wrote {} preview thumbnails in {} sheet(s)", thumbs_.size(), sheetIndex_);
+    return Result<void>::ok();
+}
+
+void PreviewSheet::cancel() {
+    stopWorker();
+    active_ = false;
+}
+
+void PreviewSheet::stopWorker() {
+    if (worker_.joinable()) {
+        stopping_ = true;
+        cond_.notify_all();
+        worker_.join();
+    }
+
+    std::lock_guard lock(mutex_);
+    for (auto& pending : queue_) {
+        av_frame_free(&pending.frame);
+    }
+    queue_.clear();
+
+    if (swsCtx_) {
+        sws_freeContext(swsCtx_);
+        swsCtx_ = nullptr;
+    }
+}
+
+void PreviewSheet::workerThread() {
+    // Thumbnails must never compete with the encoder
+    ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+
+    while (true) {
+        Pending pending;
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+
+            // Finish what's queued even when stopping, the last tap is often the best one
+            if (queue_.empty()) break;
+
+            pending = queue_.front();
+            queue_.pop_front();
+        }
+
+        addThumbnail(pending);
+        av_frame_free(&pending.frame);
+    }
+}
+
+void PreviewSheet::addThumbnail(const Pending& pending) {
+    const AVFrame* frame = pending.frame;
+
+    swsCtx_ = sws_getCachedContext(swsCtx_,
+        frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+        thumbWidth_, thumbHeight_, AV_PIX_FMT_RGBA,
+        SWS_AREA, nullptr, nullptr, nullptr);
+    if (!swsCtx_) {
+        LOG_WARN("Preview scaler unavailable for this pixel format");
+        return;
+    }
+
+    // Scale straight into the thumbnail's cell of the sheet
+    u32 col = sheetSlots_ % settings_.columns;
+    u32 row = sheetSlots_ / settings_.columns;
+    u32 x = col * thumbWidth_;
+    u32 y = row * thumbHeight_;
+    int stride = static_cast<int>(thumbWidth_ * settings_.columns * 4);
+
+    u8* dst[1] = { sheet_.data() + static_cast<usize>(y) * stride + static_cast<usize>(x) * 4 };
+    int dstStride[1] = { stride };
+    sws_scale(swsCtx_, frame->data, frame->linesize, 0, frame->height, dst, dstStride);
+
+    thumbs_.push_back({pending.seconds, sheetIndex_, x, y});
+    ++sheetSlots_;
+    ++thumbCount_;
+
+    // Full sheets go to disk right away so memory stays at one sheet
+    if (sheetSlots_ == perSheet_) {
+        if (auto result = flushSheet(); !result) {
+            LOG_WARN("Preview sheet: {}", result.error().message);
+        }
+    }
+}
+
+Result<void> PreviewSheet::flushSheet() {
+    // Only the rows in use; a final partial sheet shouldn't carry empty space
+    u32 rows = (sheetSlots_ + settings_.columns - 1) / settings_.columns;
+    u32 width = thumbWidth_ * settings_.columns;
+    u32 height = thumbHeight_ * rows;
+
+    std::vector<u8> used(sheet_.begin(), sheet_.begin() + static_cast<usize>(width) * height * 4);
+    auto result = writeJpeg(sheetPath(sheetIndex_), used, width, height);
+
+    std::fill(sheet_.begin(), sheet_.end(), 0);
+    ++sheetIndex_;
+    sheetSlots_ = 0;
+    return result;
+}
+
+Result<void> PreviewSheet::writeIndex() {
+    fs::path base = outputPath_.parent_path() / (outputPath_.stem().string() + "_sprites");
+    f64 interval = settings_.intervalSec;
+
+    // WebVTT, the format most players take for seek-bar previews
+    std::string vtt = "WEBVTT\n";
+    for (usize i = 0; i < thumbs_.size(); ++i) {
+        const auto& t = thumbs_[i];
+        f64 end = i + 1 < thumbs_.size() ? thumbs_[i + 1].seconds : t.seconds + interval;
+        vtt += std::format("\n{} --> {}\n{}#xywh={},{},{},{}\n",
+                           vttTime(t.seconds), vttTime(end),
+                           sheetPath(t.sheet).filename().string(),
+                           t.x, t.y, thumbWidth_, thumbHeight_);
+    }
+
+    if (auto result = file::writeText(fs::path(base) += ".vtt", vtt); !result) {
+        return result;
+    }
+
+    // JSON for the catalogue
+    std::string json = std::format(
+        "{{\n  \"video\": {},\n  \"interval\": {},\n  \"thumb_width\": {},\n"
+        "  \"thumb_height\": {},\n  \"columns\": {},\n  \"sheets\": [",
+        jsonString(outputPath_.filename().string()), settings_.intervalSec,
+        thumbWidth_, thumbHeight_, settings_.columns);
+
+    for (u32 i = 0; i < sheetIndex_; ++i) {
+        json += std::format("{}{}", i ? ", " : "", jsonString(sheetPath(i).filename().string()));
+    }
+    json += "],\n  \"thumbnails\": [\n";
+
+    for (usize i = 0; i < thumbs_.size(); ++i) {
+        const auto& t = thumbs_[i];
+        json += std::format("    {{\"time\": {:.3f}, \"sheet\": {}, \"x\": {}, \"y\": {}}}{}\n",
+                            t.seconds, t.sheet, t.x, t.y, i + 1 < thumbs_.size() ? "," : "");
+    }
+    json += "  ]\n}\n";
+
+    return file::writeText(fs::path(base) += ".json", json);
+}
+
+fs::path PreviewSheet::sheetPath(u32 index) const {
+    return outputPath_.parent_path() /
+           std::format("{}_sprites_{}.jpg", outputPath_.stem().string(), index);
+}
+
+} // namespace vc
@@ -0,0 +1,94 @@
+#pragma once
+// PreviewSheet.hpp - Sprite-sheet thumbnails built while recording
+// Saves the catalogue a full decode pass per video
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "EncoderSettings.hpp"
+
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+struct AVFrame;
+struct SwsContext;
+
+namespace vc {
+
+class PreviewSheet {
+public:
+    PreviewSheet();
+    ~PreviewSheet();
+
+    // Non-copyable
+    PreviewSheet(const PreviewSheet&) = delete;
+    PreviewSheet& operator=(const PreviewSheet&) = delete;
+
+    // Sheets and index land next to outputPath
+    Result<void> start(const PreviewSettings& settings, const fs::path& outputPath,
+                       u32 videoWidth, u32 videoHeight);
+
+    // Encoding thread: is a thumbnail due at this media time?
+    bool due(f64 seconds) const;
+
+    // Encoding thread: take a reference to a converted frame (no pixel copy)
+    void submit(const AVFrame* frame, f64 seconds);
+
+    // Drain the worker, write the last sheet and the VTT/JSON index
+    Result<void> finish();
+
+    // Throw everything away (failed recording)
+    void cancel();
+
+    bool active() const { return active_; }
+    usize thumbnailCount() const { return thumbCount_; }
+
+private:
+    struct Pending {
+        AVFrame* frame{nullptr};
+        f64 seconds{0.0};
+    };
+
+    struct Thumb {
+        f64 seconds{0.0};
+        u32 sheet{0};
+        u32 x{0};
+        u32 y{0};
+    };
+
+    void workerThread();
+    void addThumbnail(const Pending& pending);
+    Result<void> flushSheet();
+    Result<void> writeIndex();
+    fs::path sheetPath(u32 index) const;
+    void stopWorker();
+
+    PreviewSettings settings_;
+    fs::path outputPath_;
+    u32 thumbWidth_{0};
+    u32 thumbHeight_{0};
+    u32 perSheet_{0};
+
+    // Worker side
+    std::vector<u8> sheet_;     // RGBA, columns x columns thumbnails
+    u32 sheetIndex_{0};
+    u32 sheetSlots_{0};         // Thumbnails in the current sheet
+    std::vector<Thumb> thumbs_;
+    SwsContext* swsCtx_{nullptr};
+
+    std::deque<Pending> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread worker_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> active_{false};
+    std::atomic<usize> thumbCount_{0};
+    f64 nextDue_{0.0};
+
+    // A worker this far behind means the box is overloaded; skip a thumbnail
+    static constexpr usize MAX_PENDING = 4;
+};
+
+} // namespace vc
@@ -0,0 +1,54 @@
+#include "RecordingClock.hpp"
+
+namespace vc {
+
+void RecordingClock::reset(i64 startUs) {
+    std::lock_guard lock(mutex_);
+    startUs_ = startUs;
+    audioEndUs_ = 0.0;
+    offsetUs_ = 0.0;
+    hasAudio_ = false;
+}
+
+i64 RecordingClock::onAudio(u32 frames, u32 sampleRate, i64 timestampUs) {
+    if (sampleRate == 0) return 0;
+
+    std::lock_guard lock(mutex_);
+
+    f64 wallUs = static_cast<f64>(timestampUs - startUs_);
+
+    // Audio fell behind the wall clock (pause, device hiccup, or the
+    // recording started before playback): pad so later audio lands on time
+    i64 silenceUs = 0;
+    f64 gap = wallUs - audioEndUs_;
+    if (gap > STALL_THRESHOLD_US) {
+        silenceUs = static_cast<i64>(gap);
+        audioEndUs_ += static_cast<f64>(silenceUs);
+    }
+
+    // Where this buffer sits on the audio timeline vs when it arrived.
+    // Smoothed, since buffers arrive in bursts.
+    f64 offset = audioEndUs_ - wallUs;
+    offsetUs_ = hasAudio_ ? offsetUs_ * 0.95 + offset * 0.05 : offset;
+    hasAudio_ = true;
+
+    audioEndUs_ += static_cast<f64>(frames) * 1000000.0 / sampleRate;
+    return silenceUs;
+}
+
+i64 RecordingClock::mediaTimeAt(i64 timestampUs) const {
+    std::lock_guard lock(mutex_);
+    return timestampUs - startUs_ + static_cast<i64>(offsetUs_);
+}
+
+i64 RecordingClock::offsetUs() const {
+    std::lock_guard lock(mutex_);
+    return static_cast<i64>(offsetUs_);
+}
+
+bool RecordingClock::hasAudio() const {
+    std::lock_guard lock(mutex_);
+    return hasAudio_;
+}
+
+} // namespace vc
@@ -0,0 +1,40 @@
+#pragma once
+// RecordingClock.hpp - Audio master clock for recording
+// Video frames get placed on the audio timeline, not the other way round
+
+#include "util/Types.hpp"
+#include <mutex>
+
+namespace vc {
+
+class RecordingClock {
+public:
+    RecordingClock() = default;
+
+    // Start of recording, steady clock microseconds
+    void reset(i64 startUs);
+
+    // Account for an audio buffer that arrived at timestampUs.
+    // Returns how much silence (us) must precede it to cover a stall.
+    i64 onAudio(u32 frames, u32 sampleRate, i64 timestampUs);
+
+    // Position on the audio timeline (us since start) for a wall clock time.
+    // Falls back to wall clock until audio shows up.
+    i64 mediaTimeAt(i64 timestampUs) const;
+
+    // Audio timeline minus wall clock, smoothed
+    i64 offsetUs() const;
+    bool hasAudio() const;
+
+private:
+    mutable std::mutex mutex_;
+    i64 startUs_{0};
+    f64 audioEndUs_{0.0};       // Media time at the end of accepted audio
+    f64 offsetUs_{0.0};
+    bool hasAudio_{false};
+
+    // Anything shorter is buffer jitter, not a stall
+    static constexpr i64 STALL_THRESHOLD_US = 250000;
+};
+
+} // namespace vc
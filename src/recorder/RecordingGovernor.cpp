@@ -0,0 +1,132 @@
+#include "RecordingGovernor.hpp"
+#include <algorithm>
+#include <format>
+
+namespace vc {
+
+void RecordingGovernor::reset(u32 fps, u32 maxPresetSteps, f32 minRenderScale) {
+    state_ = GovernorState{};
+    maxPresetSteps_ = maxPresetSteps;
+    minRenderScale_ = std::clamp(minRenderScale, 0.25f, 1.0f);
+    frameBudgetMs_ = 1000.0 / std::max<u32>(fps, 1);
+    avgEncodeMs_ = 0.0;
+    haveSample_ = false;
+    overloadedTicks_ = 0;
+    healthyTicks_ = 0;
+}
+
+void RecordingGovernor::recordEncodeTime(f64 ms) {
+    // EWMA so one slow keyframe doesn't trigger anything
+    avgEncodeMs_ = haveSample_ ? avgEncodeMs_ * 0.9 + ms * 0.1 : ms;
+    haveSample_ = true;
+}
+
+std::optional<RecordingAdaptation> RecordingGovernor::evaluate(usize queueDepth, usize queueCapacity,
+                                                               u32 newDrops, Duration elapsed) {
+    if (!enabled_) return std::nullopt;
+
+    f64 fill = queueCapacity > 0 ? static_cast<f64>(queueDepth) / queueCapacity : 0.0;
+
+    // With a stride, each encoded frame gets several frame periods
+    f64 budget = frameBudgetMs_ * state_.frameStride;
+
+    bool overloaded = newDrops > 0 || fill > 0.5 || avgEncodeMs_ > budget * 0.9;
+    bool critical = newDrops > 0 || fill > 0.75;
+    bool healthy = fill < 0.1 && avgEncodeMs_ < budget * 0.5;
+
+    std::string action;
+    std::string reason;
+
+    if (overloaded) {
+        healthyTicks_ = 0;
+        ++overloadedTicks_;
+
+        if (critical || overloadedTicks_ >= ESCALATE_TICKS) {
+            overloadedTicks_ = 0;
+            if (escalate(action)) {
+                reason = newDrops > 0
+                    ? std::format("{} frames dropped", newDrops)
+                    : std::format("queue {:.0f}%, encode {:.1f}/{:.1f} ms", fill * 100.0, avgEncodeMs_, budget);
+            }
+        }
+    } else if (healthy) {
+        overloadedTicks_ = 0;
+        ++healthyTicks_;
+
+        if (healthyTicks_ >= RELAX_TICKS) {
+            healthyTicks_ = 0;
+            if (relax(action)) {
+                reason = std::format("encode {:.1f}/{:.1f} ms", avgEncodeMs_, budget);
+            }
+        }
+    } else {
+        overloadedTicks_ = 0;
+        healthyTicks_ = 0;
+    }
+
+    if (action.empty()) return std::nullopt;
+    return RecordingAdaptation{elapsed, std::move(action), std::move(reason)};
+}
+
+bool RecordingGovernor::escalate(std::string& action) {
+    // Cheapest visible cost first: encoder effort, then render detail,
+    // then motion smoothness, and only then letting frames fall on the floor
+    if (state_.presetSteps < maxPresetSteps_) {
+        ++state_.presetSteps;
+        action = std::format("encoder preset +{} faster", state_.presetSteps);
+        return true;
+    }
+
+    if (state_.renderScale - RENDER_SCALE_STEP >= minRenderScale_ - 0.001f) {
+        state_.renderScale -= RENDER_SCALE_STEP;
+        action = std::format("render scale {:.0f}%", state_.renderScale * 100.0f);
+        return true;
+    }
+
+    if (state_.frameStride < MAX_FRAME_STRIDE) {
+        ++state_.frameStride;
+        action = std::format("capture every {} frames", state_.frameStride);
+        return true;
+    }
+
+    if (!state_.dropping) {
+        state_.dropping = true;
+        action = "dropping frames";
+        return true;
+    }
+
+    return false;
+}
+
+bool RecordingGovernor::relax(std::string& action) {
+    // Undo in reverse order
+    if (state_.dropping) {
+        state_.dropping = false;
+        action = "stopped dropping";
+        return true;
+    }
+
+    if (state_.frameStride > 1) {
+        --state_.frameStride;
+        action = std::format("capture every {} frames", state_.frameStride);
+        return true;
+    }
+
+    if (state_.renderScale < 1.0f - 0.001f) {
+        state_.renderScale = std::min(1.0f, state_.renderScale + RENDER_SCALE_STEP);
+        action = std::format("render scale {:.0f}%", state_.renderScale * 100.0f);
+        return true;
+    }
+
+    if (state_.presetSteps > 0) {
+        --state_.presetSteps;
+        action = state_.presetSteps > 0
+            ? std::format("encoder preset +{} faster", state_.presetSteps)
+            : std::string("encoder preset restored");
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace vc
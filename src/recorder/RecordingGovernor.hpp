@@ -0,0 +1,66 @@
+#pragma once
+// RecordingGovernor.hpp - Adaptive quality control for live recording
+// When the encoder falls behind, give up quality in the least visible order
+
+#include "util/Types.hpp"
+#include <optional>
+
+namespace vc {
+
+// One step taken by the governor, kept for the recording stats
+struct RecordingAdaptation {
+    Duration at{0};         // Recording time when it happened
+    std::string action;     // e.g. "render scale 75%"
+    std::string reason;     // e.g. "queue 80%"
+};
+
+// What the recorder and renderer should currently do
+struct GovernorState {
+    u32 presetSteps{0};     // Encoder presets faster than requested
+    f32 renderScale{1.0f};  // Internal ProjectM resolution factor
+    u32 frameStride{1};     // Capture every Nth frame
+    bool dropping{false};   // Out of options, grabber drops oldest frames
+};
+
+class RecordingGovernor {
+public:
+    RecordingGovernor() = default;
+
+    // Start fresh for a new recording
+    void reset(u32 fps, u32 maxPresetSteps, f32 minRenderScale);
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool enabled() const { return enabled_; }
+
+    // Feed one encoded frame's conversion + encode time
+    void recordEncodeTime(f64 ms);
+
+    // Periodic check (~2 Hz). Returns the step taken, if any.
+    std::optional<RecordingAdaptation> evaluate(usize queueDepth, usize queueCapacity,
+                                                u32 newDrops, Duration elapsed);
+
+    const GovernorState& state() const { return state_; }
+    f64 avgEncodeMs() const { return avgEncodeMs_; }
+
+private:
+    bool escalate(std::string& action);
+    bool relax(std::string& action);
+
+    GovernorState state_;
+    bool enabled_{true};
+
+    u32 maxPresetSteps_{0};
+    f32 minRenderScale_{0.5f};
+    f64 frameBudgetMs_{16.67};
+    f64 avgEncodeMs_{0.0};
+    bool haveSample_{false};
+
+    u32 overloadedTicks_{0};
+    u32 healthyTicks_{0};
+
+    static constexpr u32 MAX_FRAME_STRIDE = 2;
+    static constexpr f32 RENDER_SCALE_STEP = 0.25f;
+    static constexpr u32 ESCALATE_TICKS = 2;    // ~1s of sustained pressure
+    static constexpr u32 RELAX_TICKS = 10;      // ~5s of headroom before undoing a step
+};
+
+} // namespace vc
@@ -0,0 +1,293 @@
+#include "StreamSink.hpp"
+#include "core/Logger.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace vc {
+
+StreamSink::StreamSink() = default;
+
+StreamSink::~StreamSink() {
+    close();
+}
+
+Result<void> StreamSink::open(const StreamSettings& settings) {
+    close();
+
+    Result<void> result;
+    switch (settings.target) {
+        case OutputTarget::Stdout:     result = openStdout(); break;
+        case OutputTarget::Pipe:       result = openPipe(settings.path); break;
+        case OutputTarget::UnixSocket: result = openSocket(settings.path); break;
+        case OutputTarget::File:
+            return Result<void>::err("StreamSink does not handle file output");
+    }
+
+    if (!result) {
+        return result;
+    }
+
+    // A reader hanging up should be an error we report, not a SIGPIPE that kills us
+    if (!isSocket_) {
+        std::signal(SIGPIPE, SIG_IGN);
+    }
+
+    capacity_ = std::max<usize>(settings.bufferKB, 64) * 1024;
+    queuedBytes_ = 0;
+    chunks_.clear();
+    closing_ = false;
+    failed_ = false;
+    bytesSent_ = 0;
+
+    writerThread_ = std::thread(&StreamSink::writerThread, this);
+
+    LOG_INFO("Stream output opened: {} ({} KB buffer)", settings.describe(), capacity_ / 1024);
+    return Result<void>::ok();
+}
+
+Result<void> StreamSink::openStdout() {
+    if (::isatty(STDOUT_FILENO)) {
+        return Result<void>::err("Refusing to stream video to a terminal, pipe stdout somewhere");
+    }
+
+    fd_ = STDOUT_FILENO;
+    ownsFd_ = false;
+    isSocket_ = false;
+    nonBlocking_ = false;
+    return Result<void>::ok();
+}
+
+Result<void> StreamSink::openPipe(const fs::path& path) {
+    if (!fs::exists(path)) {
+        if (::mkfifo(path.c_str(), 0600) != 0) {
+            return Result<void>::err("Failed to create FIFO " + path.string() + ": " + std::strerror(errno));
+        }
+    }
+
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0 || !S_ISFIFO(st.st_mode)) {
+        return Result<void>::err("Not a named pipe: " + path.string());
+    }
+
+    // Non-blocking open fails fast instead of hanging the GUI until a reader shows up
+    int fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENXIO) {
+            return Result<void>::err("No reader on " + path.string() + ", start the relay first");
+        }
+        return Result<void>::err("Failed to open FIFO " + path.string() + ": " + std::strerror(errno));
+    }
+
+    // Stays non-blocking: the writer thread waits in poll() so it can
+    // notice a close or a stalled reader instead of hanging in write()
+#ifdef F_SETPIPE_SZ
+    // Bigger kernel buffer rides out short reader hiccups; failure is harmless
+    ::fcntl(fd, F_SETPIPE_SZ, 1024 * 1024);
+#endif
+
+    fd_ = fd;
+    ownsFd_ = true;
+    isSocket_ = false;
+    nonBlocking_ = true;
+    return Result<void>::ok();
+}
+
+Result<void> StreamSink::openSocket(const fs::path& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    const auto& native = path.native();
+    if (native.size() >= sizeof(addr.sun_path)) {
+        return Result<void>::err("Socket path too long: " + path.string());
+    }
+    std::memcpy(addr.sun_path, native.c_str(), native.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return Result<void>::err(std::string("Failed to create socket: ") + std::strerror(errno));
+    }
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int err = errno;
+        ::close(fd);
+        return Result<void>::err("Failed to connect to " + path.string() + ": " + std::strerror(err));
+    }
+
+    int flags = ::fcntl(fd, F_GETFL);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    fd_ = fd;
+    ownsFd_ = true;
+    isSocket_ = true;
+    nonBlocking_ = true;
+    return Result<void>::ok();
+}
+
+void StreamSink::close() {
+    if (fd_ < 0) return;
+
+    // Under the lock, or the writer can miss it between its predicate
+    // check and going to sleep
+    {
+        std::lock_guard lock(mutex_);
+        closing_ = true;
+    }
+    dataCond_.notify_all();
+    spaceCond_.notify_all();
+
+    // The writer drains what's queued, but gives up once the reader has
+    // taken nothing for STALL_TIMEOUT, so this is bounded
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+
+    if (ownsFd_) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    ownsFd_ = false;
+
+    {
+        std::lock_guard lock(mutex_);
+        chunks_.clear();
+        queuedBytes_ = 0;
+    }
+
+    LOG_INFO("Stream output closed, {} sent", bytesSent_.load());
+}
+
+bool StreamSink::write(const u8* data, usize size) {
+    if (fd_ < 0 || failed_) return false;
+    if (size == 0) return true;
+
+    std::unique_lock lock(mutex_);
+
+    // Backpressure: wait for the reader rather than growing without bound.
+    // An oversized chunk is let through once the queue is empty.
+    bool hasSpace = spaceCond_.wait_for(lock, STALL_TIMEOUT, [this, size] {
+        return failed_ || closing_ || queuedBytes_ == 0 || queuedBytes_ + size <= capacity_;
+    });
+
+    if (!hasSpace) {
+        LOG_ERROR("Stream reader stalled for {}s, giving up",
+                  chr::duration_cast<chr::seconds>(STALL_TIMEOUT).count());
+        failed_ = true;
+        dataCond_.notify_all();
+        return false;
+    }
+
+    if (failed_) return false;
+
+    chunks_.emplace_back(data, data + size);
+    queuedBytes_ += size;
+    lock.unlock();
+
+    dataCond_.notify_one();
+    return true;
+}
+
+bool StreamSink::backlogged() const {
+    std::lock_guard lock(mutex_);
+    return queuedBytes_ > capacity_ / 2;
+}
+
+usize StreamSink::queuedBytes() const {
+    std::lock_guard lock(mutex_);
+    return queuedBytes_;
+}
+
+void StreamSink::writerThread() {
+    LOG_DEBUG("Stream writer thread started");
+
+    while (true) {
+        std::vector<u8> chunk;
+        {
+            std::unique_lock lock(mutex_);
+            dataCond_.wait(lock, [this] {
+                return !chunks_.empty() || closing_ || failed_;
+            });
+
+            if (failed_ || chunks_.empty()) {
+                break;  // Closing with nothing left to drain, or reader gone
+            }
+
+            chunk = std::move(chunks_.front());
+            chunks_.pop_front();
+        }
+
+        bool ok = writeAll(chunk.data(), chunk.size());
+
+        {
+            std::lock_guard lock(mutex_);
+            queuedBytes_ -= chunk.size();
+        }
+        spaceCond_.notify_all();
+
+        if (!ok) {
+            failed_ = true;
+            spaceCond_.notify_all();
+            break;
+        }
+    }
+
+    LOG_DEBUG("Stream writer thread stopped");
+}
+
+bool StreamSink::writeAll(const u8* data, usize size) {
+    auto lastProgress = chr::steady_clock::now();
+
+    while (size > 0) {
+        // write() gave up on the reader; don't keep pushing at it
+        if (failed_) return false;
+
+        pollfd pfd{fd_, POLLOUT, 0};
+        int ready = ::poll(&pfd, 1, POLL_SLICE_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Stream poll failed: {}", std::strerror(errno));
+            return false;
+        }
+        if (ready == 0) {
+            if (chr::steady_clock::now() - lastProgress >= STALL_TIMEOUT) {
+                LOG_ERROR("Stream reader stalled for {}s, giving up",
+                          chr::duration_cast<chr::seconds>(STALL_TIMEOUT).count());
+                return false;
+            }
+            continue;
+        }
+
+        // On a blocking pipe a write of up to PIPE_BUF can't block once
+        // POLLOUT is set; anything larger could
+        usize chunk = nonBlocking_ ? size : std::min<usize>(size, PIPE_BUF);
+        ssize_t n = isSocket_
+            ? ::send(fd_, data, chunk, MSG_NOSIGNAL)
+            : ::write(fd_, data, chunk);
+
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+            if (errno == EPIPE || errno == ECONNRESET) {
+                LOG_WARN("Stream reader disconnected");
+            } else {
+                LOG_ERROR("Stream write failed: {}", std::strerror(errno));
+            }
+            return false;
+        }
+
+        data += n;
+        size -= static_cast<usize>(n);
+        bytesSent_ += static_cast<u64>(n);
+        lastProgress = chr::steady_clock::now();
+    }
+    return true;
+}
+
+} // namespace vc
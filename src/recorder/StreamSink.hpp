@@ -0,0 +1,73 @@
+#pragma once
+// StreamSink.hpp - Non-file output for live recording
+// Feeds muxed bytes to stdout, a FIFO or a Unix socket without letting a slow reader eat our RAM
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "EncoderSettings.hpp"
+
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace vc {
+
+class StreamSink {
+public:
+    StreamSink();
+    ~StreamSink();
+
+    // Non-copyable
+    StreamSink(const StreamSink&) = delete;
+    StreamSink& operator=(const StreamSink&) = delete;
+
+    // Connect to the reader and start the writer thread
+    Result<void> open(const StreamSettings& settings);
+
+    // Drain queued bytes and disconnect
+    void close();
+
+    // Queue muxed bytes (called from the AVIO write callback).
+    // Blocks while the queue is full; returns false once the reader is gone.
+    bool write(const u8* data, usize size);
+
+    // State
+    bool isOpen() const { return fd_ >= 0; }
+    bool failed() const { return failed_; }
+    bool backlogged() const;    // Queue above the high-water mark
+    usize queuedBytes() const;
+    u64 bytesSent() const { return bytesSent_; }
+
+private:
+    Result<void> openStdout();
+    Result<void> openPipe(const fs::path& path);
+    Result<void> openSocket(const fs::path& path);
+
+    void writerThread();
+    bool writeAll(const u8* data, usize size);
+
+    int fd_{-1};
+    bool ownsFd_{false};
+    bool isSocket_{false};
+    bool nonBlocking_{false};   // Stdout isn't ours to switch; it gets PIPE_BUF-sized writes
+
+    std::deque<std::vector<u8>> chunks_;
+    usize queuedBytes_{0};
+    usize capacity_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable dataCond_;
+    std::condition_variable spaceCond_;
+
+    std::thread writerThread_;
+    std::atomic<bool> closing_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<u64> bytesSent_{0};
+
+    // A reader that hasn't taken a byte for this long is considered dead
+    static constexpr auto STALL_TIMEOUT = chr::seconds(5);
+    static constexpr int POLL_SLICE_MS = 100;   // How often a blocked writer checks for close/failure
+};
+
+} // namespace vc
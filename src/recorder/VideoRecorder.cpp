@@ -10,11 +10,14 @@ extern "C" {
 #include <libavutil/imgutils.h>
 #include <libavutil/channel_layout.h>
 #include <libavutil/mathematics.h>
+#include <libavutil/audio_fifo.h>
 #include <libswscale/swscale.h>
 #include <libswresample/swresample.h>
 }
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 namespace vc {
 
@@ -26,6 +29,48 @@ std::string ffmpegError(int err) {
     return buf;
 }
 
+// MPEG-TS packets are 188 bytes; keep AVIO chunks aligned to them
+constexpr int STREAM_AVIO_BUFFER_SIZE = 188 * 64;
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+int streamWritePacket(void* opaque, const uint8_t* buf, int size) {
+#else
+int streamWritePacket(void* opaque, uint8_t* buf, int size) {
+#endif
+    auto* sink = static_cast<StreamSink*>(opaque);
+    return sink->write(buf, static_cast<usize>(size)) ? size : AVERROR(EPIPE);
+}
+
+// Longer gaps are left as a held frame rather than re-encoded
+constexpr i64 MAX_DUPLICATE_FRAMES = 8;
+
+f64 msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Closest format the encoder actually takes (ProRes wants 10-bit, FFV1 planar RGB...)
+AVPixelFormat pickPixelFormat(const AVCodec* codec, PixelFormat requested) {
+    std::vector<AVPixelFormat> wanted;
+    switch (requested) {
+        case PixelFormat::YUV420P: wanted = {AV_PIX_FMT_YUV420P}; break;
+        case PixelFormat::YUV422P: wanted = {AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV422P10LE}; break;
+        case PixelFormat::YUV444P: wanted = {AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV444P10LE}; break;
+        case PixelFormat::RGB24:   wanted = {AV_PIX_FMT_GBRP, AV_PIX_FMT_BGR0, AV_PIX_FMT_RGB24}; break;
+    }
+    
+    if (!codec->pix_fmts) {
+        return wanted.front();
+    }
+    
+    for (AVPixelFormat fmt : wanted) {
+        for (const AVPixelFormat* p = codec->pix_fmts; *p != AV_PIX_FMT_NONE; ++p) {
+            if (*p == fmt) return fmt;
+        }
+    }
+    
+    return codec->pix_fmts[0];
+}
+
 } // namespace
 
 VideoRecorder::VideoRecorder() = default;
@@ -49,12 +94,16 @@ Result<void> VideoRecorder::start(const EncoderSettings& settings) {
     settings_ = settings;
     
     // Ensure output directory exists
-    file::ensureDir(settings_.outputPath.parent_path());
+    if (!settings_.stream.isStream()) {
+        file::ensureDir(settings_.outputPath.parent_path());
+    }
     
     // Initialize FFmpeg
     state_ = RecordingState::Starting;
     stateChanged.emitSignal(state_);
     
+    activePreset_ = settings_.video.preset;
+    
     if (auto result = initFFmpeg(); !result) {
         cleanupFFmpeg();
         state_ = RecordingState::Error;
@@ -64,7 +113,33 @@ Result<void> VideoRecorder::start(const EncoderSettings& settings) {
     
     // Reset stats
     stats_ = RecordingStats{};
-    stats_.currentFile = settings_.outputPath.string();
+    stats_.currentFile = settings_.stream.isStream() 
+                         ? settings_.stream.describe() : settings_.outputPath.string();
+    streamErrorReported_ = false;
+    stats_.encoderPreset = settings_.video.presetName();
+    
+    // Preset switches need a fresh encoder, which only works when codec
+    // headers travel in-band (MPEG-TS); MP4/MKV fix them at write_header
+    bool x26x = settings_.video.codec == VideoCodec::H264 ||
+                settings_.video.codec == VideoCodec::H265;
+    bool inBandHeaders = !(formatCtx_->oformat->flags & AVFMT_GLOBALHEADER);
+    u32 maxPresetSteps = (x26x && inBandHeaders)
+                         ? std::min(2, static_cast<int>(settings_.video.preset)) : 0;
+    
+    governor_.reset(settings_.video.fps, maxPresetSteps, settings_.minRenderScale);
+    governor_.setEnabled(settings_.adaptiveQuality);
+    renderScale_ = 1.0f;
+    frameStride_ = 1;
+    captureCount_ = 0;
+    lastDroppedFrames_ = 0;
+    
+    if (settings_.preview.enabled && !settings_.stream.isStream()) {
+        if (auto result = previewSheet_.start(settings_.preview, settings_.outputPath,
+                                              settings_.video.width, settings_.video.height);
+            !result) {
+            LOG_WARN("Preview thumbnails disabled: {}", result.error().message);
+        }
+    }
     
     // Start encoding thread
     shouldStop_ = false;
@@ -73,13 +148,18 @@ Result<void> VideoRecorder::start(const EncoderSettings& settings) {
     
     startTime_ = std::chrono::duration_cast<std::chrono::microseconds>(
         std::chrono::steady_clock::now().time_since_epoch()).count();
+    clock_.reset(startTime_);
+    {
+        std::lock_guard lock(audioMutex_);
+        audioChunks_.clear();
+    }
     
     encodingThread_ = std::thread(&VideoRecorder::encodingThread, this);
     
     state_ = RecordingState::Recording;
     stateChanged.emitSignal(state_);
     
-    LOG_INFO("Recording started: {}", settings_.outputPath.string());
+    LOG_INFO("Recording started: {}", stats_.currentFile);
     return Result<void>::ok();
 }
 
@@ -106,6 +186,9 @@ Result<void> VideoRecorder::stop() {
         encodingThread_.join();
     }
     
+    // Audio that arrived after the thread's last pass
+    processAudioBuffer();
+    
     // Flush encoders and finalize file
     {
         std::lock_guard lock(ffmpegMutex_);
@@ -119,15 +202,41 @@ Result<void> VideoRecorder::stop() {
     
     cleanupFFmpeg();
     
+    if (previewSheet_.active()) {
+        if (auto result = previewSheet_.finish(); !result) {
+            LOG_WARN("Preview thumbnails: {}", result.error().message);
+        }
+        stats_.previewThumbnails = previewSheet_.thumbnailCount();
+    }
+    
+    // Hand the visualizer back its full resolution
+    renderScale_ = 1.0f;
+    frameStride_ = 1;
+    
     state_ = RecordingState::Stopped;
     stateChanged.emitSignal(state_);
     
-    LOG_INFO("Recording stopped. Frames: {}, Dropped: {}", 
-             stats_.framesWritten, stats_.framesDropped);
+    LOG_INFO("Recording stopped. Frames: {}, Dropped: {}, Adaptations: {}", 
+             stats_.framesWritten, stats_.framesDropped, stats_.adaptations.size());
     
     return Result<void>::ok();
 }
 
+void VideoRecorder::captureFrame(RenderTarget& target, i64 timestamp) {
+    if (state_ != RecordingState::Recording) return;
+    
+    // Decimate before the readback so skipped frames cost nothing;
+    // the grabber still counts them so PTS keeps real time
+    u32 stride = frameStride_;
+    u32 index = captureCount_++;
+    if (stride > 1 && index % stride != 0) {
+        frameGrabber_.skip();
+        return;
+    }
+    
+    frameGrabber_.grab(target, timestamp);
+}
+
 void VideoRecorder::submitVideoFrame(const u8* data, u32 width, u32 height, i64 timestamp) {
     if (state_ != RecordingState::Recording) return;
     
@@ -143,22 +252,30 @@ void VideoRecorder::submitVideoFrame(const u8* data, u32 width, u32 height, i64
     processVideoFrame(frame);
 }
 
-void VideoRecorder::submitAudioSamples(const f32* data, u32 samples, u32 channels, u32 sampleRate) {
+void VideoRecorder::submitAudioSamples(const f32* data, u32 samples, u32 channels, u32 sampleRate,
+                                       i64 timestamp) {
     if (state_ != RecordingState::Recording) return;
-    if (!audioStream_) return;
+    if (!audioStream_ || channels == 0 || sampleRate == 0) return;
     
-    std::lock_guard lock(audioMutex_);
-    audioSampleRate_ = sampleRate;
-    audioChannels_ = channels;
+    AudioChunk chunk;
+    chunk.channels = channels;
+    chunk.sampleRate = sampleRate;
+    chunk.silenceUs = clock_.onAudio(samples, sampleRate, timestamp);
+    chunk.samples.assign(data, data + samples * channels);
+    
+    if (chunk.silenceUs > 0) {
+        LOG_DEBUG("Audio stalled, padding {} ms of silence", chunk.silenceUs / 1000);
+    }
     
-    usize size = samples * channels;
-    audioBuffer_.insert(audioBuffer_.end(), data, data + size);
+    std::lock_guard lock(audioMutex_);
+    audioChunks_.push_back(std::move(chunk));
 }
 
 void VideoRecorder::encodingThread() {
     LOG_DEBUG("Encoding thread started");
     
     auto lastStatsUpdate = std::chrono::steady_clock::now();
+    auto lastGovernorUpdate = lastStatsUpdate;
     
     while (!shouldStop_) {
         // Process video frames from grabber
@@ -170,19 +287,37 @@ void VideoRecorder::encodingThread() {
         // Process audio
         processAudioBuffer();
         
-        // Update stats periodically
+        // Reader went away: report once, the user decides when to stop
+        if (streamSink_.failed() && !streamErrorReported_) {
+            streamErrorReported_ = true;
+            error.emitSignal("Stream reader disconnected: " + stats_.currentFile);
+        }
+        
         auto now = std::chrono::steady_clock::now();
+        Duration elapsed(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - std::chrono::steady_clock::time_point(
+                    std::chrono::microseconds(startTime_))).count());
+        
+        // Check encoder pressure twice a second
+        if (now - lastGovernorUpdate >= std::chrono::milliseconds(500)) {
+            updateGovernor(elapsed);
+            lastGovernorUpdate = now;
+        }
+        
+        // Update stats periodically
         if (now - lastStatsUpdate >= std::chrono::seconds(1)) {
-            stats_.elapsed = Duration(
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - std::chrono::steady_clock::time_point(
-                        std::chrono::microseconds(startTime_))).count());
+            stats_.elapsed = elapsed;
             
             if (stats_.elapsed.count() > 0) {
                 stats_.avgFps = static_cast<f64>(stats_.framesWritten) * 1000.0 / stats_.elapsed.count();
             }
             
             stats_.framesDropped = frameGrabber_.droppedFrames();
+            stats_.audioClockOffsetMs = clock_.offsetUs() / 1000.0;
+            if (streamSink_.isOpen()) {
+                stats_.streamBytesQueued = streamSink_.queuedBytes();
+            }
             statsUpdated.emitSignal(stats_);
             lastStatsUpdate = now;
         }
@@ -191,55 +326,241 @@ void VideoRecorder::encodingThread() {
     LOG_DEBUG("Encoding thread stopped");
 }
 
+void VideoRecorder::updateGovernor(Duration elapsed) {
+    u32 dropped = frameGrabber_.droppedFrames();
+    u32 newDrops = dropped - lastDroppedFrames_;
+    lastDroppedFrames_ = dropped;
+    
+    std::lock_guard lock(ffmpegMutex_);
+    
+    auto adaptation = governor_.evaluate(frameGrabber_.queueSize(), frameGrabber_.queueCapacity(),
+                                         newDrops, elapsed);
+    if (!adaptation) return;
+    
+    const auto& state = governor_.state();
+    
+    auto preset = static_cast<EncoderPreset>(
+        static_cast<int>(settings_.video.preset) - static_cast<int>(state.presetSteps));
+    if (preset != activePreset_ && videoCodecCtx_) {
+        switchVideoPreset(preset);
+    }
+    
+    renderScale_ = state.renderScale;
+    frameStride_ = state.frameStride;
+    
+    VideoSettings active = settings_.video;
+    active.preset = activePreset_;
+    stats_.encoderPreset = active.presetName();
+    stats_.renderScale = state.renderScale;
+    stats_.frameStride = state.frameStride;
+    
+    LOG_INFO("Recording governor: {} ({})", adaptation->action, adaptation->reason);
+    stats_.adaptations.push_back(std::move(*adaptation));
+}
+
+bool VideoRecorder::switchVideoPreset(EncoderPreset preset) {
+    // Drain the old encoder so nothing it buffered is lost
+    avcodec_send_frame(videoCodecCtx_, nullptr);
+    while (avcodec_receive_packet(videoCodecCtx_, packet_) >= 0) {
+        writePacket(packet_, videoStream_);
+    }
+    avcodec_free_context(&videoCodecCtx_);
+    
+    EncoderPreset previous = activePreset_;
+    if (auto result = openVideoEncoder(preset, true); !result) {
+        LOG_WARN("Preset switch failed: {}", result.error().message);
+        avcodec_free_context(&videoCodecCtx_);
+        
+        if (auto retry = openVideoEncoder(previous, true); !retry) {
+            avcodec_free_context(&videoCodecCtx_);
+            error.emitSignal("Video encoder lost: " + retry.error().message);
+            return false;
+        }
+        return false;
+    }
+    
+    activePreset_ = preset;
+    return true;
+}
+
 void VideoRecorder::processVideoFrame(const GrabbedFrame& frame) {
     std::lock_guard lock(ffmpegMutex_);
     
     if (!videoCodecCtx_ || !videoFrame_) return;
     
-    // Convert RGBA to YUV420P
+    auto encodeStart = std::chrono::steady_clock::now();
+    
+    if (streamSink_.isOpen()) {
+        if (streamSink_.failed()) return;
+        
+        // Skip the frame but keep its PTS slot, so the reader sees a
+        // held frame instead of a timeline that runs fast
+        if (settings_.stream.dropPolicy == StreamDropPolicy::DropFrames &&
+            streamSink_.backlogged()) {
+            ++videoFrameCount_;
+            ++stats_.streamFramesDropped;
+            return;
+        }
+    }
+    
+    // Place the frame on the audio master clock. videoFrameCount_ is the next free slot.
+    i64 pts = std::max<i64>(frame.frameNumber, videoFrameCount_);
+    i64 mediaUs = 0;
+    
+    if (frame.timestamp > 0) {
+        i64 fps = settings_.video.fps;
+        mediaUs = clock_.mediaTimeAt(frame.timestamp);
+        i64 target = (mediaUs * fps + 500000) / 1000000;
+        
+        if (target < videoFrameCount_ - 1) {
+            // Video is more than a frame ahead of the audio: let the audio catch up
+            ++stats_.framesSkipped;
+            return;
+        }
+        
+        pts = std::max(target, videoFrameCount_);
+        
+        // Video fell behind: repeat the last picture so the output stays
+        // constant frame rate, unless the governor is deliberately thinning it
+        const auto& gov = governor_.state();
+        i64 gap = pts - videoFrameCount_;
+        if (gap > 0 && gap <= MAX_DUPLICATE_FRAMES && stats_.framesWritten > 0 &&
+            gov.frameStride == 1 && !gov.dropping) {
+            for (i64 slot = videoFrameCount_; slot < pts; ++slot) {
+                videoFrame_->pts = slot;
+                if (encodeVideoFrame(videoFrame_)) {
+                    ++stats_.framesDuplicated;
+                }
+            }
+        }
+    }
+    
+    // The encoder may still hold a reference to the previous picture
+    if (av_frame_make_writable(videoFrame_) < 0) {
+        LOG_WARN("Video frame not writable, skipping");
+        return;
+    }
+    
+    // Convert RGBA to the encoder's pixel format
+    auto convertStart = std::chrono::steady_clock::now();
     const u8* srcData[1] = { frame.data.data() };
     int srcLinesize[1] = { static_cast<int>(frame.width * 4) };
     
     sws_scale(swsCtx_, srcData, srcLinesize, 0, frame.height,
               videoFrame_->data, videoFrame_->linesize);
+    stats_.convertMs += msSince(convertStart);
+    
+    videoFrame_->pts = pts;
+    videoFrameCount_ = pts + 1;
     
-    // Set PTS
-    videoFrame_->pts = videoFrameCount_++;
+    if (frame.timestamp > 0) {
+        f64 drift = (pts * 1000000.0 / settings_.video.fps - mediaUs) / 1000.0;
+        stats_.avDriftMs = drift;
+        stats_.maxAvDriftMs = std::max(stats_.maxAvDriftMs, std::abs(drift));
+    }
+    
+    // Thumbnail tap shares the converted buffers; make_writable above
+    // copies on the next frame if the worker still holds them
+    f64 seconds = static_cast<f64>(pts) / settings_.video.fps;
+    if (previewSheet_.due(seconds)) {
+        previewSheet_.submit(videoFrame_, seconds);
+    }
     
     // Encode
     if (encodeVideoFrame(videoFrame_)) {
         ++stats_.framesWritten;
     }
+    
+    governor_.recordEncodeTime(std::chrono::duration<f64, std::milli>(
+        std::chrono::steady_clock::now() - encodeStart).count());
 }
 
 void VideoRecorder::processAudioBuffer() {
-    std::lock_guard lock(audioMutex_);
+    std::deque<AudioChunk> chunks;
+    {
+        std::lock_guard lock(audioMutex_);
+        chunks.swap(audioChunks_);
+    }
+    
+    if (chunks.empty()) return;
     
-    if (!audioCodecCtx_ || !audioFrame_ || audioBuffer_.empty()) return;
+    std::lock_guard lock(ffmpegMutex_);
     
-    int frameSize = audioCodecCtx_->frame_size;
-    int channels = audioChannels_;
+    if (!audioCodecCtx_ || !audioFrame_ || !audioFifo_) return;
     
-    while (audioBuffer_.size() >= static_cast<usize>(frameSize * channels)) {
-        // Fill audio frame
-        std::vector<f32> samples(audioBuffer_.begin(), 
-                                  audioBuffer_.begin() + frameSize * channels);
-        audioBuffer_.erase(audioBuffer_.begin(), 
-                           audioBuffer_.begin() + frameSize * channels);
+    for (const auto& chunk : chunks) {
+        if (chunk.silenceUs > 0) {
+            writeAudioSilence(chunk.silenceUs);
+        }
+        
+        if (chunk.samples.empty()) continue;
         
-        // Convert to encoder format using swresample
-        // For now, assuming float planar input matches
-        // In production, use swr_convert
+        // Follow the source format; the encoder side never changes
+        if (chunk.sampleRate != swrInputRate_ || chunk.channels != swrInputChannels_) {
+            if (auto result = initResampler(chunk.sampleRate, chunk.channels); !result) {
+                LOG_WARN("Audio resampler: {}", result.error().message);
+                continue;
+            }
+        }
         
-        const u8* srcData[1] = { reinterpret_cast<const u8*>(samples.data()) };
+        int inFrames = static_cast<int>(chunk.samples.size() / chunk.channels);
+        int maxOut = swr_get_out_samples(swrCtx_, inFrames);
+        if (maxOut <= 0) continue;
         
-        int ret = swr_convert(swrCtx_, audioFrame_->data, frameSize,
-                              srcData, frameSize);
+        u8** converted = nullptr;
+        int ret = av_samples_alloc_array_and_samples(&converted, nullptr,
+                                                     audioCodecCtx_->ch_layout.nb_channels,
+                                                     maxOut, audioCodecCtx_->sample_fmt, 0);
         if (ret < 0) {
-            LOG_WARN("Audio resample error: {}", ffmpegError(ret));
+            LOG_WARN("Audio buffer allocation failed: {}", ffmpegError(ret));
             continue;
         }
         
+        const u8* srcData[1] = { reinterpret_cast<const u8*>(chunk.samples.data()) };
+        int outFrames = swr_convert(swrCtx_, converted, maxOut, srcData, inFrames);
+        
+        if (outFrames < 0) {
+            LOG_WARN("Audio resample error: {}", ffmpegError(outFrames));
+        } else if (outFrames > 0) {
+            av_audio_fifo_write(audioFifo_, reinterpret_cast<void**>(converted), outFrames);
+        }
+        
+        av_freep(&converted[0]);
+        av_freep(&converted);
+        
+        encodeQueuedAudio();
+    }
+}
+
+void VideoRecorder::writeAudioSilence(i64 durationUs) {
+    i64 remaining = av_rescale(durationUs, audioCodecCtx_->sample_rate, 1000000);
+    int frameSize = audioFrame_->nb_samples;
+    
+    // In frame-sized pieces so a long pause doesn't balloon the FIFO
+    while (remaining > 0) {
+        if (av_frame_make_writable(audioFrame_) < 0) return;
+        
+        int count = static_cast<int>(std::min<i64>(remaining, frameSize));
+        av_samples_set_silence(audioFrame_->data, 0, count,
+                               audioCodecCtx_->ch_layout.nb_channels, audioCodecCtx_->sample_fmt);
+        av_audio_fifo_write(audioFifo_, reinterpret_cast<void**>(audioFrame_->data), count);
+        remaining -= count;
+        
+        encodeQueuedAudio();
+    }
+    
+    stats_.audioSilenceMs += static_cast<u64>(durationUs / 1000);
+}
+
+void VideoRecorder::encodeQueuedAudio() {
+    int frameSize = audioFrame_->nb_samples;
+    
+    while (av_audio_fifo_size(audioFifo_) >= frameSize) {
+        if (av_frame_make_writable(audioFrame_) < 0) return;
+        
+        av_audio_fifo_read(audioFifo_, reinterpret_cast<void**>(audioFrame_->data), frameSize);
+        
+        // Audio PTS is the master clock: one tick per sample, no gaps
         audioFrame_->pts = audioFrameCount_;
         audioFrameCount_ += frameSize;
         
@@ -250,9 +571,12 @@ void VideoRecorder::processAudioBuffer() {
 Result<void> VideoRecorder::initFFmpeg() {
     int ret;
     
-    // Allocate format context
-    ret = avformat_alloc_output_context2(&formatCtx_, nullptr, nullptr, 
-                                          settings_.outputPath.c_str());
+    // Allocate format context (streams have no filename to guess from)
+    std::string formatName = settings_.containerFormatName();
+    const char* filename = settings_.stream.isStream() ? nullptr : settings_.outputPath.c_str();
+    ret = avformat_alloc_output_context2(&formatCtx_, nullptr, 
+                                          formatName.empty() ? nullptr : formatName.c_str(),
+                                          filename);
     if (ret < 0 || !formatCtx_) {
         return Result<void>::err("Failed to create output context: " + ffmpegError(ret));
     }
@@ -267,8 +591,20 @@ Result<void> VideoRecorder::initFFmpeg() {
         return result;
     }
     
-    // Open output file
-    if (!(formatCtx_->oformat->flags & AVFMT_NOFILE)) {
+    // Open output file or stream
+    AVDictionary* opts = nullptr;
+    
+    if (settings_.stream.isStream()) {
+        if (auto result = initStreamOutput(); !result) {
+            return result;
+        }
+        
+        // Hand every packet to the sink as soon as it's muxed
+        av_dict_set(&opts, "flush_packets", "1", 0);
+        if (settings_.container == Container::FLV) {
+            av_dict_set(&opts, "flvflags", "no_duration_filesize", 0);
+        }
+    } else if (!(formatCtx_->oformat->flags & AVFMT_NOFILE)) {
         ret = avio_open(&formatCtx_->pb, settings_.outputPath.c_str(), AVIO_FLAG_WRITE);
         if (ret < 0) {
             return Result<void>::err("Failed to open output file: " + ffmpegError(ret));
@@ -276,7 +612,6 @@ Result<void> VideoRecorder::initFFmpeg() {
     }
     
     // Write header
-    AVDictionary* opts = nullptr;
     ret = avformat_write_header(formatCtx_, &opts);
     av_dict_free(&opts);
     
@@ -294,19 +629,94 @@ Result<void> VideoRecorder::initFFmpeg() {
     return Result<void>::ok();
 }
 
-Result<void> VideoRecorder::initVideoStream() {
-    // Find encoder
-    const AVCodec* codec = avcodec_find_encoder_by_name(settings_.video.codecName().c_str());
-    if (!codec) {
-        return Result<void>::err("Video codec not found: " + settings_.video.codecName());
+Result<void> VideoRecorder::initStreamOutput() {
+    if (auto result = streamSink_.open(settings_.stream); !result) {
+        return result;
+    }
+    
+    auto* buffer = static_cast<u8*>(av_malloc(STREAM_AVIO_BUFFER_SIZE));
+    if (!buffer) {
+        return Result<void>::err("Failed to allocate stream buffer");
+    }
+    
+    avioCtx_ = avio_alloc_context(buffer, STREAM_AVIO_BUFFER_SIZE, 1, 
+                                  &streamSink_, nullptr, &streamWritePacket, nullptr);
+    if (!avioCtx_) {
+        av_free(buffer);
+        return Result<void>::err("Failed to allocate stream IO context");
     }
     
+    formatCtx_->pb = avioCtx_;
+    formatCtx_->flags |= AVFMT_FLAG_CUSTOM_IO | AVFMT_FLAG_FLUSH_PACKETS;
+    
+    // Don't hold packets back for interleaving or mux delay
+    formatCtx_->max_delay = 100000;              // 100 ms
+    formatCtx_->max_interleave_delta = 100000;
+    
+    return Result<void>::ok();
+}
+
+Result<void> VideoRecorder::initVideoStream() {
     // Create stream
     videoStream_ = avformat_new_stream(formatCtx_, nullptr);
     if (!videoStream_) {
         return Result<void>::err("Failed to create video stream");
     }
     
+    if (auto result = openVideoEncoder(activePreset_); !result) {
+        return result;
+    }
+    
+    // Copy codec params to stream
+    int ret = avcodec_parameters_from_context(videoStream_->codecpar, videoCodecCtx_);
+    if (ret < 0) {
+        return Result<void>::err("Failed to copy video codec params");
+    }
+    
+    videoStream_->time_base = videoCodecCtx_->time_base;
+    
+    // Allocate video frame
+    videoFrame_ = av_frame_alloc();
+    if (!videoFrame_) {
+        return Result<void>::err("Failed to allocate video frame");
+    }
+    
+    videoFrame_->format = videoCodecCtx_->pix_fmt;
+    videoFrame_->width = videoCodecCtx_->width;
+    videoFrame_->height = videoCodecCtx_->height;
+    
+    ret = av_frame_get_buffer(videoFrame_, 0);
+    if (ret < 0) {
+        return Result<void>::err("Failed to allocate video frame buffer");
+    }
+    
+    // Create swscale context for RGBA -> encoder format conversion
+    swsCtx_ = sws_getContext(
+        settings_.video.width, settings_.video.height, AV_PIX_FMT_RGBA,
+        settings_.video.width, settings_.video.height, videoCodecCtx_->pix_fmt,
+        SWS_BILINEAR, nullptr, nullptr, nullptr);
+    
+    if (!swsCtx_) {
+        return Result<void>::err("Failed to create swscale context");
+    }
+    
+    LOG_DEBUG("Video stream initialized: {}x{} @ {} fps, codec: {}",
+              settings_.video.width, settings_.video.height,
+              settings_.video.fps, settings_.video.codecName());
+    
+    return Result<void>::ok();
+}
+
+Result<void> VideoRecorder::openVideoEncoder(EncoderPreset preset, bool replacement) {
+    // Find encoder
+    const AVCodec* codec = avcodec_find_encoder_by_name(settings_.video.codecName().c_str());
+    if (!codec) {
+        return Result<void>::err("Video codec not found: " + settings_.video.codecName());
+    }
+    
+    VideoSettings video = settings_.video;
+    video.preset = preset;
+    
     // Allocate codec context
     videoCodecCtx_ = avcodec_alloc_context3(codec);
     if (!videoCodecCtx_) {
@@ -318,10 +728,13 @@ Result<void> VideoRecorder::initVideoStream() {
     videoCodecCtx_->height = settings_.video.height;
     videoCodecCtx_->time_base = AVRational{1, static_cast<int>(settings_.video.fps)};
     videoCodecCtx_->framerate = AVRational{static_cast<int>(settings_.video.fps), 1};
-    videoCodecCtx_->pix_fmt = AV_PIX_FMT_YUV420P;
+    videoCodecCtx_->pix_fmt = pickPixelFormat(codec, settings_.video.pixelFormat);
     videoCodecCtx_->gop_size = settings_.video.gopSize > 0 ? 
                                settings_.video.gopSize : settings_.video.fps * 2;
-    videoCodecCtx_->max_b_frames = settings_.video.bFrames;
+    // A replacement encoder must not reorder, or its first DTS would
+    // land before the last packet of the one it replaced. That holds when
+    // it goes back to the configured preset too.
+    videoCodecCtx_->max_b_frames = replacement ? 0 : settings_.video.bFrames;
     
     if (formatCtx_->oformat->flags & AVFMT_GLOBALHEADER) {
         videoCodecCtx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
@@ -332,7 +745,7 @@ Result<void> VideoRecorder::initVideoStream() {
     
     if (settings_.video.codec == VideoCodec::H264 || 
         settings_.video.codec == VideoCodec::H265) {
-        av_dict_set(&opts, "preset", settings_.video.presetName().c_str(), 0);
+        av_dict_set(&opts, "preset", video.presetName().c_str(), 0);
         av_dict_set(&opts, "crf", std::to_string(settings_.video.crf).c_str(), 0);
         
         // For better streaming/seeking
@@ -347,43 +760,37 @@ Result<void> VideoRecorder::initVideoStream() {
         return Result<void>::err("Failed to open video codec: " + ffmpegError(ret));
     }
     
-    // Copy codec params to stream
-    ret = avcodec_parameters_from_context(videoStream_->codecpar, videoCodecCtx_);
-    if (ret < 0) {
-        return Result<void>::err("Failed to copy video codec params");
+    LOG_DEBUG("Video encoder opened: {} preset {}", video.codecName(), video.presetName());
+    return Result<void>::ok();
+}
+
+Result<void> VideoRecorder::initResampler(u32 sampleRate, u32 channels) {
+    if (swrCtx_) {
+        swr_free(&swrCtx_);
     }
     
-    videoStream_->time_base = videoCodecCtx_->time_base;
-    
-    // Allocate video frame
-    videoFrame_ = av_frame_alloc();
-    if (!videoFrame_) {
-        return Result<void>::err("Failed to allocate video frame");
-    }
+    AVChannelLayout inLayout;
+    av_channel_layout_default(&inLayout, channels);
     
-    videoFrame_->format = videoCodecCtx_->pix_fmt;
-    videoFrame_->width = videoCodecCtx_->width;
-    videoFrame_->height = videoCodecCtx_->height;
+    int ret = swr_alloc_set_opts2(&swrCtx_,
+        &audioCodecCtx_->ch_layout, audioCodecCtx_->sample_fmt, audioCodecCtx_->sample_rate,
+        &inLayout, AV_SAMPLE_FMT_FLT, sampleRate,
+        0, nullptr);
+    av_channel_layout_uninit(&inLayout);
     
-    ret = av_frame_get_buffer(videoFrame_, 0);
-    if (ret < 0) {
-        return Result<void>::err("Failed to allocate video frame buffer");
+    if (ret < 0 || !swrCtx_) {
+        return Result<void>::err("Failed to create swresample context");
     }
     
-    // Create swscale context for RGBA -> YUV conversion
-    swsCtx_ = sws_getContext(
-        settings_.video.width, settings_.video.height, AV_PIX_FMT_RGBA,
-        settings_.video.width, settings_.video.height, AV_PIX_FMT_YUV420P,
-        SWS_BILINEAR, nullptr, nullptr, nullptr);
-    
-    if (!swsCtx_) {
-        return Result<void>::err("Failed to create swscale context");
+    ret = swr_init(swrCtx_);
+    if (ret < 0) {
+        return Result<void>::err("Failed to init swresample: " + ffmpegError(ret));
     }
     
-    LOG_DEBUG("Video stream initialized: {}x{} @ {} fps, codec: {}",
-              settings_.video.width, settings_.video.height,
-              settings_.video.fps, settings_.video.codecName());
+    swrInputRate_ = sampleRate;
+    swrInputChannels_ = channels;
     
+    LOG_DEBUG("Audio resampler: {} Hz {} ch -> {} Hz", sampleRate, channels, audioCodecCtx_->sample_rate);
     return Result<void>::ok();
 }
 
@@ -445,28 +852,25 @@ Result<void> VideoRecorder::initAudioStream() {
     audioFrame_->format = audioCodecCtx_->sample_fmt;
     av_channel_layout_copy(&audioFrame_->ch_layout, &audioCodecCtx_->ch_layout);
     audioFrame_->sample_rate = audioCodecCtx_->sample_rate;
-    audioFrame_->nb_samples = audioCodecCtx_->frame_size;
     
-    if (audioFrame_->nb_samples > 0) {
-        ret = av_frame_get_buffer(audioFrame_, 0);
-        if (ret < 0) {
-            return Result<void>::err("Failed to allocate audio frame buffer");
-        }
-    }
+    // PCM-style encoders take any frame size; give them a sensible one
+    audioFrame_->nb_samples = audioCodecCtx_->frame_size > 0 ? audioCodecCtx_->frame_size : 1024;
     
-    // Create swresample context
-    ret = swr_alloc_set_opts2(&swrCtx_,
-        &audioCodecCtx_->ch_layout, audioCodecCtx_->sample_fmt, audioCodecCtx_->sample_rate,
-        &layout, AV_SAMPLE_FMT_FLT, settings_.audio.sampleRate,
-        0, nullptr);
+    ret = av_frame_get_buffer(audioFrame_, 0);
+    if (ret < 0) {
+        return Result<void>::err("Failed to allocate audio frame buffer");
+    }
     
-    if (ret < 0 || !swrCtx_) {
-        return Result<void>::err("Failed to create swresample context");
+    // Resampled audio collects here until there's a full encoder frame
+    audioFifo_ = av_audio_fifo_alloc(audioCodecCtx_->sample_fmt, audioCodecCtx_->ch_layout.nb_channels,
+                                     audioFrame_->nb_samples * 4);
+    if (!audioFifo_) {
+        return Result<void>::err("Failed to allocate audio FIFO");
     }
     
-    ret = swr_init(swrCtx_);
-    if (ret < 0) {
-        return Result<void>::err("Failed to init swresample: " + ffmpegError(ret));
+    // Create swresample context (rebuilt if the source format differs)
+    if (auto result = initResampler(settings_.audio.sampleRate, settings_.audio.channels); !result) {
+        return result;
     }
     
     LOG_DEBUG("Audio stream initialized: {} Hz, {} ch, codec: {}",
@@ -503,6 +907,13 @@ void VideoRecorder::cleanupFFmpeg() {
         swr_free(&swrCtx_);
         swrCtx_ = nullptr;
     }
+    swrInputRate_ = 0;
+    swrInputChannels_ = 0;
+    
+    if (audioFifo_) {
+        av_audio_fifo_free(audioFifo_);
+        audioFifo_ = nullptr;
+    }
     
     if (videoCodecCtx_) {
         avcodec_free_context(&videoCodecCtx_);
@@ -515,13 +926,23 @@ void VideoRecorder::cleanupFFmpeg() {
     }
     
     if (formatCtx_) {
-        if (formatCtx_->pb && !(formatCtx_->oformat->flags & AVFMT_NOFILE)) {
+        if (formatCtx_->pb && !(formatCtx_->flags & AVFMT_FLAG_CUSTOM_IO) &&
+            !(formatCtx_->oformat->flags & AVFMT_NOFILE)) {
             avio_closep(&formatCtx_->pb);
         }
         avformat_free_context(formatCtx_);
         formatCtx_ = nullptr;
     }
     
+    if (avioCtx_) {
+        av_freep(&avioCtx_->buffer);
+        avio_context_free(&avioCtx_);
+        avioCtx_ = nullptr;
+    }
+    
+    // Drains whatever the trailer left in the queue
+    streamSink_.close();
+    
     videoStream_ = nullptr;
     audioStream_ = nullptr;
     videoFrameCount_ = 0;
@@ -529,6 +950,15 @@ void VideoRecorder::cleanupFFmpeg() {
 }
 
 bool VideoRecorder::encodeVideoFrame(AVFrame* frame) {
+    // Encode time excludes muxing, which writePacket accounts separately
+    auto encodeStart = std::chrono::steady_clock::now();
+    f64 muxBefore = stats_.muxMs;
+    bool ok = sendVideoFrame(frame);
+    stats_.encodeMs += msSince(encodeStart) - (stats_.muxMs - muxBefore);
+    return ok;
+}
+
+bool VideoRecorder::sendVideoFrame(AVFrame* frame) {
     int ret = avcodec_send_frame(videoCodecCtx_, frame);
     if (ret < 0) {
         LOG_WARN("Error sending video frame: {}", ffmpegError(ret));
@@ -586,7 +1016,9 @@ bool VideoRecorder::writePacket(AVPacket* packet, AVStream* stream) {
     
     packet->stream_index = stream->index;
     
+    auto muxStart = std::chrono::steady_clock::now();
     int ret = av_interleaved_write_frame(formatCtx_, packet);
+    stats_.muxMs += msSince(muxStart);
     if (ret < 0) {
         LOG_WARN("Error writing packet: {}", ffmpegError(ret));
         return false;
@@ -607,6 +1039,18 @@ void VideoRecorder::flushEncoders() {
         }
     }
     
+    // Pad out whatever is left in the FIFO to one last full frame
+    if (audioCodecCtx_ && audioFifo_ && av_audio_fifo_size(audioFifo_) > 0 &&
+        av_frame_make_writable(audioFrame_) >= 0) {
+        int frameSize = audioFrame_->nb_samples;
+        av_samples_set_silence(audioFrame_->data, 0, frameSize,
+                               audioCodecCtx_->ch_layout.nb_channels, audioCodecCtx_->sample_fmt);
+        av_audio_fifo_read(audioFifo_, reinterpret_cast<void**>(audioFrame_->data), frameSize);
+        audioFrame_->pts = audioFrameCount_;
+        audioFrameCount_ += frameSize;
+        encodeAudioFrame(audioFrame_);
+    }
+    
     // Flush audio encoder
     if (audioCodecCtx_) {
         avcodec_send_frame(audioCodecCtx_, nullptr);
@@ -7,11 +7,16 @@
 #include "util/Signal.hpp"
 #include "EncoderSettings.hpp"
 #include "FrameGrabber.hpp"
+#include "StreamSink.hpp"
+#include "RecordingGovernor.hpp"
+#include "RecordingClock.hpp"
+#include "PreviewSheet.hpp"
 
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
 
 // Forward declarations for FFmpeg
 struct AVFormatContext;
@@ -19,6 +24,8 @@ struct AVCodecContext;
 struct AVStream;
 struct AVFrame;
 struct AVPacket;
+struct AVIOContext;
+struct AVAudioFifo;
 struct SwsContext;
 struct SwrContext;
 
@@ -40,6 +47,31 @@ struct RecordingStats {
     f64 avgFps{0.0};
     f64 encodingFps{0.0};
     std::string currentFile;
+    
+    // Stream output only
+    u64 streamFramesDropped{0};   // Skipped because the reader lagged
+    u64 streamBytesQueued{0};
+    
+    // Adaptive quality (see RecordingGovernor)
+    std::string encoderPreset;
+    f32 renderScale{1.0f};
+    u32 frameStride{1};
+    std::vector<RecordingAdaptation> adaptations;
+    
+    // A/V sync against the audio clock
+    f64 avDriftMs{0.0};             // Last video frame vs audio clock
+    f64 maxAvDriftMs{0.0};
+    f64 audioClockOffsetMs{0.0};    // Audio timeline vs wall clock
+    u64 framesDuplicated{0};
+    u64 framesSkipped{0};
+    u64 audioSilenceMs{0};          // Padding for audio stalls
+    
+    // Cumulative wall time per pipeline stage on the encoding thread
+    f64 convertMs{0.0};
+    f64 encodeMs{0.0};
+    f64 muxMs{0.0};
+    
+    u64 previewThumbnails{0};
 };
 
 class VideoRecorder {
@@ -55,14 +87,18 @@ public:
     Result<void> stop();
     
     // Submit frames
+    void captureFrame(RenderTarget& target, i64 timestamp);  // GL thread, context current
     void submitVideoFrame(const u8* data, u32 width, u32 height, i64 timestamp);
-    void submitAudioSamples(const f32* data, u32 samples, u32 channels, u32 sampleRate);
+    void submitAudioSamples(const f32* data, u32 samples, u32 channels, u32 sampleRate, i64 timestamp);
     
     // State
     RecordingState state() const { return state_; }
     bool isRecording() const { return state_ == RecordingState::Recording; }
     const RecordingStats& stats() const { return stats_; }
     
+    // Internal render scale the visualizer should use right now
+    f32 renderScale() const { return renderScale_; }
+    
     // Settings
     const EncoderSettings& settings() const { return settings_; }
     
@@ -76,16 +112,25 @@ private:
     void encodingThread();
     void processVideoFrame(const GrabbedFrame& frame);
     void processAudioBuffer();
+    void writeAudioSilence(i64 durationUs);
+    void encodeQueuedAudio();
     void flushEncoders();
+    void updateGovernor(Duration elapsed);
+    bool switchVideoPreset(EncoderPreset preset);
     
     // FFmpeg setup
     Result<void> initFFmpeg();
     Result<void> initVideoStream();
+    // replacement: opened mid-recording by the governor, so no B-frames
+    Result<void> openVideoEncoder(EncoderPreset preset, bool replacement = false);
     Result<void> initAudioStream();
+    Result<void> initResampler(u32 sampleRate, u32 channels);
+    Result<void> initStreamOutput();
     void cleanupFFmpeg();
     
     // Encoding
     bool encodeVideoFrame(AVFrame* frame);
+    bool sendVideoFrame(AVFrame* frame);
     bool encodeAudioFrame(AVFrame* frame);
     bool writePacket(AVPacket* packet, AVStream* stream);
     
@@ -99,11 +144,16 @@ private:
     std::atomic<bool> shouldStop_{false};
     FrameGrabber frameGrabber_;
     
-    // Audio buffer
-    std::vector<f32> audioBuffer_;
+    // Audio buffer, each chunk keeps its own format
+    struct AudioChunk {
+        std::vector<f32> samples;   // Interleaved
+        u32 channels{2};
+        u32 sampleRate{48000};
+        i64 silenceUs{0};           // Padding to insert before the samples
+    };
+    std::deque<AudioChunk> audioChunks_;
     std::mutex audioMutex_;
-    u32 audioSampleRate_{48000};
-    u32 audioChannels_{2};
+    RecordingClock clock_;
     
     // FFmpeg contexts
     AVFormatContext* formatCtx_{nullptr};
@@ -113,11 +163,30 @@ private:
     AVStream* audioStream_{nullptr};
     SwsContext* swsCtx_{nullptr};
     SwrContext* swrCtx_{nullptr};
+    AVAudioFifo* audioFifo_{nullptr};
+    u32 swrInputRate_{0};
+    u32 swrInputChannels_{0};
     
     AVFrame* videoFrame_{nullptr};
     AVFrame* audioFrame_{nullptr};
     AVPacket* packet_{nullptr};
     
+    // Stream output (custom AVIO instead of a file)
+    StreamSink streamSink_;
+    AVIOContext* avioCtx_{nullptr};
+    bool streamErrorReported_{false};
+    
+    // Adaptive quality
+    RecordingGovernor governor_;
+    EncoderPreset activePreset_{EncoderPreset::Medium};
+    std::atomic<f32> renderScale_{1.0f};
+    std::atomic<u32> frameStride_{1};
+    u32 captureCount_{0};
+    u32 lastDroppedFrames_{0};
+    
+    // Seek-bar thumbnails, fed from the converted frames
+    PreviewSheet previewSheet_;
+    
     i64 videoFrameCount_{0};
     i64 audioFrameCount_{0};
     i64 startTime_{0};
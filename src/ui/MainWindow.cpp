@@ -8,9 +8,12 @@
 #include "RecordingControls.hpp"
 #include "OverlayEditor.hpp"
 #include "SettingsDialog.hpp"
+#include "PresetGridDialog.hpp"
 #include "core/Config.hpp"
 #include "core/Logger.hpp"
 #include "util/FileUtils.hpp"
+#include "util/FileWatcher.hpp"
+#include "util/ParallelScan.hpp"
 
 #include <QMenuBar>
 #include <QStatusBar>
@@ -25,6 +28,7 @@
 #include <QDropEvent>
 #include <QCloseEvent>
 #include <QKeyEvent>
+#include <chrono>
 
 namespace vc {
 
@@ -41,6 +45,7 @@ MainWindow::MainWindow(QWidget* parent)
     if (auto result = audioEngine_->init(); !result) {
         LOG_ERROR("Failed to init audio engine: {}", result.error().message);
     }
+    audioEngine_->albumArt().setBudget(static_cast<usize>(CONFIG.audio().albumArtCacheMB) << 20);
     
     overlayEngine_ = std::make_unique<OverlayEngine>();
     overlayEngine_->init();
@@ -51,6 +56,7 @@ MainWindow::MainWindow(QWidget* parent)
     setupMenuBar();
     setupConnections();
     setupUpdateTimer();
+    setupWatchers();
     
     // Status bar
     statusBar()->showMessage("Ready. Drag and drop some music files to get started.");
@@ -61,6 +67,13 @@ MainWindow::MainWindow(QWidget* parent)
 MainWindow::~MainWindow() {
     updateTimer_.stop();
     
+    // Their threads post to this window; stop them before it goes away
+    if (presetWatcher_) presetWatcher_->stop();
+    if (libraryWatcher_) libraryWatcher_->stop();
+    
+    // The grid borrows the visualizer's preset list, so it goes first
+    delete presetGrid_;
+    
     if (videoRecorder_->isRecording()) {
         videoRecorder_->stop();
     }
@@ -101,6 +114,7 @@ void MainWindow::setupUI() {
     
     presetBrowser_ = new PresetBrowser();
     presetBrowser_->setPresetManager(&presetMgr);
+    presetBrowser_->setThumbnailer(&visualizerPanel_->visualizer()->thumbnailer());
     rightTabs->addTab(presetBrowser_, "Presets");
     
     recordingControls_ = new RecordingControls();
@@ -193,6 +207,10 @@ void MainWindow::setupMenuBar() {
         visualizerPanel_->visualizer()->projectM().lockPreset(locked);
     });
     
+    vizMenu->addSeparator();
+    vizMenu->addAction("Preset &Grid...", this, &MainWindow::onShowPresetGrid,
+        QKeySequence(Qt::CTRL | Qt::Key_G));
+    
     // Recording menu
     auto* recordMenu = menuBar()->addMenu("&Recording");
     
@@ -255,13 +273,30 @@ void MainWindow::setupConnections() {
         overlayEngine_->config().saveToAppConfig();
     });
     
-    // Visualizer frame ready -> feed to recorder
+    // Decoded audio -> recorder (same thread as playback, so arrival time
+    // is a good anchor for the recorder's audio clock)
+    audioEngine_->pcmReceived.connect([this](const std::vector<f32>& samples, u32 channels, u32 sampleRate) {
+        if (!videoRecorder_->isRecording() || channels == 0) return;
+        
+        i64 timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        videoRecorder_->submitAudioSamples(samples.data(), samples.size() / channels,
+                                           channels, sampleRate, timestamp);
+    });
+    
+    // Visualizer frame ready -> feed to recorder. Emitted on the render
+    // thread with its GL context current, so the readback must run there.
     connect(visualizerPanel_->visualizer(), &VisualizerWidget::frameReady, this, [this] {
         if (videoRecorder_->isRecording()) {
-            auto& target = visualizerPanel_->visualizer()->renderTarget();
-            // Frame is captured in the visualizer's render loop
+            auto* viz = visualizerPanel_->visualizer();
+            i64 timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            videoRecorder_->captureFrame(viz->outputTarget(), timestamp);
+            
+            // Governor may trade render resolution for encoder headroom
+            viz->setRenderScale(videoRecorder_->renderScale());
         }
-    });
+    }, Qt::DirectConnection);
 }
 
 void MainWindow::setupUpdateTimer() {
@@ -269,6 +304,59 @@ void MainWindow::setupUpdateTimer() {
     updateTimer_.start(16);  // ~60 fps
 }
 
+void MainWindow::setupWatchers() {
+    auto& presetMgr = visualizerPanel_->visualizer()->projectM().presets();
+
+    if (CONFIG.visualizer().watchPresets) {
+        presetWatcher_ = std::make_unique<FileWatcher>(
+            FileWatcher::Options{file::presetExtensions, true});
+        if (auto result = presetWatcher_->start(); !result) {
+            LOG_WARN("Preset folder won't be watched: {}", result.error().message);
+            presetWatcher_.reset();
+        } else {
+            presetWatcher_->changed.connect([this](const FileChanges& changes) {
+                QMetaObject::invokeMethod(this, [this, changes] {
+                    visualizerPanel_->visualizer()->projectM().presets().applyChanges(changes);
+                });
+            });
+
+            // The bridge scans on the render thread once GL is up, and a
+            // settings change may point it elsewhere: follow its directory
+            presetMgr.listChanged.connect([this] {
+                QMetaObject::invokeMethod(this, &MainWindow::watchPresetDirectory);
+            });
+            watchPresetDirectory();
+        }
+    }
+
+    if (CONFIG.audio().watchFolders) {
+        libraryWatcher_ = std::make_unique<FileWatcher>(
+            FileWatcher::Options{file::audioExtensions, true});
+        if (auto result = libraryWatcher_->start(); !result) {
+            LOG_WARN("Music folders won't be watched: {}", result.error().message);
+            libraryWatcher_.reset();
+        } else {
+            libraryWatcher_->changed.connect([this](const FileChanges& changes) {
+                if (changes.overflow) return;  // The playlist isn't a tree we can rescan
+                QMetaObject::invokeMethod(this, [this, changes] {
+                    audioEngine_->playlist().applyChanges(changes);
+                });
+            });
+        }
+    }
+}
+
+void MainWindow::watchPresetDirectory() {
+    if (!presetWatcher_) return;
+
+    const auto& dir = visualizerPanel_->visualizer()->projectM().presets().directory();
+    if (dir.empty() || presetWatcher_->isWatching(dir)) return;
+
+    if (auto result = presetWatcher_->watch(dir); !result) {
+        LOG_WARN("Not watching presets: {}", result.error().message);
+    }
+}
+
 void MainWindow::onUpdateLoop() {
     // Feed audio data to visualizer
     feedAudioToVisualizer();
@@ -295,6 +383,10 @@ void MainWindow::feedAudioToVisualizer() {
         pcm.size() / 2,  // Frames (stereo)
         2                 // Channels
     );
+    
+    if (presetGrid_) {
+        presetGrid_->feedAudio(pcm.data(), pcm.size() / 2, 2);
+    }
 }
 
 void MainWindow::updateWindowTitle() {
@@ -314,10 +406,20 @@ void MainWindow::updateWindowTitle() {
 
 void MainWindow::addToPlaylist(const fs::path& path) {
     if (fs::is_directory(path)) {
-        auto files = file::listFiles(path, file::audioExtensions, true);
-        for (const auto& f : files) {
-            audioEngine_->playlist().addFile(f);
+        // The watcher walks the folder anyway, off this thread: take the
+        // files from that walk (sorted by path, so albums land in track order)
+        if (libraryWatcher_) {
+            auto result = libraryWatcher_->watch(path, [this](std::vector<fs::path> files) {
+                QMetaObject::invokeMethod(this, [this, files = std::move(files)] {
+                    audioEngine_->playlist().addFiles(files);
+                });
+            });
+            if (result) return;
+            LOG_WARN("Not watching {}: {}", path.string(), result.error().message);
         }
+        
+        audioEngine_->playlist().addFiles(
+            DirectoryScanner::files(path, file::audioExtensions, true));
     } else {
         audioEngine_->playlist().addFile(path);
     }
@@ -360,7 +462,8 @@ void MainWindow::startRecording(const fs::path& outputPath) {
         visualizerPanel_->visualizer()->stopRecording();
     } else {
         updateWindowTitle();
-        statusBar()->showMessage("Recording started: " + QString::fromStdString(path.string()));
+        statusBar()->showMessage("Recording started: " + 
+            QString::fromStdString(videoRecorder_->stats().currentFile));
     }
 }
 
@@ -488,6 +591,22 @@ void MainWindow::onShowSettings() {
     dialog.exec();
 }
 
+void MainWindow::onShowPresetGrid() {
+    if (presetGrid_) {
+        presetGrid_->raise();
+        presetGrid_->activateWindow();
+        return;
+    }
+    
+    auto* viz = visualizerPanel_->visualizer();
+    presetGrid_ = new PresetGridDialog(viz->projectM().presets(), viz->format(), this);
+    presetGrid_->setAttribute(Qt::WA_DeleteOnClose);
+    connect(presetGrid_, &PresetGridDialog::presetSelected, this, [viz](const QString& path) {
+        viz->projectM().presets().selectByPath(path.toStdString());
+    });
+    presetGrid_->show();
+}
+
 void MainWindow::onShowAbout() {
     QMessageBox::about(this, "About VibeChad",
         "<h2>VibeChad Audio Player</h2>"
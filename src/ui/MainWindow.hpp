@@ -8,6 +8,7 @@
 #include "recorder/VideoRecorder.hpp"
 
 #include <QMainWindow>
+#include <QPointer>
 #include <QTimer>
 #include <functional>
 
@@ -19,6 +20,8 @@ class VisualizerPanel;
 class PresetBrowser;
 class RecordingControls;
 class OverlayEditor;
+class FileWatcher;
+class PresetGridDialog;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -62,6 +65,7 @@ private slots:
     void onSavePlaylist();
     void onLoadPlaylist();
     void onShowSettings();
+    void onShowPresetGrid();
     void onShowAbout();
     
     void onUpdateLoop();
@@ -71,6 +75,8 @@ private:
     void setupMenuBar();
     void setupConnections();
     void setupUpdateTimer();
+    void setupWatchers();
+    void watchPresetDirectory();
     
     void updateWindowTitle();
     void feedAudioToVisualizer();
@@ -80,6 +86,8 @@ private:
     std::unique_ptr<AudioEngine> audioEngine_;
     std::unique_ptr<OverlayEngine> overlayEngine_;
     std::unique_ptr<VideoRecorder> videoRecorder_;
+    std::unique_ptr<FileWatcher> presetWatcher_;
+    std::unique_ptr<FileWatcher> libraryWatcher_;   // Folders added to the playlist
     
     // UI Widgets
     PlayerControls* playerControls_{nullptr};
@@ -88,6 +96,7 @@ private:
     PresetBrowser* presetBrowser_{nullptr};
     RecordingControls* recordingControls_{nullptr};
     OverlayEditor* overlayEditor_{nullptr};
+    QPointer<PresetGridDialog> presetGrid_;     // Open while shown, deletes itself on close
     
     // Dock widgets for flexible layout
     QDockWidget* playlistDock_{nullptr};
@@ -212,8 +212,11 @@ void OverlayEditor::onElementSelected(int row) {
 void OverlayEditor::onAddElement() {
     if (!overlayEngine_) return;
     
-    auto* elem = overlayEngine_->config().addElement();
-    elem->setText("New Text");
+    {
+        auto guard = overlayEngine_->lock();
+        auto* elem = overlayEngine_->config().addElement();
+        elem->setText("New Text");
+    }
     
     updateElementList();
     elementList_->setCurrentRow(elementList_->count() - 1);
@@ -224,7 +227,10 @@ void OverlayEditor::onAddElement() {
 void OverlayEditor::onRemoveElement() {
     if (!overlayEngine_ || !currentElement_) return;
     
-    overlayEngine_->config().removeElement(currentElement_->id());
+    {
+        auto guard = overlayEngine_->lock();
+        overlayEngine_->config().removeElement(currentElement_->id());
+    }
     currentElement_ = nullptr;
     
     updateElementList();
@@ -233,6 +239,7 @@ void OverlayEditor::onRemoveElement() {
 
 void OverlayEditor::onTextChanged() {
     if (updating_ || !currentElement_) return;
+    auto guard = overlayEngine_->lock();
     currentElement_->setText(textEdit_->text());
     emit overlayChanged();
 }
@@ -240,6 +247,7 @@ void OverlayEditor::onTextChanged() {
 void OverlayEditor::onPositionChanged() {
     if (updating_ || !currentElement_) return;
     
+    auto guard = overlayEngine_->lock();
     currentElement_->setPosition(
         static_cast<f32>(posXSpin_->value()),
         static_cast<f32>(posYSpin_->value())
@@ -258,6 +266,7 @@ void OverlayEditor::onPositionChanged() {
 void OverlayEditor::onStyleChanged() {
     if (updating_ || !currentElement_) return;
     
+    auto guard = overlayEngine_->lock();
     auto& style = currentElement_->style();
     style.fontFamily = fontCombo_->currentText();
     style.fontSize = static_cast<u32>(fontSizeSpin_->value());
@@ -279,6 +288,7 @@ void OverlayEditor::onAnimationChanged() {
         AnimationType::Shake, AnimationType::Scale, AnimationType::Rainbow
     };
     
+    auto guard = overlayEngine_->lock();
     auto& anim = currentElement_->animation();
     anim.type = types[animationCombo_->currentIndex()];
     anim.speed = static_cast<f32>(animSpeedSpin_->value());
@@ -299,6 +309,7 @@ void OverlayEditor::onColorButtonClicked() {
 
 void OverlayEditor::onVisibilityChanged(bool visible) {
     if (updating_ || !currentElement_) return;
+    auto guard = overlayEngine_->lock();
     currentElement_->setVisible(visible);
     emit overlayChanged();
 }
@@ -35,9 +35,14 @@ void PlayerControls::setAudioEngine(AudioEngine* engine) {
                     if (const auto* item = audioEngine_->playlist().currentItem()) {
                         updateTrackInfo(item->metadata);
                     }
+                    updateAlbumArt();
                 }
             });
         });
+        
+        engine->albumArt().ready.connect([this](const fs::path&) {
+            QMetaObject::invokeMethod(this, &PlayerControls::updateAlbumArt);
+        });
     }
 }
 
@@ -198,9 +203,13 @@ void PlayerControls::updateDuration(Duration duration) {
 void PlayerControls::updateTrackInfo(const MediaMetadata& meta) {
     titleLabel_->setText(QString::fromStdString(meta.displayTitle()));
     artistLabel_->setText(QString::fromStdString(meta.displayArtist()));
+}
+
+void PlayerControls::updateAlbumArt() {
+    const auto* item = audioEngine_ ? audioEngine_->playlist().currentItem() : nullptr;
     
-    if (meta.albumArt) {
-        albumArtLabel_->setPixmap(meta.albumArt->scaled(64, 64, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    if (auto art = item ? audioEngine_->albumArt().find(item->path, 64) : std::nullopt) {
+        albumArtLabel_->setPixmap(QPixmap::fromImage(*art));
     } else {
         albumArtLabel_->setText("♪");
     }
@@ -49,6 +49,7 @@ private slots:
 private:
     void setupUI();
     void updateSeekSlider();
+    void updateAlbumArt();      // From the engine's art cache; fills in when it loads
     QString formatTime(Duration dur);
     
     AudioEngine* audioEngine_{nullptr};
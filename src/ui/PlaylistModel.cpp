@@ -0,0 +1,141 @@
+#include "PlaylistModel.hpp"
+#include "util/FileUtils.hpp"
+
+#include <QColor>
+#include <QFont>
+
+namespace vc {
+
+PlaylistModel::PlaylistModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void PlaylistModel::setPlaylist(Playlist* playlist) {
+    playlist_ = playlist;
+    
+    if (playlist_) {
+        playlist_->itemAdded.connect([this](usize index) {
+            onItemsAdded(index, 1);
+        });
+        playlist_->itemsAdded.connect([this](usize first, usize count) {
+            onItemsAdded(first, count);
+        });
+        playlist_->itemRemoved.connect([this](usize index) {
+            onItemRemoved(index);
+        });
+        playlist_->changed.connect([this] {
+            onChanged();
+        });
+        playlist_->currentChanged.connect([this](usize) {
+            onCurrentChanged();
+        });
+    }
+    
+    sync();
+}
+
+int PlaylistModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : rows_;
+}
+
+QVariant PlaylistModel::data(const QModelIndex& index, int role) const {
+    if (!playlist_ || !index.isValid()) return {};
+    
+    const auto* item = playlist_->itemAt(static_cast<usize>(index.row()));
+    if (!item) return {};
+    
+    switch (role) {
+        case Qt::DisplayRole:
+            return QString::fromStdString(item->metadata.displayArtist()) + " - " +
+                   QString::fromStdString(item->metadata.displayTitle());
+        
+        case Qt::ToolTipRole:
+            return QString::fromStdString(item->path.string()) + "\n" +
+                   QString::fromStdString(file::formatDuration(item->metadata.duration));
+        
+        case Qt::BackgroundRole:
+            if (index.row() == currentRow_) return QColor(0, 255, 136, 50);
+            break;
+        
+        case Qt::FontRole:
+            if (index.row() == currentRow_) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            break;
+    }
+    return {};
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex& index) const {
+    // Drops land between rows; PlaylistView turns them into Playlist::move
+    if (!index.isValid()) return Qt::ItemIsDropEnabled;
+    return QAbstractListModel::flags(index) | Qt::ItemIsDragEnabled;
+}
+
+void PlaylistModel::onItemsAdded(usize first, usize count) {
+    // Appends are the common case; anything else and we just start over
+    if (first != static_cast<usize>(rows_) || first + count != playlist_->size()) {
+        sync();
+        return;
+    }
+    
+    beginInsertRows({}, rows_, rows_ + static_cast<int>(count) - 1);
+    rows_ += static_cast<int>(count);
+    endInsertRows();
+    handled_ = true;
+}
+
+void PlaylistModel::onItemRemoved(usize index) {
+    if (static_cast<usize>(rows_) != playlist_->size() + 1 || index >= playlist_->size() + 1) {
+        sync();
+        return;
+    }
+    
+    int row = static_cast<int>(index);
+    beginRemoveRows({}, row, row);
+    --rows_;
+    endRemoveRows();
+    onCurrentChanged();
+    handled_ = true;
+}
+
+void PlaylistModel::onChanged() {
+    if (std::exchange(handled_, false) && static_cast<usize>(rows_) == playlist_->size()) {
+        return;
+    }
+    
+    // Clear, move, shuffle, watcher removals: only the count tells us what
+    // happened, and repainting every row only touches the visible ones
+    if (static_cast<usize>(rows_) != playlist_->size()) {
+        sync();
+    } else if (rows_ > 0) {
+        emit dataChanged(index(0), index(rows_ - 1));
+        onCurrentChanged();
+    }
+}
+
+void PlaylistModel::onCurrentChanged() {
+    int previous = currentRow_;
+    auto current = playlist_ ? playlist_->currentIndex() : std::nullopt;
+    currentRow_ = current ? static_cast<int>(*current) : -1;
+    
+    if (previous == currentRow_) return;
+    for (int row : {previous, currentRow_}) {
+        if (row >= 0 && row < rows_) {
+            emit dataChanged(index(row), index(row), {Qt::BackgroundRole, Qt::FontRole});
+        }
+    }
+}
+
+void PlaylistModel::sync() {
+    beginResetModel();
+    rows_ = playlist_ ? static_cast<int>(playlist_->size()) : 0;
+    auto current = playlist_ ? playlist_->currentIndex() : std::nullopt;
+    currentRow_ = current ? static_cast<int>(*current) : -1;
+    endResetModel();
+}
+
+} // namespace vc
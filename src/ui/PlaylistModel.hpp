@@ -0,0 +1,37 @@
+#pragma once
+// PlaylistModel.hpp - List model over the playlist
+// Rows are made up on demand; nobody needs 100k widgets
+
+#include "util/Types.hpp"
+#include "audio/Playlist.hpp"
+
+#include <QAbstractListModel>
+
+namespace vc {
+
+class PlaylistModel : public QAbstractListModel {
+public:
+    explicit PlaylistModel(QObject* parent = nullptr);
+    
+    // Follows the playlist's signals, which all fire on the GUI thread. Set once.
+    void setPlaylist(Playlist* playlist);
+    
+    int rowCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    Qt::DropActions supportedDropActions() const override { return Qt::MoveAction; }
+    
+private:
+    void onItemsAdded(usize first, usize count);
+    void onItemRemoved(usize index);
+    void onChanged();
+    void onCurrentChanged();
+    void sync();    // Reset to whatever the playlist holds now
+    
+    Playlist* playlist_{nullptr};
+    int rows_{0};           // What the views were last told
+    int currentRow_{-1};
+    bool handled_{false};   // The changed that follows an add/remove has nothing new
+};
+
+} // namespace vc
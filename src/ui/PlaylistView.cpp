@@ -1,6 +1,5 @@
 #include "PlaylistView.hpp"
 #include "core/Logger.hpp"
-#include "util/FileUtils.hpp"
 
 #include <QDragEnterEvent>
 #include <QDropEvent>
@@ -12,8 +11,11 @@
 namespace vc {
 
 PlaylistView::PlaylistView(QWidget* parent)
-    : QListWidget(parent)
+    : QListView(parent)
+    , model_(new PlaylistModel(this))
 {
+    setModel(model_);
+    setUniformItemSizes(true);  // Row heights aren't measured one by one
     setAcceptDrops(true);
     setDragDropMode(QAbstractItemView::InternalMove);
     setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -24,63 +26,38 @@ PlaylistView::PlaylistView(QWidget* parent)
 
 void PlaylistView::setPlaylist(Playlist* playlist) {
     playlist_ = playlist;
+    model_->setPlaylist(playlist);
     
     if (playlist_) {
-        playlist_->changed.connect([this] {
-            QMetaObject::invokeMethod(this, &PlaylistView::refresh);
-        });
-        
         playlist_->currentChanged.connect([this](usize) {
             QMetaObject::invokeMethod(this, &PlaylistView::scrollToCurrent);
         });
-        
-        refresh();
     }
 }
 
-void PlaylistView::refresh() {
-    clear();
-    
-    if (!playlist_) return;
+void PlaylistView::scrollToCurrent() {
+    if (!playlist_ || !playlist_->currentIndex()) return;
     
-    for (usize i = 0; i < playlist_->size(); ++i) {
-        const auto* item = playlist_->itemAt(i);
-        if (!item) continue;
-        
-        QString text = QString::fromStdString(item->metadata.displayArtist()) + " - " +
-                       QString::fromStdString(item->metadata.displayTitle());
-        
-        auto* listItem = new QListWidgetItem(text, this);
-        
-        // Duration as tooltip
-        QString duration = QString::fromStdString(file::formatDuration(item->metadata.duration));
-        listItem->setToolTip(QString::fromStdString(item->path.string()) + "\n" + duration);
-        
-        // Highlight current
-        if (playlist_->currentIndex() && *playlist_->currentIndex() == i) {
-            listItem->setBackground(QColor(0, 255, 136, 50));
-            QFont font = listItem->font();
-            font.setBold(true);
-            listItem->setFont(font);
-        }
+    int row = static_cast<int>(*playlist_->currentIndex());
+    if (row < model_->rowCount()) {
+        scrollTo(model_->index(row));
     }
 }
 
-void PlaylistView::scrollToCurrent() {
-    if (!playlist_ || !playlist_->currentIndex()) return;
-    
-    usize idx = *playlist_->currentIndex();
-    if (idx < static_cast<usize>(count())) {
-        scrollToItem(item(idx));
-        refresh();  // Update highlighting
+std::vector<int> PlaylistView::selectedRows() const {
+    std::vector<int> rows;
+    for (const auto& index : selectionModel()->selectedIndexes()) {
+        rows.push_back(index.row());
     }
+    std::sort(rows.begin(), rows.end());
+    return rows;
 }
 
 void PlaylistView::dragEnterEvent(QDragEnterEvent* event) {
     if (event->mimeData()->hasUrls()) {
         event->acceptProposedAction();
     } else {
-        QListWidget::dragEnterEvent(event);
+        QListView::dragEnterEvent(event);
     }
 }
 
@@ -88,7 +65,7 @@ void PlaylistView::dragMoveEvent(QDragMoveEvent* event) {
     if (event->mimeData()->hasUrls()) {
         event->acceptProposedAction();
     } else {
-        QListWidget::dragMoveEvent(event);
+        QListView::dragMoveEvent(event);
     }
 }
 
@@ -106,8 +83,28 @@ void PlaylistView::dropEvent(QDropEvent* event) {
         }
         
         event->acceptProposedAction();
-    } else {
-        QListWidget::dropEvent(event);
+    } else if (event->source() == this && playlist_) {
+        // Reorder the playlist itself; the model follows its changes
+        auto rows = selectedRows();
+        int target = indexAt(event->position().toPoint()).row();
+        if (target < 0) target = static_cast<int>(playlist_->size());
+        
+        // Rows above the target close up behind it, rows below stack after it
+        int above = 0;
+        int below = 0;
+        for (int r : rows) {
+            if (r < target) {
+                playlist_->move(static_cast<usize>(r - above), static_cast<usize>(target - 1));
+                ++above;
+            } else {
+                playlist_->move(static_cast<usize>(r), static_cast<usize>(target + below));
+                ++below;
+            }
+        }
+        
+        // The move is done; don't let the view remove the dragged rows
+        event->setDropAction(Qt::CopyAction);
+        event->accept();
     }
 }
 
@@ -116,12 +113,11 @@ void PlaylistView::contextMenuEvent(QContextMenuEvent* event) {
 }
 
 void PlaylistView::mouseDoubleClickEvent(QMouseEvent* event) {
-    auto* item = itemAt(event->pos());
-    if (item) {
-        int row = this->row(item);
-        emit trackDoubleClicked(static_cast<usize>(row));
+    auto index = indexAt(event->pos());
+    if (index.isValid()) {
+        emit trackDoubleClicked(static_cast<usize>(index.row()));
     }
-    QListWidget::mouseDoubleClickEvent(event);
+    QListView::mouseDoubleClickEvent(event);
 }
 
 void PlaylistView::setupContextMenu() {
@@ -140,17 +136,10 @@ void PlaylistView::setupContextMenu() {
 void PlaylistView::onRemoveSelected() {
     if (!playlist_) return;
     
-    auto selected = selectedItems();
-    
     // Remove from back to front to preserve indices
-    std::vector<int> rows;
-    for (auto* item : selected) {
-        rows.push_back(row(item));
-    }
-    std::sort(rows.rbegin(), rows.rend());
-    
-    for (int r : rows) {
-        playlist_->removeAt(static_cast<usize>(r));
+    auto rows = selectedRows();
+    for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+        playlist_->removeAt(static_cast<usize>(*it));
     }
 }
 
@@ -161,11 +150,10 @@ void PlaylistView::onClearPlaylist() {
 }
 
 void PlaylistView::onShowInFolder() {
-    auto selected = selectedItems();
-    if (selected.isEmpty() || !playlist_) return;
+    auto rows = selectedRows();
+    if (rows.empty() || !playlist_) return;
     
-    int r = row(selected.first());
-    const auto* item = playlist_->itemAt(static_cast<usize>(r));
+    const auto* item = playlist_->itemAt(static_cast<usize>(rows.front()));
     if (item) {
         QDesktopServices::openUrl(QUrl::fromLocalFile(
             QString::fromStdString(item->path.parent_path().string())));
@@ -4,13 +4,14 @@
 
 #include "util/Types.hpp"
 #include "audio/Playlist.hpp"
+#include "PlaylistModel.hpp"
 
-#include <QListWidget>
+#include <QListView>
 #include <QMenu>
 
 namespace vc {
 
-class PlaylistView : public QListWidget {
+class PlaylistView : public QListView {
     Q_OBJECT
     
 public:
@@ -23,7 +24,6 @@ signals:
     void filesDropped(const QStringList& paths);
     
 public slots:
-    void refresh();
     void scrollToCurrent();
     
 protected:
@@ -40,9 +40,10 @@ private slots:
     
 private:
     void setupContextMenu();
-    void updateItem(int row, const PlaylistItem& item);
+    std::vector<int> selectedRows() const;  // Ascending
     
     Playlist* playlist_{nullptr};
+    PlaylistModel* model_{nullptr};
     QMenu* contextMenu_{nullptr};
     QAction* removeAction_{nullptr};
     QAction* clearAction_{nullptr};
@@ -1,9 +1,11 @@
 #include "PresetBrowser.hpp"
 #include "core/Logger.hpp"
+#include "visualizer/PresetThumbnailer.hpp"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QScrollBar>
 
 namespace vc {
 
@@ -15,6 +17,7 @@ PresetBrowser::PresetBrowser(QWidget* parent)
 
 void PresetBrowser::setPresetManager(PresetManager* manager) {
     presetManager_ = manager;
+    model_->setPresetManager(manager);
     
     if (manager) {
         manager->listChanged.connect([this] {
@@ -29,6 +32,21 @@ void PresetBrowser::setPresetManager(PresetManager* manager) {
     }
 }
 
+void PresetBrowser::setThumbnailer(PresetThumbnailer* thumbnailer) {
+    thumbnailer_ = thumbnailer;
+    
+    if (thumbnailer) {
+        thumbnailer->thumbnailReady.connect([this](const fs::path& path) {
+            QMetaObject::invokeMethod(this, [this, p = QString::fromStdString(path.string())] {
+                onThumbnailReady(p);
+            });
+        });
+        
+        presetList_->setIconSize(QSize(64, 36));
+        thumbnailTimer_.start();
+    }
+}
+
 void PresetBrowser::setupUI() {
     auto* layout = new QVBoxLayout(this);
     layout->setContentsMargins(4, 4, 4, 4);
@@ -64,10 +82,21 @@ void PresetBrowser::setupUI() {
     layout->addLayout(filterLayout);
     
     // Preset list
-    presetList_ = new QListWidget();
+    model_ = new PresetListModel(this);
+    presetList_ = new QListView();
+    presetList_->setModel(model_);
+    presetList_->setUniformItemSizes(true);  // Row heights aren't measured one by one
+    presetList_->setEditTriggers(QAbstractItemView::NoEditTriggers);
     presetList_->setAlternatingRowColors(true);
-    connect(presetList_, &QListWidget::itemDoubleClicked, 
+    connect(presetList_, &QListView::doubleClicked, 
             this, &PresetBrowser::onPresetDoubleClicked);
+    
+    // Thumbnails are fetched for what's on screen once scrolling pauses
+    thumbnailTimer_.setSingleShot(true);
+    thumbnailTimer_.setInterval(100);
+    connect(&thumbnailTimer_, &QTimer::timeout, this, &PresetBrowser::requestVisibleThumbnails);
+    connect(presetList_->verticalScrollBar(), &QScrollBar::valueChanged,
+            &thumbnailTimer_, qOverload<>(&QTimer::start));
     layout->addWidget(presetList_, 1);
     
     // Action buttons
@@ -88,7 +117,7 @@ void PresetBrowser::setupUI() {
 
 void PresetBrowser::refresh() {
     if (!presetManager_) {
-        presetList_->clear();
+        model_->setPresets({});
         return;
     }
     
@@ -113,17 +142,12 @@ void PresetBrowser::refresh() {
 void PresetBrowser::scrollToCurrent() {
     if (!presetManager_) return;
     
-    const auto* current = presetManager_->current();
-    if (!current) return;
+    int row = model_->rowOf(presetManager_->current());
+    if (row < 0) return;
     
-    for (int i = 0; i < presetList_->count(); ++i) {
-        auto* item = presetList_->item(i);
-        if (item->data(Qt::UserRole).toString().toStdString() == current->path.string()) {
-            presetList_->scrollToItem(item);
-            presetList_->setCurrentItem(item);
-            break;
-        }
-    }
+    auto index = model_->index(row);
+    presetList_->scrollTo(index);
+    presetList_->setCurrentIndex(index);
 }
 
 void PresetBrowser::onSearchTextChanged(const QString& text) {
@@ -168,10 +192,10 @@ void PresetBrowser::onCategoryChanged(int index) {
     populateList(presets);
 }
 
-void PresetBrowser::onPresetDoubleClicked(QListWidgetItem* item) {
-    if (!presetManager_) return;
+void PresetBrowser::onPresetDoubleClicked(const QModelIndex& index) {
+    if (!presetManager_ || !index.isValid()) return;
     
-    QString path = item->data(Qt::UserRole).toString();
+    QString path = index.data(PresetListModel::PathRole).toString();
     presetManager_->selectByPath(fs::path(path.toStdString()));
     emit presetSelected(path);
 }
@@ -179,53 +203,69 @@ void PresetBrowser::onPresetDoubleClicked(QListWidgetItem* item) {
 void PresetBrowser::onFavoriteClicked() {
     if (!presetManager_) return;
     
-    auto* item = presetList_->currentItem();
-    if (!item) return;
+    const auto* preset = model_->presetAt(presetList_->currentIndex().row());
+    if (!preset) return;
     
-    QString path = item->data(Qt::UserRole).toString();
-    for (usize i = 0; i < presetManager_->allPresets().size(); ++i) {
-        if (presetManager_->allPresets()[i].path.string() == path.toStdString()) {
-            presetManager_->toggleFavorite(i);
-            break;
-        }
+    if (auto index = presetManager_->indexOf(preset->path)) {
+        presetManager_->toggleFavorite(*index);
     }
 }
 
 void PresetBrowser::onBlacklistClicked() {
     if (!presetManager_) return;
     
-    auto* item = presetList_->currentItem();
-    if (!item) return;
+    const auto* preset = model_->presetAt(presetList_->currentIndex().row());
+    if (!preset) return;
     
-    QString path = item->data(Qt::UserRole).toString();
-    for (usize i = 0; i < presetManager_->allPresets().size(); ++i) {
-        if (presetManager_->allPresets()[i].path.string() == path.toStdString()) {
-            presetManager_->toggleBlacklisted(i);
-            break;
-        }
+    if (auto index = presetManager_->indexOf(preset->path)) {
+        presetManager_->toggleBlacklisted(*index);
     }
 }
 
-void PresetBrowser::populateList(const std::vector<const PresetInfo*>& presets) {
-    presetList_->clear();
-    
-    for (const auto* preset : presets) {
-        QString name = QString::fromStdString(preset->name);
-        auto* item = new QListWidgetItem(name, presetList_);
-        item->setData(Qt::UserRole, QString::fromStdString(preset->path.string()));
+void PresetBrowser::requestVisibleThumbnails() {
+    int rows = model_->rowCount();
+    if (!thumbnailer_ || rows == 0) return;
+    
+    int first = presetList_->indexAt(QPoint(0, 0)).row();
+    int last = presetList_->indexAt(QPoint(0, presetList_->viewport()->height() - 1)).row();
+    if (first < 0) first = 0;
+    if (last < 0) last = rows - 1;
+    
+    // On screen first, then a screenful below, which is where scrolling usually goes
+    int page = last - first + 1;
+    last = std::min(rows - 1, last + page);
+    
+    std::vector<fs::path> wanted;
+    for (int row = first; row <= last; ++row) {
+        const auto* preset = model_->presetAt(row);
+        if (!preset) continue;
         
-        if (preset->favorite) {
-            item->setText("★ " + name);
-            item->setForeground(QColor(255, 215, 0));
-        }
+        QString key = QString::fromStdString(preset->path.string());
+        if (model_->hasThumbnail(key)) continue;
         
-        QString tooltip = QString::fromStdString(preset->path.filename().string());
-        if (!preset->author.empty()) {
-            tooltip += "\nAuthor: " + QString::fromStdString(preset->author);
+        if (auto image = thumbnailer_->find(preset->path)) {
+            model_->setThumbnail(key, QPixmap::fromImage(*image));
+        } else {
+            wanted.push_back(preset->path);
         }
-        tooltip += "\nCategory: " + QString::fromStdString(preset->category);
-        tooltip += QString("\nPlays: %1").arg(preset->playCount);
-        item->setToolTip(tooltip);
+    }
+    thumbnailer_->request(std::move(wanted));
+}
+
+void PresetBrowser::onThumbnailReady(const QString& path) {
+    if (!thumbnailer_) return;
+    
+    if (auto image = thumbnailer_->find(path.toStdString())) {
+        model_->setThumbnail(path, QPixmap::fromImage(*image));
+    }
+}
+
+void PresetBrowser::populateList(const std::vector<const PresetInfo*>& presets) {
+    // Swaps the row ids in; text, colours and tooltips are made when painted
+    model_->setPresets(presets);
+    
+    if (thumbnailer_) {
+        thumbnailTimer_.start();
     }
 }
 
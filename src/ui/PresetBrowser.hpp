@@ -4,15 +4,19 @@
 
 #include "util/Types.hpp"
 #include "visualizer/PresetManager.hpp"
+#include "PresetListModel.hpp"
 
 #include <QWidget>
-#include <QListWidget>
+#include <QListView>
 #include <QLineEdit>
 #include <QComboBox>
 #include <QPushButton>
+#include <QTimer>
 
 namespace vc {
 
+class PresetThumbnailer;
+
 class PresetBrowser : public QWidget {
     Q_OBJECT
     
@@ -20,6 +24,7 @@ public:
     explicit PresetBrowser(QWidget* parent = nullptr);
     
     void setPresetManager(PresetManager* manager);
+    void setThumbnailer(PresetThumbnailer* thumbnailer);
     
 signals:
     void presetSelected(const QString& path);
@@ -31,9 +36,11 @@ public slots:
 private slots:
     void onSearchTextChanged(const QString& text);
     void onCategoryChanged(int index);
-    void onPresetDoubleClicked(QListWidgetItem* item);
+    void onPresetDoubleClicked(const QModelIndex& index);
     void onFavoriteClicked();
     void onBlacklistClicked();
+    void requestVisibleThumbnails();
+    void onThumbnailReady(const QString& path);
     
 private:
     void setupUI();
@@ -41,10 +48,13 @@ private:
     void updateCategories();
     
     PresetManager* presetManager_{nullptr};
+    PresetThumbnailer* thumbnailer_{nullptr};
+    QTimer thumbnailTimer_;     // Settles scrolling before asking for thumbnails
     
     QLineEdit* searchEdit_{nullptr};
     QComboBox* categoryCombo_{nullptr};
-    QListWidget* presetList_{nullptr};
+    QListView* presetList_{nullptr};
+    PresetListModel* model_{nullptr};
     QPushButton* favoriteButton_{nullptr};
     QPushButton* blacklistButton_{nullptr};
     QPushButton* randomButton_{nullptr};
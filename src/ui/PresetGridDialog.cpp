@@ -0,0 +1,136 @@
+#include "PresetGridDialog.hpp"
+#include "core/Config.hpp"
+#include "core/Logger.hpp"
+
+#include <QEvent>
+#include <QGridLayout>
+#include <QImage>
+#include <QPixmap>
+#include <algorithm>
+#include <random>
+
+namespace vc {
+
+PresetGridDialog::PresetGridDialog(PresetManager& presets, const QSurfaceFormat& format, QWidget* parent)
+    : QDialog(parent)
+    , presets_(presets)
+{
+    setWindowTitle("Preset Grid");
+
+    auto* layout = new QGridLayout(this);
+    layout->setSpacing(4);
+
+    if (auto result = host_.start(format, FPS); !result) {
+        LOG_ERROR("Preset grid: {}", result.error().message);
+        return;
+    }
+
+    // Small and disposable: coarse mesh, no tuning, nothing preloaded
+    const auto& vizConfig = CONFIG.visualizer();
+    ProjectMConfig config;
+    config.width = TILE_WIDTH;
+    config.height = TILE_HEIGHT;
+    config.fps = FPS;
+    config.beatSensitivity = vizConfig.beatSensitivity;
+    config.presetDuration = vizConfig.presetDuration;
+    config.transitionDuration = vizConfig.smoothPresetDuration;
+    config.meshX = 48;
+    config.meshY = 36;
+    config.autoMesh = false;
+    config.preloadCount = 0;
+
+    updatePresets();
+    listChanged_ = ScopedConnection<>(presets_.listChanged, [this] {
+        QMetaObject::invokeMethod(this, &PresetGridDialog::updatePresets);
+    });
+
+    // Both on the host thread: copy what the GUI needs and hop over
+    host_.frameRendered.connect([this](u32 id, RenderTarget& target) {
+        QImage image(TILE_WIDTH, TILE_HEIGHT, QImage::Format_RGBA8888);
+        target.readPixels(image.bits());
+        QMetaObject::invokeMethod(this, [this, id, image = image.mirrored()] {  // GL rows are bottom-up
+            showFrame(id, image);
+        });
+    });
+    host_.presetLoaded.connect([this](u32 id, const fs::path& path) {
+        QMetaObject::invokeMethod(this, [this, id, path] { showPreset(id, path); });
+    });
+
+    // Distinct presets to start with; after that each tile picks its own
+    std::vector<const PresetInfo*> start;
+    auto active = presets_.activePresets();
+    std::sample(active.begin(), active.end(), std::back_inserter(start), COLUMNS * ROWS,
+                std::mt19937{std::random_device{}()});
+
+    for (u32 i = 0; i < COLUMNS * ROWS; ++i) {
+        auto id = host_.addInstance(config);
+        if (!id) {
+            LOG_WARN("Preset grid: {}", id.error().message);
+            break;
+        }
+
+        auto* label = new QLabel();
+        label->setFixedSize(TILE_WIDTH, TILE_HEIGHT);
+        label->setStyleSheet("background-color: black;");
+        label->installEventFilter(this);
+        layout->addWidget(label, i / COLUMNS, i % COLUMNS);
+        tiles_.push_back({id.value(), label, {}});
+
+        if (i < start.size()) {
+            host_.loadPreset(id.value(), start[i]->path);
+        }
+    }
+}
+
+PresetGridDialog::~PresetGridDialog() {
+    listChanged_.disconnect();
+    host_.stop();
+}
+
+void PresetGridDialog::feedAudio(const f32* data, u32 frames, u32 channels) {
+    for (const auto& tile : tiles_) {
+        host_.feedAudio(tile.id, data, frames, channels);
+    }
+}
+
+bool PresetGridDialog::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::MouseButtonDblClick) {
+        for (const auto& tile : tiles_) {
+            if (tile.label == watched && !tile.preset.empty()) {
+                emit presetSelected(QString::fromStdString(tile.preset.string()));
+                return true;
+            }
+        }
+    }
+    return QDialog::eventFilter(watched, event);
+}
+
+void PresetGridDialog::updatePresets() {
+    std::vector<fs::path> paths;
+    for (const auto* preset : presets_.activePresets()) {
+        paths.push_back(preset->path);
+    }
+    host_.setPresets(std::move(paths));
+}
+
+void PresetGridDialog::showFrame(u32 id, const QImage& image) {
+    if (auto* tile = tileFor(id)) {
+        tile->label->setPixmap(QPixmap::fromImage(image));
+    }
+}
+
+void PresetGridDialog::showPreset(u32 id, const fs::path& path) {
+    if (auto* tile = tileFor(id)) {
+        tile->preset = path;
+        tile->label->setToolTip(QString::fromStdString(path.stem().string()));
+    }
+}
+
+PresetGridDialog::Tile* PresetGridDialog::tileFor(u32 id) {
+    for (auto& tile : tiles_) {
+        if (tile.id == id) return &tile;
+    }
+    return nullptr;
+}
+
+} // namespace vc
@@ -0,0 +1,59 @@
+#pragma once
+// PresetGridDialog.hpp - Several presets live at once, pick the one you like
+// Channel surfing, but every channel is on at the same time
+
+#include "util/Types.hpp"
+#include "visualizer/PresetManager.hpp"
+#include "visualizer/ProjectMHost.hpp"
+
+#include <QDialog>
+#include <QLabel>
+#include <QSurfaceFormat>
+#include <vector>
+
+namespace vc {
+
+// A grid of small ProjectM instances on one ProjectMHost, each playing its
+// own preset to the current audio and moving on when the preset ends.
+// Double-click a tile to play its preset in the main visualizer.
+class PresetGridDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    PresetGridDialog(PresetManager& presets, const QSurfaceFormat& format, QWidget* parent = nullptr);
+    ~PresetGridDialog() override;
+
+    // GUI thread, same feed as the main visualizer
+    void feedAudio(const f32* data, u32 frames, u32 channels);
+
+signals:
+    void presetSelected(const QString& path);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    struct Tile {
+        u32 id{0};
+        QLabel* label{nullptr};
+        fs::path preset;
+    };
+
+    void updatePresets();
+    void showFrame(u32 id, const QImage& image);
+    void showPreset(u32 id, const fs::path& path);
+    Tile* tileFor(u32 id);
+
+    PresetManager& presets_;
+    ScopedConnection<> listChanged_;
+    ProjectMHost host_;
+    std::vector<Tile> tiles_;
+
+    static constexpr u32 COLUMNS = 3;
+    static constexpr u32 ROWS = 3;
+    static constexpr u32 TILE_WIDTH = 320;
+    static constexpr u32 TILE_HEIGHT = 180;
+    static constexpr u32 FPS = 30;
+};
+
+} // namespace vc
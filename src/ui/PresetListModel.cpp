@@ -0,0 +1,103 @@
+#include "PresetListModel.hpp"
+
+#include <QColor>
+#include <algorithm>
+
+namespace vc {
+
+PresetListModel::PresetListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void PresetListModel::setPresetManager(const PresetManager* manager) {
+    beginResetModel();
+    manager_ = manager;
+    ids_.clear();
+    endResetModel();
+}
+
+void PresetListModel::setPresets(const std::vector<const PresetInfo*>& presets) {
+    beginResetModel();
+    ids_.resize(presets.size());
+    std::transform(presets.begin(), presets.end(), ids_.begin(),
+                   [](const PresetInfo* p) { return p->id; });
+    generation_ = manager_ ? manager_->generation() : 0;
+    endResetModel();
+}
+
+const PresetInfo* PresetListModel::presetAt(int row) const {
+    if (!manager_ || row < 0 || row >= static_cast<int>(ids_.size())) return nullptr;
+    if (manager_->generation() != generation_) return nullptr;  // Same id, another preset
+    return manager_->byId(ids_[static_cast<usize>(row)]);
+}
+
+int PresetListModel::rowOf(const PresetInfo* preset) const {
+    if (!preset || !manager_ || manager_->generation() != generation_) return -1;
+    auto it = std::find(ids_.begin(), ids_.end(), preset->id);
+    return it == ids_.end() ? -1 : static_cast<int>(it - ids_.begin());
+}
+
+void PresetListModel::setThumbnail(const QString& path, const QPixmap& pixmap) {
+    thumbnails_.insert(path, new QPixmap(pixmap));
+    
+    // Only the rows on screen get repainted, so this stays cheap
+    if (!ids_.empty()) {
+        emit dataChanged(index(0), index(static_cast<int>(ids_.size()) - 1),
+                         {Qt::DecorationRole});
+    }
+}
+
+int PresetListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(ids_.size());
+}
+
+QVariant PresetListModel::data(const QModelIndex& index, int role) const {
+    const auto* preset = presetAt(index.row());
+    if (!preset) return {};
+    
+    switch (role) {
+        case Qt::DisplayRole: {
+            QString name = QString::fromStdString(preset->name);
+            return preset->favorite ? "★ " + name : name;
+        }
+        
+        case Qt::ForegroundRole:
+            if (preset->favorite) return QColor(255, 215, 0);
+            if (preset->slow) return QColor(255, 120, 80);
+            break;
+        
+        case Qt::DecorationRole:
+            if (auto* pixmap = thumbnails_.object(QString::fromStdString(preset->path.string()))) {
+                return *pixmap;
+            }
+            break;
+        
+        case Qt::ToolTipRole: {
+            QString tooltip = QString::fromStdString(preset->path.filename().string());
+            if (!preset->author.empty()) {
+                tooltip += "\nAuthor: " + QString::fromStdString(preset->author);
+            }
+            tooltip += "\nCategory: " + QString::fromStdString(preset->category);
+            tooltip += QString("\nPlays: %1").arg(preset->playCount);
+            if (preset->cost) {
+                tooltip += QString("\nRender: %1 ms avg, %2 ms p99 at %3x%4 (compile %5 ms)")
+                    .arg(preset->cost->avgFrameMs, 0, 'f', 2)
+                    .arg(preset->cost->p99FrameMs, 0, 'f', 2)
+                    .arg(preset->cost->width)
+                    .arg(preset->cost->height)
+                    .arg(preset->cost->compileMs, 0, 'f', 0);
+                if (preset->slow) {
+                    tooltip += "\nToo slow for the configured frame rate";
+                }
+            }
+            return tooltip;
+        }
+        
+        case PathRole:
+            return QString::fromStdString(preset->path.string());
+    }
+    return {};
+}
+
+} // namespace vc
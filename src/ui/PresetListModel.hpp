@@ -0,0 +1,43 @@
+#pragma once
+// PresetListModel.hpp - List model over a preset query
+// Ten thousand presets, a dozen of them on screen
+
+#include "util/Types.hpp"
+#include "visualizer/PresetManager.hpp"
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QPixmap>
+
+namespace vc {
+
+class PresetListModel : public QAbstractListModel {
+public:
+    static constexpr int PathRole = Qt::UserRole;
+    
+    explicit PresetListModel(QObject* parent = nullptr);
+    
+    void setPresetManager(const PresetManager* manager);
+    
+    // Rows are kept as preset ids and looked up when painted. Ids are
+    // renumbered by a rescan, so rows from an older generation read as
+    // empty until the browser sets the list again on listChanged.
+    void setPresets(const std::vector<const PresetInfo*>& presets);
+    const PresetInfo* presetAt(int row) const;
+    int rowOf(const PresetInfo* preset) const;
+    
+    // Thumbnails are pushed in by the browser as they turn up
+    bool hasThumbnail(const QString& path) const { return thumbnails_.contains(path); }
+    void setThumbnail(const QString& path, const QPixmap& pixmap);
+    
+    int rowCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    
+private:
+    const PresetManager* manager_{nullptr};
+    std::vector<u32> ids_;
+    u32 generation_{0};         // PresetManager::generation() the ids belong to
+    QCache<QString, QPixmap> thumbnails_{2048};
+};
+
+} // namespace vc
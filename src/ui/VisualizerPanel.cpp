@@ -87,6 +87,7 @@ void VisualizerPanel::setupUI() {
     
     // Connect visualizer signals
     connect(visualizer_, &VisualizerWidget::fpsChanged, this, &VisualizerPanel::updateFPS);
+    connect(visualizer_, &VisualizerWidget::frameStatsChanged, this, &VisualizerPanel::updateFrameStats);
     
     visualizer_->projectM().presetChanged.connect([this](const std::string& name) {
         QMetaObject::invokeMethod(this, [this, name] {
@@ -105,7 +106,23 @@ void VisualizerPanel::updatePresetName(const QString& name) {
 }
 
 void VisualizerPanel::updateFPS(f32 fps) {
-    fpsLabel_->setText(QString("%1 FPS").arg(static_cast<int>(fps)));
+    fpsLabel_->setText(QString("%1 FPS").arg(qRound(fps)));
+}
+
+void VisualizerPanel::updateFrameStats(const FrameTimeStats& stats) {
+    fpsLabel_->setToolTip(QString(
+        "Frame time (last %1 frames)\n"
+        "p50 %2 ms  p95 %3 ms  p99 %4 ms  max %5 ms\n"
+        "Render scale: %6%\n"
+        "Missed deadlines: %7%8")
+        .arg(stats.samples)
+        .arg(stats.p50Ms, 0, 'f', 2)
+        .arg(stats.p95Ms, 0, 'f', 2)
+        .arg(stats.p99Ms, 0, 'f', 2)
+        .arg(stats.maxMs, 0, 'f', 2)
+        .arg(qRound(stats.renderScale * 100.0f))
+        .arg(stats.missedDeadlines)
+        .arg(stats.vsyncLocked ? "\nLocked to display refresh" : ""));
 }
 
 } // namespace vc
@@ -30,6 +30,7 @@ signals:
 public slots:
     void updatePresetName(const QString& name);
     void updateFPS(f32 fps);
+    void updateFrameStats(const FrameTimeStats& stats);
     
 private:
     void setupUI();
@@ -123,6 +123,32 @@ Result<std::vector<u8>> readBinary(const fs::path& path) {
     return Result<std::vector<u8>>::ok(std::move(data));
 }
 
+Result<void> writeBinary(const fs::path& path, const u8* data, usize size) {
+    // Same temp-then-rename dance as writeText
+    auto tempPath = path;
+    tempPath += ".tmp";
+    
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file) {
+            return Result<void>::err("Failed to open file for writing: " + tempPath.string());
+        }
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file) {
+            return Result<void>::err("Failed to write to file: " + tempPath.string());
+        }
+    }
+    
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath);
+        return Result<void>::err("Failed to rename temp file: " + ec.message());
+    }
+    
+    return Result<void>::ok();
+}
+
 std::vector<fs::path> listFiles(const fs::path& dir, 
                                  const std::set<std::string>& extensions,
                                  bool recursive) {
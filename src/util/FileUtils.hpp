@@ -27,6 +27,9 @@ Result<void> writeText(const fs::path& path, std::string_view content);
 // Read binary file
 Result<std::vector<u8>> readBinary(const fs::path& path);
 
+// Write binary file (atomic)
+Result<void> writeBinary(const fs::path& path, const u8* data, usize size);
+
 // List files with extension filter
 std::vector<fs::path> listFiles(const fs::path& dir, 
                                  const std::set<std::string>& extensions = {},
@@ -0,0 +1,328 @@
+#include "FileWatcher.hpp"
+#include "ParallelScan.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace vc {
+
+namespace {
+
+constexpr u32 WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE |
+                           IN_DELETE | IN_DELETE_SELF | IN_ONLYDIR;
+
+i64 nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool within(const fs::path& path, const fs::path& dir) {
+    const auto& p = path.native();
+    const auto& d = dir.native();
+    return p.size() > d.size() && p.compare(0, d.size(), d) == 0 && p[d.size()] == '/';
+}
+
+} // namespace
+
+bool FileChanges::isRemoved(const fs::path& path) const {
+    // Flushed from an ordered map, so removed is sorted
+    if (std::binary_search(removed.begin(), removed.end(), path)) return true;
+    return std::any_of(removedDirs.begin(), removedDirs.end(),
+                       [&path](const auto& dir) { return within(path, dir); });
+}
+
+FileWatcher::FileWatcher(Options options)
+    : options_(std::move(options))
+{
+}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+Result<void> FileWatcher::start() {
+    if (running_) return Result<void>::ok();
+
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        return Result<void>::err(std::string("inotify_init1 failed: ") + std::strerror(errno));
+    }
+    wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return Result<void>::err(std::string("eventfd failed: ") + std::strerror(errno));
+    }
+
+    running_ = true;
+    thread_ = std::thread([this] { run(); });
+    return Result<void>::ok();
+}
+
+void FileWatcher::stop() {
+    if (!running_) return;
+
+    running_ = false;
+    u64 one = 1;
+    [[maybe_unused]] auto n = ::write(wakeFd_, &one, sizeof(one));
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    ::close(fd_);
+    ::close(wakeFd_);
+    fd_ = wakeFd_ = -1;
+
+    std::lock_guard lock(watchMutex_);
+    watches_.clear();
+    roots_.clear();
+    newRoots_.clear();
+}
+
+Result<void> FileWatcher::watch(const fs::path& root, Listed onListed) {
+    if (!running_) {
+        return Result<void>::err("File watcher is not running");
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        return Result<void>::err("Not a directory: " + root.string());
+    }
+
+    bool known;
+    {
+        std::lock_guard lock(watchMutex_);
+        known = !roots_.insert(root).second;
+    }
+
+    if (!known) {
+        // Root first, even if it's a symlink; below it addTree follows the scanner
+        int wd = ::inotify_add_watch(fd_, root.c_str(), WATCH_MASK);
+        if (wd < 0) {
+            std::lock_guard lock(watchMutex_);
+            roots_.erase(root);
+            return Result<void>::err("Failed to watch " + root.string() + ": " + std::strerror(errno));
+        }
+        std::lock_guard lock(watchMutex_);
+        watches_[wd] = root;
+    } else if (!onListed) {
+        return Result<void>::ok();
+    }
+
+    // A big library takes a while to walk; the caller shouldn't wait for it
+    {
+        std::lock_guard lock(watchMutex_);
+        newRoots_.emplace_back(root, std::move(onListed));
+    }
+    u64 one = 1;
+    [[maybe_unused]] auto n = ::write(wakeFd_, &one, sizeof(one));
+
+    LOG_DEBUG("Watching {}", root.string());
+    return Result<void>::ok();
+}
+
+bool FileWatcher::isWatching(const fs::path& root) const {
+    std::lock_guard lock(watchMutex_);
+    return roots_.contains(root);
+}
+
+void FileWatcher::run() {
+    pollfd fds[2] = {{fd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+
+    while (running_) {
+        int timeout = -1;
+        if (!pending_.empty() || overflow_) {
+            i64 deadline = std::min(lastEventMs_ + options_.quietMs,
+                                    firstEventMs_ + options_.maxDelayMs);
+            i64 remaining = deadline - nowMs();
+            if (remaining <= 0) {
+                flush();
+                continue;
+            }
+            timeout = static_cast<int>(remaining);
+        }
+
+        if (::poll(fds, 2, timeout) < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("File watcher poll failed: {}", std::strerror(errno));
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            u64 count;
+            [[maybe_unused]] auto n = ::read(wakeFd_, &count, sizeof(count));
+            if (!running_) break;
+            addRoots();
+        }
+        if (fds[0].revents & POLLIN) readEvents();
+    }
+}
+
+void FileWatcher::addRoots() {
+    while (running_) {
+        std::pair<fs::path, Listed> next;
+        {
+            std::lock_guard lock(watchMutex_);
+            if (newRoots_.empty()) return;
+            next = std::move(newRoots_.front());
+            newRoots_.pop_front();
+        }
+        auto& [root, onListed] = next;
+
+        // Files already there are the caller's to load, not changes
+        std::vector<fs::path> files;
+        if (options_.recursive) {
+            files = addTree(root);
+            std::sort(files.begin(), files.end());
+        } else if (onListed) {
+            files = DirectoryScanner::files(root, options_.extensions, false);
+        }
+
+        if (onListed) {
+            onListed(std::move(files));
+        }
+    }
+}
+
+void FileWatcher::readEvents() {
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    while (true) {
+        ssize_t length = ::read(fd_, buffer, sizeof(buffer));
+        if (length <= 0) break;  // EAGAIN: drained
+
+        for (char* p = buffer; p < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow_ = true;
+                if (pending_.empty()) firstEventMs_ = nowMs();
+                lastEventMs_ = nowMs();
+                continue;
+            }
+
+            fs::path dir;
+            {
+                std::lock_guard lock(watchMutex_);
+                auto it = watches_.find(event->wd);
+                if (it == watches_.end()) continue;
+                if (event->mask & IN_IGNORED) {
+                    watches_.erase(it);  // Directory deleted or unwatched
+                    continue;
+                }
+                dir = it->second;
+            }
+            if (event->len == 0) continue;  // About the directory itself
+
+            fs::path path = dir / event->name;
+            if (event->mask & IN_ISDIR) {
+                if (!options_.recursive) continue;
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    for (const auto& file : addTree(path)) {
+                        record(file, Change::Added);
+                    }
+                } else if (event->mask & (IN_MOVED_FROM | IN_DELETE)) {
+                    dropTree(path);
+                    record(path, Change::RemovedDir);
+                }
+            } else if (matches(event->name)) {
+                // Files count once they're closed after writing, not on create
+                if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    record(path, Change::Added);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    record(path, Change::Removed);
+                }
+            }
+        }
+    }
+}
+
+std::vector<fs::path> FileWatcher::addTree(const fs::path& dir) {
+    std::vector<fs::path> found;
+    std::mutex foundMutex;
+
+    // A new directory may already have files by the time its watch exists,
+    // so list it after watching; duplicates with the events are harmless
+    DirectoryScanner scanner({options_.extensions, true, 0});
+    scanner.scan(dir, [&](const fs::path& sub, std::vector<fs::path>& files) {
+        int wd = ::inotify_add_watch(fd_, sub.c_str(), WATCH_MASK | IN_DONT_FOLLOW);
+        if (wd >= 0) {
+            std::lock_guard lock(watchMutex_);
+            watches_[wd] = sub;
+        }
+        if (!files.empty()) {
+            std::lock_guard lock(foundMutex);
+            found.insert(found.end(), std::make_move_iterator(files.begin()),
+                         std::make_move_iterator(files.end()));
+        }
+    });
+
+    return found;
+}
+
+void FileWatcher::dropTree(const fs::path& dir) {
+    std::lock_guard lock(watchMutex_);
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        if (it->second == dir || within(it->second, dir)) {
+            ::inotify_rm_watch(fd_, it->first);
+            it = watches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileWatcher::record(const fs::path& path, Change change) {
+    i64 now = nowMs();
+    if (pending_.empty() && !overflow_) firstEventMs_ = now;
+    lastEventMs_ = now;
+
+    if (change == Change::RemovedDir) {
+        // Whatever happened inside it earlier in this batch no longer matters
+        std::erase_if(pending_, [&path](const auto& entry) { return within(entry.first, path); });
+    }
+    pending_[path] = change;  // Latest event for a path wins
+}
+
+void FileWatcher::flush() {
+    FileChanges changes;
+    changes.overflow = overflow_;
+    for (auto& [path, change] : pending_) {
+        switch (change) {
+            case Change::Added:      changes.added.push_back(path); break;
+            case Change::Removed:    changes.removed.push_back(path); break;
+            case Change::RemovedDir: changes.removedDirs.push_back(path); break;
+        }
+    }
+    pending_.clear();
+    overflow_ = false;
+
+    if (changes.overflow) {
+        LOG_WARN("File watcher queue overflowed, a rescan is needed");
+    } else {
+        LOG_DEBUG("File changes: {} added, {} removed, {} directories removed",
+                  changes.added.size(), changes.removed.size(), changes.removedDirs.size());
+    }
+    changed.emitSignal(changes);
+}
+
+bool FileWatcher::matches(const std::string& name) const {
+    if (options_.extensions.empty()) return true;
+
+    auto dot = name.rfind('.');
+    if (dot == std::string::npos) return false;
+
+    std::string ext = name.substr(dot);
+    for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return options_.extensions.contains(ext);
+}
+
+} // namespace vc
@@ -0,0 +1,104 @@
+#pragma once
+// FileWatcher.hpp - inotify-driven change feed for preset and music folders
+// Drop a preset in the folder mid-set, see it in the list. No rescan, no freeze.
+
+#include "Types.hpp"
+#include "Result.hpp"
+#include "Signal.hpp"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace vc {
+
+// One coalesced batch of changes. Apply removedDirs, then removed, then
+// added. A rename arrives as a removal plus an addition.
+struct FileChanges {
+    std::vector<fs::path> added;        // Written and closed, or moved in
+    std::vector<fs::path> removed;      // Deleted, or moved out
+    std::vector<fs::path> removedDirs;  // Moved out whole: drop everything under them
+    bool overflow{false};               // Kernel queue overflowed, only a full rescan is safe
+
+    bool empty() const {
+        return added.empty() && removed.empty() && removedDirs.empty() && !overflow;
+    }
+
+    // Whether an existing file is gone after this batch (removed, or under a removed dir)
+    bool isRemoved(const fs::path& path) const;
+};
+
+// Watches directory trees with inotify on a thread of its own. Events are
+// held until the tree has been quiet for a moment (or a batch has been
+// open for maxDelayMs), so unpacking a 10k-preset archive arrives as a
+// handful of batches, not 10k updates. New subdirectories are watched as
+// they appear and scanned for files that landed before the watch did.
+class FileWatcher {
+public:
+    struct Options {
+        std::set<std::string> extensions;   // Lowercase with dot; empty = all files
+        bool recursive{true};
+        u32 quietMs{250};                   // Flush once nothing has happened for this long
+        u32 maxDelayMs{1000};               // ...or once the oldest pending change is this old
+    };
+
+    explicit FileWatcher(Options options);
+    ~FileWatcher();
+
+    // Non-copyable
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    Result<void> start();
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Matching files under a root, sorted by path, from the initial walk
+    using Listed = std::function<void(std::vector<fs::path> files)>;
+
+    // Add a tree to watch; safe from any thread. The root is watched before
+    // this returns, the walk below it happens on the watcher thread, which
+    // then calls onListed (if set) with what it found. Watching a root twice
+    // only walks it again when there's an onListed to report to.
+    Result<void> watch(const fs::path& root, Listed onListed = {});
+    bool isWatching(const fs::path& root) const;
+
+    // Emitted from the watcher thread
+    Signal<const FileChanges&> changed;
+
+private:
+    enum class Change { Added, Removed, RemovedDir };
+
+    void run();
+    void readEvents();
+    void flush();
+    void addRoots();
+    std::vector<fs::path> addTree(const fs::path& dir);  // Watch everything under dir, return its files
+    void dropTree(const fs::path& dir);
+    void record(const fs::path& path, Change change);
+    bool matches(const std::string& name) const;
+
+    Options options_;
+    int fd_{-1};
+    int wakeFd_{-1};    // eventfd that interrupts poll() on stop and for new roots
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex watchMutex_;
+    std::map<int, fs::path> watches_;   // Watch descriptor -> directory
+    std::set<fs::path> roots_;
+    std::deque<std::pair<fs::path, Listed>> newRoots_;  // Waiting for the initial walk
+
+    // Watcher thread only
+    std::map<fs::path, Change> pending_;
+    bool overflow_{false};
+    i64 firstEventMs_{0};
+    i64 lastEventMs_{0};
+};
+
+} // namespace vc
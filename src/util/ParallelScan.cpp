@@ -0,0 +1,183 @@
+#include "ParallelScan.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+
+namespace vc {
+
+u32 workerCount(u32 requested) {
+    if (requested > 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(usize count, const std::function<void(usize, usize)>& fn, u32 threads) {
+    usize workers = std::min<usize>(workerCount(threads), count);
+    if (workers < 2) {
+        if (count > 0) fn(0, count);
+        return;
+    }
+
+    usize chunk = (count + workers - 1) / workers;
+    std::vector<std::jthread> pool;
+    pool.reserve(workers - 1);
+    for (usize begin = chunk; begin < count; begin += chunk) {
+        pool.emplace_back([&fn, begin, end = std::min(begin + chunk, count)] { fn(begin, end); });
+    }
+    fn(0, std::min(chunk, count));  // This thread takes the first chunk
+}
+
+namespace {
+
+struct WorkQueue {
+    std::deque<fs::path> dirs;
+    std::mutex mutex;
+};
+
+bool hasExtension(const char* name, const std::set<std::string>& extensions) {
+    if (extensions.empty()) return true;
+
+    const char* dot = std::strrchr(name, '.');
+    if (!dot) return false;
+
+    std::string ext(dot);
+    for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return extensions.contains(ext);
+}
+
+} // namespace
+
+DirectoryScanner::DirectoryScanner(Options options)
+    : options_(std::move(options))
+{
+}
+
+void DirectoryScanner::scan(const fs::path& root, const OnDirectory& onDirectory) {
+    usize workers = options_.recursive ? workerCount(options_.threads) : 1;
+    std::vector<WorkQueue> queues(workers);
+    queues[0].dirs.push_back(root);
+
+    // Directories queued or being listed; zero means the walk is over
+    std::atomic<usize> outstanding{1};
+    std::mutex idleMutex;
+    std::condition_variable idleCond;
+
+    auto take = [&](usize self, fs::path& out) {
+        {
+            // Own work: newest first, stays depth-first and cache-warm
+            std::lock_guard lock(queues[self].mutex);
+            if (!queues[self].dirs.empty()) {
+                out = std::move(queues[self].dirs.back());
+                queues[self].dirs.pop_back();
+                return true;
+            }
+        }
+        for (usize i = 1; i < workers; ++i) {
+            // Steal the oldest: near the root, likely the biggest subtree
+            auto& victim = queues[(self + i) % workers];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.dirs.empty()) {
+                out = std::move(victim.dirs.front());
+                victim.dirs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto listDir = [&](usize self, const fs::path& dir) {
+        std::vector<fs::path> files;
+
+        DIR* handle = ::opendir(dir.c_str());
+        if (handle) {
+            int dirFd = ::dirfd(handle);
+            while (dirent* entry = ::readdir(handle)) {
+                const char* name = entry->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                    continue;
+                }
+
+                unsigned char type = entry->d_type;
+                bool isLink = type == DT_LNK;
+                if (type == DT_UNKNOWN || isLink) {
+                    // Some filesystems don't fill d_type; symlinks to files count as files
+                    struct stat st{};
+                    if (::fstatat(dirFd, name, &st, 0) != 0) continue;
+                    type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+                }
+
+                if (type == DT_DIR) {
+                    if (options_.recursive && !isLink) {
+                        ++outstanding;
+                        {
+                            std::lock_guard lock(queues[self].mutex);
+                            queues[self].dirs.push_back(dir / name);
+                        }
+                        idleCond.notify_one();
+                    }
+                } else if (type == DT_REG && hasExtension(name, options_.extensions)) {
+                    files.push_back(dir / name);
+                }
+            }
+            ::closedir(handle);
+        }
+
+        onDirectory(dir, files);
+    };
+
+    auto worker = [&](usize self) {
+        fs::path dir;
+        while (true) {
+            if (take(self, dir)) {
+                listDir(self, dir);
+                if (--outstanding == 0) {
+                    std::lock_guard lock(idleMutex);
+                    idleCond.notify_all();
+                    return;
+                }
+                continue;
+            }
+
+            // Nothing to steal right now; others may still be listing
+            std::unique_lock lock(idleMutex);
+            if (outstanding == 0) return;
+            idleCond.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        pool.reserve(workers - 1);
+        for (usize i = 1; i < workers; ++i) {
+            pool.emplace_back(worker, i);
+        }
+        worker(0);
+    }
+}
+
+std::vector<fs::path> DirectoryScanner::files(const fs::path& root,
+                                              const std::set<std::string>& extensions,
+                                              bool recursive) {
+    std::vector<fs::path> result;
+    std::mutex mutex;
+
+    DirectoryScanner scanner({extensions, recursive, 0});
+    scanner.scan(root, [&](const fs::path&, std::vector<fs::path>& files) {
+        if (files.empty()) return;
+        std::lock_guard lock(mutex);
+        result.insert(result.end(), std::make_move_iterator(files.begin()),
+                      std::make_move_iterator(files.end()));
+    });
+
+    parallelSort(result, std::less<fs::path>());
+    return result;
+}
+
+} // namespace vc
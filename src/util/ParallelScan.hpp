@@ -0,0 +1,92 @@
+#pragma once
+// ParallelScan.hpp - Directory walking and bulk work across all cores
+// 50k presets on an NVMe drive and one thread doing the walking. No.
+
+#include "Types.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace vc {
+
+// Worker count for bulk work: the hardware threads, at least one
+u32 workerCount(u32 requested = 0);
+
+// fn(i) for i in [0, count), spread over workers in contiguous chunks.
+// Returns when all are done. Small counts just run inline.
+void parallelFor(usize count, const std::function<void(usize begin, usize end)>& fn,
+                 u32 threads = 0);
+
+// Sort chunks concurrently, then merge pairs of runs concurrently
+template<typename T, typename Compare>
+void parallelSort(std::vector<T>& items, Compare cmp, u32 threads = 0) {
+    constexpr usize MIN_CHUNK = 4096;
+    usize workers = std::min<usize>(workerCount(threads), items.size() / MIN_CHUNK);
+    if (workers < 2) {
+        std::sort(items.begin(), items.end(), cmp);
+        return;
+    }
+
+    usize chunk = (items.size() + workers - 1) / workers;
+    std::vector<usize> bounds;
+    for (usize b = 0; b < items.size(); b += chunk) bounds.push_back(b);
+    bounds.push_back(items.size());
+
+    parallelFor(bounds.size() - 1, [&](usize begin, usize end) {
+        for (usize r = begin; r < end; ++r) {
+            std::sort(items.begin() + bounds[r], items.begin() + bounds[r + 1], cmp);
+        }
+    }, static_cast<u32>(workers));
+
+    // Each pass halves the number of sorted runs
+    while (bounds.size() > 2) {
+        std::vector<usize> next;
+        usize pairs = (bounds.size() - 1) / 2;
+        parallelFor(pairs, [&](usize begin, usize end) {
+            for (usize p = begin; p < end; ++p) {
+                std::inplace_merge(items.begin() + bounds[p * 2], items.begin() + bounds[p * 2 + 1],
+                                   items.begin() + bounds[p * 2 + 2], cmp);
+            }
+        }, static_cast<u32>(workers));
+
+        for (usize i = 0; i < bounds.size(); i += 2) next.push_back(bounds[i]);
+        if (next.back() != items.size()) next.push_back(items.size());
+        bounds = std::move(next);
+    }
+}
+
+// Concurrent recursive directory walk. Each worker owns a deque of
+// directories; it pushes subdirectories onto its own and, when empty,
+// steals from the others' far end, so one huge subtree doesn't leave
+// the rest of the pool idle. Entry types come from readdir's d_type, so
+// a regular file costs no stat (only DT_UNKNOWN and symlinks get one).
+// Like recursive_directory_iterator, directory symlinks aren't followed.
+class DirectoryScanner {
+public:
+    struct Options {
+        std::set<std::string> extensions;   // Lowercase with dot; empty = all files
+        bool recursive{true};
+        u32 threads{0};                     // 0 = workerCount()
+    };
+
+    // Called from worker threads, concurrently, once per directory
+    // visited (including ones with no matches), with its matching files
+    using OnDirectory = std::function<void(const fs::path& dir, std::vector<fs::path>& files)>;
+
+    explicit DirectoryScanner(Options options);
+
+    void scan(const fs::path& root, const OnDirectory& onDirectory);
+
+    // All matching files under root, sorted by path
+    static std::vector<fs::path> files(const fs::path& root,
+                                       const std::set<std::string>& extensions,
+                                       bool recursive = true);
+
+private:
+    Options options_;
+};
+
+} // namespace vc
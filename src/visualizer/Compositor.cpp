@@ -0,0 +1,215 @@
+#include "Compositor.hpp"
+#include "ShaderCache.hpp"
+
+#include <QImage>
+#include <algorithm>
+#include <string>
+
+namespace vc {
+
+namespace {
+
+// Full-screen triangle from gl_VertexID, no vertex buffers needed
+constexpr const char* VERTEX_SHADER = R"(#version 330 core
+out vec2 uv;
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Overlay is a QImage, so top-down and straight (not premultiplied) alpha.
+// A scene rendered below output size is upscaled bilinearly, optionally with
+// a cross-shaped unsharp mask to win back some of the lost edge contrast.
+constexpr const char* FRAGMENT_SHADER = R"(#version 330 core
+in vec2 uv;
+out vec4 color;
+uniform sampler2D scene;
+uniform sampler2D overlay;
+uniform bool hasOverlay;
+uniform vec2 sceneTexel;
+uniform float sharpness;
+void main() {
+    vec3 rgb = texture(scene, uv).rgb;
+    if (sharpness > 0.0) {
+        vec3 blur = texture(scene, uv + vec2(sceneTexel.x, 0.0)).rgb
+                  + texture(scene, uv - vec2(sceneTexel.x, 0.0)).rgb
+                  + texture(scene, uv + vec2(0.0, sceneTexel.y)).rgb
+                  + texture(scene, uv - vec2(0.0, sceneTexel.y)).rgb;
+        rgb = clamp(rgb + (rgb - blur * 0.25) * sharpness, 0.0, 1.0);
+    }
+    if (hasOverlay) {
+        vec4 o = texture(overlay, vec2(uv.x, 1.0 - uv.y));
+        rgb = mix(rgb, o.rgb, o.a);
+    }
+    color = vec4(rgb, 1.0);
+}
+)";
+
+GLuint compileShader(GLenum type, const char* source, std::string& error) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        error = log;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
+Result<void> Compositor::init(ProgramBinaryCache* cache) {
+    if (program_) {
+        return Result<void>::ok();
+    }
+
+    if (cache) {
+        program_ = cache->load(VERTEX_SHADER, FRAGMENT_SHADER);
+    }
+
+    if (!program_) {
+        if (auto result = buildProgram(); !result) {
+            return result;
+        }
+        if (cache) {
+            cache->store(VERTEX_SHADER, FRAGMENT_SHADER, program_);
+        }
+    }
+
+    sceneLoc_ = glGetUniformLocation(program_, "scene");
+    overlayLoc_ = glGetUniformLocation(program_, "overlay");
+    hasOverlayLoc_ = glGetUniformLocation(program_, "hasOverlay");
+    sceneTexelLoc_ = glGetUniformLocation(program_, "sceneTexel");
+    sharpnessLoc_ = glGetUniformLocation(program_, "sharpness");
+
+    // Core profile refuses to draw without a VAO bound
+    glGenVertexArrays(1, &vao_);
+
+    glGenTextures(1, &overlayTexture_);
+    glBindTexture(GL_TEXTURE_2D, overlayTexture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return Result<void>::ok();
+}
+
+Result<void> Compositor::buildProgram() {
+    std::string error;
+    GLuint vs = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER, error);
+    if (!vs) {
+        return Result<void>::err("Compositor vertex shader: " + error);
+    }
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER, error);
+    if (!fs) {
+        glDeleteShader(vs);
+        return Result<void>::err("Compositor fragment shader: " + error);
+    }
+
+    program_ = glCreateProgram();
+    glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program_, vs);
+    glAttachShader(program_, fs);
+    glLinkProgram(program_);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program_, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024] = {};
+        glGetProgramInfoLog(program_, sizeof(log), nullptr, log);
+        shutdown();
+        return Result<void>::err(std::string("Compositor link: ") + log);
+    }
+    return Result<void>::ok();
+}
+
+void Compositor::shutdown() {
+    if (program_) {
+        glDeleteProgram(program_);
+        program_ = 0;
+    }
+    if (vao_) {
+        glDeleteVertexArrays(1, &vao_);
+        vao_ = 0;
+    }
+    if (overlayTexture_) {
+        glDeleteTextures(1, &overlayTexture_);
+        overlayTexture_ = 0;
+    }
+    overlayWidth_ = overlayHeight_ = 0;
+    hasOverlay_ = false;
+}
+
+void Compositor::updateOverlay(const QImage& image) {
+    if (!overlayTexture_ || image.isNull()) return;
+
+    u32 w = static_cast<u32>(image.width());
+    u32 h = static_cast<u32>(image.height());
+
+    glBindTexture(GL_TEXTURE_2D, overlayTexture_);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(image.bytesPerLine() / 4));
+    if (w != overlayWidth_ || h != overlayHeight_) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+        overlayWidth_ = w;
+        overlayHeight_ = h;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h,
+                        GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    hasOverlay_ = true;
+}
+
+void Compositor::composite(const RenderTarget& scene, RenderTarget& target) {
+    // Sharpening only pays off when upscaling; at 1:1 it would just add ringing
+    bool upscaled = scene.width() < target.width() || scene.height() < target.height();
+    f32 sharpness = upscaled ? sharpness_ : 0.0f;
+
+    target.bind();
+
+    // Every pixel is overwritten, no clear, no blending state needed
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_SCISSOR_TEST);
+
+    glUseProgram(program_);
+    glUniform1i(sceneLoc_, 0);
+    glUniform1i(overlayLoc_, 1);
+    glUniform1i(hasOverlayLoc_, hasOverlay_ ? 1 : 0);
+    glUniform2f(sceneTexelLoc_, 1.0f / std::max(scene.width(), 1u),
+                1.0f / std::max(scene.height(), 1u));
+    glUniform1f(sharpnessLoc_, sharpness);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, scene.texture());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, hasOverlay_ ? overlayTexture_ : 0);
+
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    target.unbind();
+}
+
+} // namespace vc
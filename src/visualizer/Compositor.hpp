@@ -0,0 +1,59 @@
+#pragma once
+// Compositor.hpp - ProjectM + overlay in one shader pass
+// Every full-screen copy we don't do is bandwidth the presets can have
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "RenderTarget.hpp"
+
+class QImage;
+
+namespace vc {
+
+class ProgramBinaryCache;
+
+class Compositor {
+public:
+    Compositor() = default;
+    ~Compositor() = default;  // GL objects go in shutdown(), with the context current
+
+    // Non-copyable
+    Compositor(const Compositor&) = delete;
+    Compositor& operator=(const Compositor&) = delete;
+
+    // GL context must be current. With a cache, the linked program is
+    // loaded from disk when possible and saved after a fresh compile.
+    Result<void> init(ProgramBinaryCache* cache = nullptr);
+    void shutdown();
+    bool isInitialized() const { return program_ != 0; }
+
+    // Upload a freshly rasterized overlay (top-down RGBA8888)
+    void updateOverlay(const QImage& image);
+    void clearOverlay() { hasOverlay_ = false; }
+
+    // Unsharp amount applied when the scene is smaller than the output, 0 = plain bilinear
+    void setSharpness(f32 amount) { sharpness_ = amount; }
+
+    // Sample the scene (scaled as needed) and blend the overlay on top,
+    // writing each output pixel exactly once
+    void composite(const RenderTarget& scene, RenderTarget& target);
+
+private:
+    Result<void> buildProgram();
+
+    GLuint program_{0};
+    GLuint vao_{0};
+    GLuint overlayTexture_{0};
+    u32 overlayWidth_{0};
+    u32 overlayHeight_{0};
+    bool hasOverlay_{false};
+    f32 sharpness_{0.0f};
+
+    GLint sceneLoc_{-1};
+    GLint overlayLoc_{-1};
+    GLint hasOverlayLoc_{-1};
+    GLint sceneTexelLoc_{-1};
+    GLint sharpnessLoc_{-1};
+};
+
+} // namespace vc
@@ -0,0 +1,104 @@
+#include "DynamicResolution.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vc {
+
+namespace {
+
+f32 quantize(f32 scale) {
+    return std::round(scale * 20.0f) / 20.0f;
+}
+
+} // namespace
+
+void ResolutionScaler::configure(const DynamicResolutionSettings& settings) {
+    settings_ = settings;
+    settings_.maxScale = std::clamp(settings_.maxScale, 0.25f, 1.0f);
+    settings_.minScale = std::clamp(settings_.minScale, 0.25f, settings_.maxScale);
+    reset();
+}
+
+void ResolutionScaler::reset() {
+    scale_ = settings_.maxScale;
+    gpuEma_ = cpuEma_ = 0.0f;
+    overFrames_ = underFrames_ = 0;
+    cooldown_ = COOLDOWN_FRAMES;
+}
+
+f32 ResolutionScaler::update(f32 cpuMs, f32 gpuMs, f32 periodMs) {
+    if (!settings_.enabled || periodMs <= 0.0f) {
+        return scale_;
+    }
+
+    auto smooth = [](f32& ema, f32 sample) {
+        ema = ema == 0.0f ? sample : ema + (sample - ema) * EMA_ALPHA;
+    };
+    smooth(cpuEma_, cpuMs);
+    if (gpuMs >= 0.0f) {
+        smooth(gpuEma_, gpuMs);
+    }
+
+    if (cooldown_ > 0) {
+        --cooldown_;
+        return scale_;
+    }
+
+    // Without timer queries the frame's CPU time is the best proxy we have
+    // (the driver blocks in it once the GPU falls behind)
+    f32 cost = gpuMs >= 0.0f ? gpuEma_ : cpuEma_;
+    f32 budget = periodMs * BUDGET;
+    if (cost <= 0.0f) {
+        return scale_;
+    }
+
+    if (cost > budget) {
+        underFrames_ = 0;
+        if (++overFrames_ < DOWN_FRAMES || scale_ <= settings_.minScale) {
+            return scale_;
+        }
+
+        // Cost follows pixel count, so area scales by budget/cost
+        f32 wanted = scale_ * std::sqrt(budget / cost);
+        f32 next = std::clamp(std::min(quantize(wanted), scale_ - STEP),
+                              settings_.minScale, settings_.maxScale);
+        LOG_DEBUG("Dynamic resolution: {:.2f} ms over {:.2f} ms budget, scale {:.0f}% -> {:.0f}%",
+                  cost, budget, scale_ * 100.0f, next * 100.0f);
+        f32 ratio = next / scale_;
+        gpuEma_ *= ratio * ratio;
+        scale_ = next;
+        overFrames_ = 0;
+        cooldown_ = COOLDOWN_FRAMES;
+        return scale_;
+    }
+
+    overFrames_ = 0;
+    if (scale_ >= settings_.maxScale) {
+        underFrames_ = 0;
+        return scale_;
+    }
+
+    // Only step up if the larger size is predicted to fit with room to
+    // spare; otherwise we'd oscillate between two sizes
+    f32 next = std::min(scale_ + STEP, settings_.maxScale);
+    f32 ratio = next / scale_;
+    if (cost * ratio * ratio > budget * UP_THRESHOLD) {
+        underFrames_ = 0;
+        return scale_;
+    }
+    if (++underFrames_ < UP_FRAMES) {
+        return scale_;
+    }
+
+    LOG_DEBUG("Dynamic resolution: headroom at {:.2f} ms, scale {:.0f}% -> {:.0f}%",
+              cost, scale_ * 100.0f, next * 100.0f);
+    gpuEma_ *= ratio * ratio;
+    scale_ = next;
+    underFrames_ = 0;
+    cooldown_ = COOLDOWN_FRAMES;
+    return scale_;
+}
+
+} // namespace vc
@@ -0,0 +1,58 @@
+#pragma once
+// DynamicResolution.hpp - Trade ProjectM pixels for a steady frame rate
+// Nobody counts pixels at a live show. Everybody notices a stutter.
+
+#include "util/Types.hpp"
+
+namespace vc {
+
+struct DynamicResolutionSettings {
+    bool enabled{true};
+    f32 minScale{0.5f};
+    f32 maxScale{1.0f};
+    bool whileRecording{true};  // Off for offline renders that want every pixel
+};
+
+class ResolutionScaler {
+public:
+    ResolutionScaler() = default;
+
+    void configure(const DynamicResolutionSettings& settings);
+    const DynamicResolutionSettings& settings() const { return settings_; }
+
+    // Once per frame with the CPU time of the whole frame, the latest GPU
+    // time of the ProjectM pass (negative if timer queries aren't
+    // available) and the frame period. Returns the scale for the next frame.
+    f32 update(f32 cpuMs, f32 gpuMs, f32 periodMs);
+
+    f32 scale() const { return scale_; }
+    f32 gpuMs() const { return gpuEma_; }
+
+    // Back to full (max) scale, e.g. when the controller is switched off
+    void reset();
+
+private:
+    DynamicResolutionSettings settings_;
+    f32 scale_{1.0f};
+
+    // Smoothed cost of the scaled pass and the hysteresis counters
+    f32 gpuEma_{0.0f};
+    f32 cpuEma_{0.0f};
+    u32 overFrames_{0};
+    u32 underFrames_{0};
+    u32 cooldown_{0};
+
+    // The ProjectM pass may use this much of a frame period; the rest is
+    // overlay, composite, readback and slack
+    static constexpr f32 BUDGET = 0.75f;
+    // Downscale after this many frames over budget, upscale after this
+    // many comfortably under it. Dropping is urgent, recovering is not.
+    static constexpr u32 DOWN_FRAMES = 6;
+    static constexpr u32 UP_FRAMES = 90;
+    static constexpr f32 UP_THRESHOLD = 0.6f;     // Of the budget, predicted after stepping up
+    static constexpr u32 COOLDOWN_FRAMES = 20;    // Let timings settle after a change
+    static constexpr f32 STEP = 0.05f;            // Scales are quantized to this
+    static constexpr f32 EMA_ALPHA = 0.15f;
+};
+
+} // namespace vc
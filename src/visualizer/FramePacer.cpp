@@ -0,0 +1,149 @@
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+namespace vc {
+
+namespace {
+
+// Fraction of the phase error corrected per swap; small, swap timestamps are noisy
+constexpr f64 PHASE_GAIN = 0.05;
+constexpr f64 MAX_PHASE_STEP_NS = 500000.0;
+
+f64 toNs(FramePacer::Clock::duration d) {
+    return static_cast<f64>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+} // namespace
+
+FramePacer::FramePacer() {
+    samples_.reserve(SAMPLE_COUNT);
+    start(fps_);
+}
+
+void FramePacer::start(u32 fps) {
+    std::lock_guard lock(mutex_);
+    fps_ = std::max(fps, 1u);
+    epoch_ = Clock::now();
+    frameIndex_ = 0;
+    haveLastFrame_ = false;
+}
+
+void FramePacer::setRate(u32 fps) {
+    fps = std::max(fps, 1u);
+    if (fps == fps_) return;
+
+    // Re-anchor on the current deadline so the switch doesn't skip or stall
+    std::lock_guard lock(mutex_);
+    epoch_ = deadlineAt(frameIndex_);
+    frameIndex_ = 0;
+    fps_ = fps;
+    locked_ = false;
+}
+
+void FramePacer::beginFrame() {
+    auto now = Clock::now();
+
+    std::lock_guard lock(mutex_);
+    if (haveLastFrame_) {
+        f32 ms = static_cast<f32>(toNs(now - lastFrame_) / 1000000.0);
+        if (samples_.size() < SAMPLE_COUNT) {
+            samples_.push_back(ms);
+        } else {
+            samples_[sampleHead_] = ms;
+            sampleHead_ = (sampleHead_ + 1) % SAMPLE_COUNT;
+        }
+    }
+    lastFrame_ = now;
+    haveLastFrame_ = true;
+}
+
+FramePacer::Clock::time_point FramePacer::nextDeadline() {
+    std::lock_guard lock(mutex_);
+
+    auto deadline = deadlineAt(++frameIndex_);
+    auto now = Clock::now();
+    if (deadline + period() < now) {
+        ++missed_;
+        epoch_ = now;
+        frameIndex_ = 0;
+        deadline = now;
+    }
+    return deadline;
+}
+
+void FramePacer::notePresent(Clock::time_point when) {
+    std::lock_guard lock(mutex_);
+
+    if (lastPresent_ != Clock::time_point{}) {
+        f64 interval = toNs(when - lastPresent_);
+        // Ignore gaps from hidden windows and stalls
+        if (interval > 0.0 && interval < 100000000.0) {
+            refreshNs_ = refreshNs_ > 0.0 ? refreshNs_ * 0.9 + interval * 0.1 : interval;
+        }
+    }
+    lastPresent_ = when;
+
+    f64 periodNs = toNs(period());
+    locked_ = vsyncAlign_ && refreshNs_ > 0.0 &&
+              std::abs(refreshNs_ - periodNs) < periodNs * 0.02;
+    if (!locked_) return;
+
+    // Where the swap falls within our frame grid; steer it to mid-period
+    f64 phase = std::fmod(toNs(when - epoch_), periodNs);
+    if (phase < 0.0) phase += periodNs;
+    f64 error = phase - periodNs * 0.5;
+
+    f64 step = std::clamp(error * PHASE_GAIN, -MAX_PHASE_STEP_NS, MAX_PHASE_STEP_NS);
+    epoch_ += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(static_cast<i64>(step)));
+}
+
+FrameTimeStats FramePacer::stats() const {
+    std::vector<f32> sorted;
+    FrameTimeStats stats;
+    {
+        std::lock_guard lock(mutex_);
+        sorted = samples_;
+        stats.missedDeadlines = missed_;
+        stats.vsyncLocked = locked_;
+    }
+
+    if (sorted.empty()) return stats;
+
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](f64 p) {
+        return sorted[static_cast<usize>(std::lround(p * (sorted.size() - 1)))];
+    };
+
+    stats.samples = static_cast<u32>(sorted.size());
+    stats.avgMs = std::accumulate(sorted.begin(), sorted.end(), 0.0f) / sorted.size();
+    stats.fps = stats.avgMs > 0.0f ? 1000.0f / stats.avgMs : 0.0f;
+    stats.p50Ms = at(0.50);
+    stats.p95Ms = at(0.95);
+    stats.p99Ms = at(0.99);
+    stats.maxMs = sorted.back();
+    return stats;
+}
+
+void FramePacer::spinUntil(Clock::time_point deadline) {
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+FramePacer::Clock::duration FramePacer::period() const {
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(1000000000LL / fps_));
+}
+
+FramePacer::Clock::time_point FramePacer::deadlineAt(u64 index) const {
+    // From the epoch each time, so rounding never accumulates
+    return epoch_ + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(static_cast<i64>(index * 1000000000ULL / fps_)));
+}
+
+} // namespace vc
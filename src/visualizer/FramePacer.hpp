@@ -0,0 +1,87 @@
+#pragma once
+// FramePacer.hpp - Frame deadlines from a steady clock
+// 1000 / 60 is 16, and 16 ms is not 60 fps
+
+#include "util/Types.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace vc {
+
+struct FrameTimeStats {
+    f32 fps{0.0f};              // Mean over the sample window
+    f32 avgMs{0.0f};
+    f32 p50Ms{0.0f};
+    f32 p95Ms{0.0f};
+    f32 p99Ms{0.0f};
+    f32 maxMs{0.0f};
+    u32 samples{0};
+    u64 missedDeadlines{0};     // Frames that started a full period late
+    bool vsyncLocked{false};
+    f32 renderScale{1.0f};      // ProjectM resolution relative to output, filled in by the render thread
+};
+
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Sleep until this close to a deadline, spin the rest.
+    // Covers typical scheduler wakeup latency.
+    static constexpr auto SPIN_WINDOW = std::chrono::microseconds(1000);
+
+    FramePacer();
+
+    // Restart the schedule from now
+    void start(u32 fps);
+
+    // Change rate without restarting the phase
+    void setRate(u32 fps);
+    u32 rate() const { return fps_; }
+
+    // Call as a frame starts; records the interval since the previous one
+    void beginFrame();
+
+    // Deadline for the next frame. If we're a full period late the schedule
+    // restarts from now instead of bursting to catch up.
+    Clock::time_point nextDeadline();
+
+    // Present feedback (buffer swaps). When the render rate matches the
+    // display's, frames are phase-locked half a refresh away from the swap
+    // so they never land right on the sampling point and beat against it.
+    void setVsyncAlign(bool enabled) { vsyncAlign_ = enabled; }
+    void notePresent(Clock::time_point when);
+
+    // Thread-safe snapshot of the last SAMPLE_COUNT frame intervals
+    FrameTimeStats stats() const;
+
+    // Burn the last bit of time before a deadline
+    static void spinUntil(Clock::time_point deadline);
+
+private:
+    Clock::duration period() const;
+    Clock::time_point deadlineAt(u64 index) const;
+
+    u32 fps_{60};
+    Clock::time_point epoch_;
+    u64 frameIndex_{0};
+
+    Clock::time_point lastFrame_;
+    bool haveLastFrame_{false};
+    u64 missed_{0};
+
+    // Present feedback
+    bool vsyncAlign_{true};
+    Clock::time_point lastPresent_;
+    f64 refreshNs_{0.0};        // Smoothed swap interval
+    bool locked_{false};
+
+    mutable std::mutex mutex_;  // Guards samples and the epoch (notePresent runs on the GUI thread)
+    std::vector<f32> samples_;  // Ring buffer, ms
+    usize sampleHead_{0};
+
+    static constexpr usize SAMPLE_COUNT = 600;
+};
+
+} // namespace vc
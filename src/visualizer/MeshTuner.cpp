@@ -0,0 +1,143 @@
+#include "MeshTuner.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace vc {
+
+void MeshTuner::configure(bool enabled, MeshSize max, u32 fps, u32 transitionSec) {
+    enabled_ = enabled;
+    max_ = {std::max(max.x, 8u), std::max(max.y, 6u)};
+    fps_ = std::max(fps, 1u);
+    transitionSec_ = transitionSec;
+    level_ = 0;
+}
+
+void MeshTuner::setFps(u32 fps) {
+    fps_ = std::max(fps, 1u);
+}
+
+Result<void> MeshTuner::load(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return Result<void>::ok();  // Nothing tuned yet
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        MeshSize size;
+        auto space = line.find(' ');
+        if (space == std::string::npos ||
+            std::sscanf(line.c_str(), "%ux%u", &size.x, &size.y) != 2) {
+            continue;
+        }
+        tuned_[line.substr(space + 1)] = size;
+    }
+    return Result<void>::ok();
+}
+
+Result<void> MeshTuner::save(const fs::path& path) {
+    if (!dirty_) {
+        return Result<void>::ok();
+    }
+
+    std::ofstream file(path);
+    if (!file) {
+        return Result<void>::err("Failed to open " + path.string() + " for writing");
+    }
+
+    file << "# ProjectM mesh size per preset, tuned from render time\n";
+    for (const auto& [key, size] : tuned_) {
+        file << size.x << 'x' << size.y << ' ' << key << '\n';
+    }
+    dirty_ = false;
+    return Result<void>::ok();
+}
+
+MeshSize MeshTuner::beginPreset(const std::string& key) {
+    preset_ = key;
+    level_ = 0;
+
+    // Map the remembered size onto the current ladder, so changing the
+    // configured mesh doesn't hand out sizes above it
+    if (auto it = tuned_.find(key); enabled_ && it != tuned_.end()) {
+        while (level_ + 1 < LEVELS && sizeFor(level_).x > it->second.x) {
+            ++level_;
+        }
+    }
+
+    settle_ = fps_ * (transitionSec_ + 1);
+    ema_ = 0.0f;
+    overFrames_ = underFrames_ = 0;
+    return size();
+}
+
+bool MeshTuner::update(f32 renderMs) {
+    if (!enabled_ || preset_.empty()) return false;
+
+    if (settle_ > 0) {
+        --settle_;
+        return false;
+    }
+
+    ema_ = ema_ == 0.0f ? renderMs : ema_ + (renderMs - ema_) * EMA_ALPHA;
+
+    f32 period = 1000.0f / fps_;
+    if (ema_ > period * BUDGET) {
+        underFrames_ = 0;
+        if (++overFrames_ < DOWN_FRAMES || level_ + 1 >= LEVELS) {
+            return false;
+        }
+
+        ++level_;
+        LOG_DEBUG("Mesh tuner: {} at {:.2f} ms, mesh down to {}x{}",
+                  preset_, ema_, size().x, size().y);
+    } else {
+        overFrames_ = 0;
+        if (level_ == 0) {
+            return false;
+        }
+
+        // Equations run per vertex, so cost follows mesh area
+        f32 ratio = LADDER[level_ - 1] / LADDER[level_];
+        if (ema_ * ratio * ratio > period * UP_THRESHOLD) {
+            underFrames_ = 0;
+            return false;
+        }
+        if (++underFrames_ < UP_FRAMES) {
+            return false;
+        }
+
+        --level_;
+        LOG_DEBUG("Mesh tuner: {} at {:.2f} ms, mesh up to {}x{}",
+                  preset_, ema_, size().x, size().y);
+    }
+
+    // New mesh, new cost: measure again from scratch
+    settle_ = fps_ / 2;
+    ema_ = 0.0f;
+    overFrames_ = underFrames_ = 0;
+    remember();
+    return true;
+}
+
+MeshSize MeshTuner::sizeFor(u32 level) const {
+    f32 f = LADDER[std::min(level, LEVELS - 1)];
+    return {std::max(8u, static_cast<u32>(max_.x * f)),
+            std::max(6u, static_cast<u32>(max_.y * f))};
+}
+
+void MeshTuner::remember() {
+    if (level_ == 0) {
+        dirty_ |= tuned_.erase(preset_) > 0;
+        return;
+    }
+    tuned_[preset_] = size();
+    dirty_ = true;
+}
+
+} // namespace vc
@@ -0,0 +1,77 @@
+#pragma once
+// MeshTuner.hpp - Per-preset mesh density from measured render cost
+// 12288 per-vertex equations a frame is fine until it isn't
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace vc {
+
+struct MeshSize {
+    u32 x{128};
+    u32 y{96};
+};
+
+// Render thread only. Watches the CPU time ProjectM spends per frame (the
+// per-vertex equations scale with mesh size) and steps the mesh down a
+// ladder when a preset is too expensive, back up when there's headroom.
+// The level that worked is remembered per preset.
+class MeshTuner {
+public:
+    MeshTuner() = default;
+
+    // max is the configured mesh, the top of the ladder
+    void configure(bool enabled, MeshSize max, u32 fps, u32 transitionSec);
+    void setFps(u32 fps);
+    bool enabled() const { return enabled_; }
+
+    // Remembered sizes, "<x>x<y> <preset key>" per line (PresetManager::keyOf)
+    Result<void> load(const fs::path& path);
+    Result<void> save(const fs::path& path);
+
+    // A preset is about to load: returns its mesh and starts a settling
+    // period (soft cuts run both presets, so those frames don't count)
+    MeshSize beginPreset(const std::string& key);
+
+    // CPU milliseconds spent in ProjectM's render call this frame.
+    // True when the mesh should change to size().
+    bool update(f32 renderMs);
+
+    MeshSize size() const { return sizeFor(level_); }
+
+private:
+    MeshSize sizeFor(u32 level) const;
+    void remember();
+
+    bool enabled_{false};
+    MeshSize max_;
+    u32 fps_{60};
+    u32 transitionSec_{3};
+
+    std::string preset_;
+    u32 level_{0};          // 0 = full mesh
+    u32 settle_{0};
+    f32 ema_{0.0f};
+    u32 overFrames_{0};
+    u32 underFrames_{0};
+
+    std::unordered_map<std::string, MeshSize> tuned_;
+    bool dirty_{false};
+
+    // Mesh dimensions relative to the configured size, per level
+    static constexpr f32 LADDER[] = {1.0f, 0.75f, 0.5f, 0.375f, 0.25f};
+    static constexpr u32 LEVELS = sizeof(LADDER) / sizeof(LADDER[0]);
+
+    // ProjectM's CPU share of a frame period before we step down, and the
+    // predicted share that has to fit before stepping back up
+    static constexpr f32 BUDGET = 0.5f;
+    static constexpr f32 UP_THRESHOLD = 0.3f;
+    static constexpr u32 DOWN_FRAMES = 30;
+    static constexpr u32 UP_FRAMES = 300;
+    static constexpr f32 EMA_ALPHA = 0.1f;
+};
+
+} // namespace vc
@@ -0,0 +1,136 @@
+#include "PresetCensus.hpp"
+#include "core/Logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+namespace vc {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+f32 elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<f32, std::milli>(Clock::now() - since).count();
+}
+
+} // namespace
+
+Result<void> PresetCensus::run(const std::vector<fs::path>& presets, const CensusOptions& options) {
+    cancelled_ = false;
+
+    RenderTarget target;
+    if (auto result = target.create(options.width, options.height); !result) {
+        return result;
+    }
+
+    // Long enough that no preset sees the clip loop within its frames
+    auto clip = referenceClip(SAMPLE_RATE, (options.frames + 1.0f) / std::max(options.fps, 1u) + 1.0f);
+
+    for (usize i = 0; i < presets.size() && !cancelled_; ++i) {
+        // A fresh instance per preset: no state or transition carried over,
+        // and a preset that wedges projectM can't poison the rest
+        projectm_handle pm = projectm_create();
+        if (!pm) {
+            return Result<void>::err("Failed to create ProjectM instance");
+        }
+        projectm_set_window_size(pm, options.width, options.height);
+        projectm_set_fps(pm, options.fps);
+        projectm_set_mesh_size(pm, options.meshX, options.meshY);
+        projectm_set_preset_locked(pm, true);
+
+        auto cost = measure(pm, target, presets[i], options, clip);
+        projectm_destroy(pm);
+
+        measured.emitSignal(presets[i], cost, i, presets.size());
+    }
+
+    target.destroy();
+    return cancelled_ ? Result<void>::err("Preset census cancelled") : Result<void>::ok();
+}
+
+PresetCost PresetCensus::measure(projectm_handle pm, RenderTarget& target, const fs::path& path,
+                                 const CensusOptions& options, const std::vector<f32>& clip) {
+    const usize frameSamples = SAMPLE_RATE / std::max(options.fps, 1u);
+    usize cursor = 0;
+
+    auto renderOne = [&] {
+        // Interleaved stereo: two floats per sample frame
+        usize count = std::min(frameSamples * 2, clip.size() - cursor);
+        projectm_pcm_add_float(pm, clip.data() + cursor, count / 2, PROJECTM_STEREO);
+        cursor = (cursor + count) % clip.size();
+
+        target.bind();
+        projectm_opengl_render_frame(pm);
+        target.unbind();
+        glFinish();
+    };
+
+    PresetCost cost;
+    cost.width = options.width;
+    cost.height = options.height;
+
+    // Shaders may only be built on first draw, so compile time covers both
+    auto start = Clock::now();
+    projectm_load_preset_file(pm, path.c_str(), false);
+    renderOne();
+    cost.compileMs = elapsedMs(start);
+
+    std::vector<f32> times;
+    times.reserve(options.frames);
+    for (u32 f = 0; f < options.frames && !cancelled_; ++f) {
+        auto frameStart = Clock::now();
+        renderOne();
+        times.push_back(elapsedMs(frameStart));
+    }
+
+    if (!times.empty()) {
+        cost.avgFrameMs = std::accumulate(times.begin(), times.end(), 0.0f) / times.size();
+        auto p99 = times.begin() + static_cast<std::ptrdiff_t>((times.size() - 1) * 99 / 100);
+        std::nth_element(times.begin(), p99, times.end());
+        cost.p99FrameMs = *p99;
+    }
+
+    return cost;
+}
+
+std::vector<f32> PresetCensus::referenceClip(u32 sampleRate, f32 seconds) {
+    const usize frames = static_cast<usize>(sampleRate * seconds);
+    const f32 beat = 0.5f;  // 120 BPM
+    constexpr f32 twoPi = 2.0f * std::numbers::pi_v<f32>;
+    constexpr f32 bassNotes[] = {55.0f, 55.0f, 65.41f, 49.0f};  // A1 A1 C2 G1
+
+    std::vector<f32> pcm(frames * 2);
+    u32 noise = 0x9E3779B9u;  // Fixed seed, same clip everywhere
+
+    for (usize i = 0; i < frames; ++i) {
+        f32 t = static_cast<f32>(i) / sampleRate;
+        f32 inBeat = std::fmod(t, beat);
+        usize beatIndex = static_cast<usize>(t / beat);
+
+        // Kick: pitch-dropping sine with a fast decay
+        f32 kickFreq = 50.0f + 100.0f * std::exp(-inBeat * 30.0f);
+        f32 kick = std::sin(twoPi * kickFreq * inBeat) * std::exp(-inBeat * 8.0f);
+
+        // Bass on the beat's note
+        f32 bass = 0.4f * std::sin(twoPi * bassNotes[beatIndex % 4] * t);
+
+        // Hats on the off-beats: xorshift noise, short decay
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        f32 white = static_cast<f32>(noise) / 4294967295.0f * 2.0f - 1.0f;
+        f32 inOffbeat = std::fmod(t + beat / 2, beat);
+        f32 hat = 0.25f * white * std::exp(-inOffbeat * 40.0f);
+
+        f32 mix = 0.6f * kick + bass + hat;
+        pcm[i * 2] = mix;
+        pcm[i * 2 + 1] = mix * 0.9f + hat * 0.1f;  // A little stereo width
+    }
+    return pcm;
+}
+
+} // namespace vc
@@ -0,0 +1,53 @@
+#pragma once
+// PresetCensus.hpp - Time every preset offscreen, once, properly
+// Some presets cost 0.3 ms. Some cost 40. Better to know before the drop.
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "util/Signal.hpp"
+#include "PresetManager.hpp"
+#include "RenderTarget.hpp"
+#include "projectM-4/projectM.h"
+
+#include <atomic>
+#include <vector>
+
+namespace vc {
+
+struct CensusOptions {
+    u32 width{1920};
+    u32 height{1080};
+    u32 fps{60};
+    u32 frames{240};            // Measured frames per preset, after the first
+    u32 meshX{128};
+    u32 meshY{96};
+};
+
+// Blocking, on the calling thread, with a GL context current. Each preset
+// is loaded hard (no transition) into a fresh instance, fed the same
+// synthetic reference clip, and every frame is glFinish'd so the times
+// include the GPU.
+class PresetCensus {
+public:
+    PresetCensus() = default;
+
+    Result<void> run(const std::vector<fs::path>& presets, const CensusOptions& options);
+    void cancel() { cancelled_ = true; }
+
+    // During run(): the preset just measured, with its index and the total
+    Signal<const fs::path&, const PresetCost&, usize, usize> measured;
+
+    // Deterministic stand-in for a music clip: 120 BPM kick, a bass line
+    // and noise hats, so every machine measures against the same input.
+    // Interleaved stereo.
+    static std::vector<f32> referenceClip(u32 sampleRate, f32 seconds);
+    static constexpr u32 SAMPLE_RATE = 44100;
+
+private:
+    PresetCost measure(projectm_handle pm, RenderTarget& target, const fs::path& path,
+                       const CensusOptions& options, const std::vector<f32>& clip);
+
+    std::atomic<bool> cancelled_{false};
+};
+
+} // namespace vc
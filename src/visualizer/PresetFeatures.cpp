@@ -0,0 +1,156 @@
+#include "PresetFeatures.hpp"
+#include "util/FileUtils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <set>
+#include <string>
+
+namespace vc {
+
+namespace {
+
+constexpr usize MAX_CUSTOM = 4;  // MilkDrop 2 has waves and shapes 0-3
+
+// Samplers MilkDrop provides itself; anything else names a texture file
+constexpr std::array BUILTIN_SAMPLERS = {
+    "main", "fc_main", "pc_main", "fw_main", "pw_main", "noise_lq", "noise_lq_lite",
+    "noise_mq", "noise_hq", "noisevol_lq", "noisevol_hq", "blur1", "blur2", "blur3",
+};
+
+bool startsWith(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+// "wavecode_2_enabled" -> 2 for prefix "wavecode_", or MAX_CUSTOM if malformed
+usize customIndex(std::string_view key, std::string_view prefix) {
+    usize index = MAX_CUSTOM;
+    auto digits = key.substr(prefix.size());
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), index);
+    return ec == std::errc() && index < MAX_CUSTOM ? index : MAX_CUSTOM;
+}
+
+bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+void scanShader(std::string_view line, PresetFeatures& f, std::set<std::string>& textures) {
+    f.shaderBytes += static_cast<u32>(line.size());
+
+    if (line.find("GetBlur") != std::string_view::npos) {
+        f.blur = true;
+    }
+
+    for (usize pos = line.find("sampler_"); pos != std::string_view::npos;
+         pos = line.find("sampler_", pos + 1)) {
+        if (pos > 0 && isIdentChar(line[pos - 1])) continue;  // e.g. "mysampler_x"
+        usize end = pos + 8;
+        while (end < line.size() && isIdentChar(line[end])) ++end;
+
+        std::string name(line.substr(pos + 8, end - pos - 8));
+        if (name.empty()) continue;
+        if (startsWith(name, "blur")) f.blur = true;
+        if (std::find(BUILTIN_SAMPLERS.begin(), BUILTIN_SAMPLERS.end(), name) == BUILTIN_SAMPLERS.end()) {
+            textures.insert(std::move(name));
+        }
+    }
+}
+
+} // namespace
+
+PresetFeatures extractFeatures(std::string_view source) {
+    PresetFeatures f;
+    std::set<std::string> textures;
+    std::array<bool, MAX_CUSTOM> shapeEnabled{};
+    std::array<u32, MAX_CUSTOM> shapeInstances{};
+    std::array<bool, MAX_CUSTOM> waveEnabled{};
+    std::array<u32, MAX_CUSTOM> wavePointLines{};
+
+    auto bump = [](u16& counter) { if (counter < 0xFFFF) ++counter; };
+
+    while (!source.empty()) {
+        usize eol = source.find('\n');
+        std::string_view line = source.substr(0, eol);
+        source = eol == std::string_view::npos ? std::string_view() : source.substr(eol + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+        usize eq = line.find('=');
+        if (eq == std::string_view::npos) continue;
+        std::string_view key = line.substr(0, eq);
+        std::string_view value = line.substr(eq + 1);
+
+        if (startsWith(key, "per_frame_")) {
+            bump(f.perFrameLines);
+        } else if (startsWith(key, "per_pixel_")) {
+            bump(f.perPixelLines);
+            f.perPixelBytes += static_cast<u32>(value.size());
+        } else if (startsWith(key, "warp_")) {
+            f.warpShader = true;
+            scanShader(value, f, textures);
+        } else if (startsWith(key, "comp_")) {
+            f.compShader = true;
+            scanShader(value, f, textures);
+        } else if (startsWith(key, "wavecode_")) {
+            usize i = customIndex(key, "wavecode_");
+            if (i < MAX_CUSTOM && key.ends_with("_enabled")) {
+                waveEnabled[i] = value.starts_with('1');
+            }
+        } else if (startsWith(key, "wave_")) {
+            usize i = customIndex(key, "wave_");
+            if (i < MAX_CUSTOM && key.find("_per_point") != std::string_view::npos) {
+                ++wavePointLines[i];
+            }
+        } else if (startsWith(key, "shapecode_")) {
+            usize i = customIndex(key, "shapecode_");
+            if (i >= MAX_CUSTOM) continue;
+            if (key.ends_with("_enabled")) {
+                shapeEnabled[i] = value.starts_with('1');
+            } else if (key.ends_with("_num_inst")) {
+                u32 count = 1;
+                std::from_chars(value.data(), value.data() + value.size(), count);
+                shapeInstances[i] = std::clamp(count, 1u, 1024u);
+            }
+        }
+    }
+
+    for (usize i = 0; i < MAX_CUSTOM; ++i) {
+        if (waveEnabled[i]) {
+            bump(f.waves);
+            f.wavePointLines = static_cast<u16>(std::min<u32>(f.wavePointLines + wavePointLines[i], 0xFFFF));
+        }
+        if (shapeEnabled[i]) {
+            bump(f.shapes);
+            f.shapeInstances = static_cast<u16>(
+                std::min<u32>(f.shapeInstances + std::max(shapeInstances[i], 1u), 0xFFFF));
+        }
+    }
+    f.textures = static_cast<u16>(std::min<usize>(textures.size(), 0xFFFF));
+    f.parsed = true;
+
+    // Rough weights, in units of "a plain preset": per-vertex code runs
+    // over the whole mesh, per-point code over every sample of a wave,
+    // shaders over every pixel (longer ones cost more), and each blur
+    // level is another full-screen pass
+    f32 cost = 1.0f;
+    cost += f.perPixelLines * 0.15f + f.perPixelBytes / 2000.0f;
+    cost += f.waves * 0.2f + f.wavePointLines * 0.1f;
+    cost += f.shapeInstances * 0.02f;
+    cost += f.warpShader ? 1.0f : 0.0f;
+    cost += f.compShader ? 1.0f : 0.0f;
+    cost += f.shaderBytes / 3000.0f;
+    cost += f.blur ? 1.5f : 0.0f;
+    cost += f.textures * 0.25f;
+    f.cost = cost;
+
+    return f;
+}
+
+PresetFeatures readFeatures(const fs::path& path) {
+    auto text = file::readText(path);
+    if (!text) return {};
+    return extractFeatures(*text);
+}
+
+} // namespace vc
@@ -0,0 +1,37 @@
+#pragma once
+// PresetFeatures.hpp - What's inside a .milk file, without rendering it
+// Counting the equations is cheaper than finding out the hard way
+
+#include "util/Types.hpp"
+
+#include <string_view>
+
+namespace vc {
+
+// Read once per preset and kept in the preset index, so trivially copyable
+struct PresetFeatures {
+    u16 perFrameLines{0};       // per_frame_ and per_frame_init_ equations
+    u16 perPixelLines{0};       // Run for every mesh vertex, every frame
+    u32 perPixelBytes{0};
+    u16 waves{0};               // Enabled custom waves
+    u16 wavePointLines{0};      // Run for every sample of every enabled wave
+    u16 shapes{0};              // Enabled custom shapes
+    u16 shapeInstances{0};      // Sum of num_inst over enabled shapes
+    u32 shaderBytes{0};         // Warp plus composite shader source
+    u16 textures{0};            // Distinct user textures sampled by the shaders
+    bool warpShader{false};
+    bool compShader{false};
+    bool blur{false};           // Shaders read the blur passes, each an extra render
+    bool parsed{false};         // False when the file couldn't be read
+    f32 cost{0.0f};             // Estimated relative cost, ~1 for a plain preset
+
+    // Worth keeping away from another heavy preset
+    static constexpr f32 HEAVY_COST = 6.0f;
+    bool heavy() const { return parsed && cost >= HEAVY_COST; }
+};
+
+// Line-based scan of preset source; nothing is compiled or evaluated
+PresetFeatures extractFeatures(std::string_view source);
+PresetFeatures readFeatures(const fs::path& path);
+
+} // namespace vc
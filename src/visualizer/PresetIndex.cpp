@@ -0,0 +1,346 @@
+#include "PresetIndex.hpp"
+#include "core/Logger.hpp"
+#include "util/FileUtils.hpp"
+#include "util/ParallelScan.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace vc {
+
+namespace {
+
+// On-disk layout, native endianness (it's a cache, not an interchange format):
+//   Header | DirRecord[dirCount] | PresetRecord[presetCount] | string blob
+// Strings are (offset, length) into the blob. Preset records are grouped
+// by directory, in directory order.
+constexpr char INDEX_MAGIC[4] = {'V', 'C', 'P', 'I'};
+
+struct Header {
+    char magic[4];
+    u32 version;
+    u64 rootHash;
+    u32 dirCount;
+    u32 presetCount;
+    u64 stringsSize;
+};
+
+struct StringRef {
+    u32 offset;
+    u32 length;
+};
+
+struct DirRecord {
+    StringRef path;     // Relative to root
+    i64 mtime;
+    u32 presetCount;
+    u32 flags;          // Reserved
+};
+
+struct PresetRecord {
+    StringRef file;     // File name within its directory
+    StringRef author;
+    PresetFeatures features;
+};
+static_assert(std::is_trivially_copyable_v<PresetFeatures>);
+
+u64 hashPath(const fs::path& path) {
+    u64 hash = 14695981039346656037ull;
+    for (unsigned char c : path.string()) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+i64 mtimeOf(const fs::path& path, std::error_code& ec) {
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<i64>(time.time_since_epoch().count());
+}
+
+// Read-only mapping, unmapped on scope exit
+class MappedFile {
+public:
+    explicit MappedFile(const fs::path& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const u8*>(data);
+                size_ = static_cast<usize>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) {
+            ::munmap(const_cast<u8*>(data_), size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const u8* data() const { return data_; }
+    usize size() const { return size_; }
+
+private:
+    const u8* data_{nullptr};
+    usize size_{0};
+};
+
+} // namespace
+
+PresetIndex::PresetIndex(fs::path root, bool recursive)
+    : root_(std::move(root))
+    , recursive_(recursive)
+{
+}
+
+bool PresetIndex::load(const fs::path& file) {
+    dirs_.clear();
+
+    MappedFile map(file);
+    if (!map.data() || map.size() < sizeof(Header)) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, map.data(), sizeof(header));
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        header.version != VERSION || header.rootHash != rootKey()) {
+        return false;
+    }
+
+    usize dirsAt = sizeof(Header);
+    usize presetsAt = dirsAt + header.dirCount * sizeof(DirRecord);
+    usize stringsAt = presetsAt + header.presetCount * sizeof(PresetRecord);
+    if (stringsAt + header.stringsSize != map.size()) {
+        LOG_WARN("Preset index {} is truncated, rebuilding", file.string());
+        return false;
+    }
+
+    const char* strings = reinterpret_cast<const char*>(map.data() + stringsAt);
+    auto str = [&](StringRef ref) -> std::string_view {
+        if (static_cast<u64>(ref.offset) + ref.length > header.stringsSize) return {};
+        return {strings + ref.offset, ref.length};
+    };
+
+    usize preset = 0;
+    for (u32 d = 0; d < header.dirCount; ++d) {
+        DirRecord dirRec;
+        std::memcpy(&dirRec, map.data() + dirsAt + d * sizeof(DirRecord), sizeof(dirRec));
+        if (preset + dirRec.presetCount > header.presetCount) {
+            dirs_.clear();
+            return false;
+        }
+
+        std::string rel(str(dirRec.path));
+        Dir& dir = dirs_[rel];
+        dir.mtime = dirRec.mtime;
+        dir.presets.reserve(dirRec.presetCount);
+
+        fs::path dirPath = rel == "." ? root_ : root_ / rel;
+        std::string cat = category(rel);
+        for (u32 p = 0; p < dirRec.presetCount; ++p, ++preset) {
+            PresetRecord rec;
+            std::memcpy(&rec, map.data() + presetsAt + preset * sizeof(PresetRecord), sizeof(rec));
+
+            PresetInfo info;
+            info.path = dirPath / str(rec.file);
+            info.name = info.path.stem().string();
+            info.author = str(rec.author);
+            info.features = rec.features;
+            info.category = cat;
+            dir.presets.push_back(std::move(info));
+        }
+    }
+
+    dirty_ = false;
+    return true;
+}
+
+usize PresetIndex::refresh(const Describe& describe) {
+    std::vector<Listing> listings;
+
+    if (dirs_.empty()) {
+        scan(".", recursive_, listings);
+        apply(listings, describe);
+        return listings.size();
+    }
+
+    std::vector<std::string> changed;
+    for (auto it = dirs_.begin(); it != dirs_.end();) {
+        std::error_code ec;
+        i64 mtime = mtimeOf(it->first == "." ? root_ : root_ / it->first, ec);
+        if (ec) {
+            it = dirs_.erase(it);  // Directory is gone
+            dirty_ = true;
+            continue;
+        }
+        if (mtime != it->second.mtime) {
+            changed.push_back(it->first);
+        }
+        ++it;
+    }
+
+    for (const auto& rel : changed) {
+        scan(rel, false, listings);
+
+        // New subdirectories show up as a change of their parent
+        if (!recursive_) continue;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(rel == "." ? root_ : root_ / rel, ec)) {
+            // Like recursive_directory_iterator: don't follow directory symlinks
+            if (!entry.is_directory(ec) || entry.is_symlink(ec)) continue;
+            std::string sub = entry.path().lexically_relative(root_).string();
+            if (!dirs_.contains(sub)) {
+                scan(sub, true, listings);
+            }
+        }
+    }
+
+    apply(listings, describe);
+    return listings.size();
+}
+
+void PresetIndex::scan(const std::string& rel, bool recursive, std::vector<Listing>& out) const {
+    std::mutex mutex;
+    DirectoryScanner scanner({file::presetExtensions, recursive, 0});
+    scanner.scan(rel == "." ? root_ : root_ / rel,
+                 [&](const fs::path& dir, std::vector<fs::path>& files) {
+        Listing listing;
+        listing.rel = dir.lexically_relative(root_).string();
+        std::error_code ec;
+        listing.mtime = mtimeOf(dir, ec);
+        listing.files = std::move(files);
+
+        std::lock_guard lock(mutex);
+        out.push_back(std::move(listing));
+    });
+}
+
+void PresetIndex::apply(std::vector<Listing>& listings, const Describe& describe) {
+    if (listings.empty()) return;
+
+    // Build entries serially (cheap), then describe them all in parallel:
+    // that's the part that may read the files
+    std::vector<std::pair<Dir*, usize>> slots;
+    std::vector<Dir> built(listings.size());
+    for (usize i = 0; i < listings.size(); ++i) {
+        Dir& dir = built[i];
+        dir.mtime = listings[i].mtime;
+        std::string cat = category(listings[i].rel);
+        dir.presets.reserve(listings[i].files.size());
+        for (auto& path : listings[i].files) {
+            PresetInfo info;
+            info.name = path.stem().string();
+            info.path = std::move(path);
+            info.category = cat;
+            dir.presets.push_back(std::move(info));
+            slots.emplace_back(&dir, dir.presets.size() - 1);
+        }
+    }
+
+    parallelFor(slots.size(), [&](usize begin, usize end) {
+        for (usize i = begin; i < end; ++i) {
+            describe(slots[i].first->presets[slots[i].second]);
+        }
+    });
+
+    for (usize i = 0; i < listings.size(); ++i) {
+        dirs_[listings[i].rel] = std::move(built[i]);
+    }
+    dirty_ = true;
+}
+
+void PresetIndex::invalidate(const std::string& rel) {
+    auto it = dirs_.find(rel);
+    if (it == dirs_.end()) return;
+    it->second.mtime = 0;   // Never a real mtime, so the directory reads as changed
+    dirty_ = true;
+}
+
+u64 PresetIndex::rootKey() const {
+    // A flat scan of the same root is a different tree
+    return hashPath(root_) ^ (recursive_ ? 0 : 0x9E3779B97F4A7C15ull);
+}
+
+std::string PresetIndex::category(const std::string& rel) const {
+    // Same as a full scan: the folder relative to the root
+    return rel == "." ? "Uncategorized" : rel;
+}
+
+Result<void> PresetIndex::save(const fs::path& file) const {
+    std::vector<DirRecord> dirRecs;
+    std::vector<PresetRecord> presetRecs;
+    std::string strings;
+
+    auto intern = [&](std::string_view s) {
+        StringRef ref{static_cast<u32>(strings.size()), static_cast<u32>(s.size())};
+        strings.append(s);
+        return ref;
+    };
+
+    dirRecs.reserve(dirs_.size());
+    for (const auto& [rel, dir] : dirs_) {
+        dirRecs.push_back({intern(rel), dir.mtime, static_cast<u32>(dir.presets.size()), 0});
+        for (const auto& p : dir.presets) {
+            presetRecs.push_back({intern(p.path.filename().string()), intern(p.author), p.features});
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = VERSION;
+    header.rootHash = rootKey();
+    header.dirCount = static_cast<u32>(dirRecs.size());
+    header.presetCount = static_cast<u32>(presetRecs.size());
+    header.stringsSize = strings.size();
+
+    std::vector<u8> blob(sizeof(Header) + dirRecs.size() * sizeof(DirRecord) +
+                         presetRecs.size() * sizeof(PresetRecord) + strings.size());
+    u8* out = blob.data();
+    auto put = [&out](const void* src, usize bytes) {
+        if (bytes == 0) return;
+        std::memcpy(out, src, bytes);
+        out += bytes;
+    };
+    put(&header, sizeof(header));
+    put(dirRecs.data(), dirRecs.size() * sizeof(DirRecord));
+    put(presetRecs.data(), presetRecs.size() * sizeof(PresetRecord));
+    put(strings.data(), strings.size());
+
+    if (auto result = file::ensureDir(file.parent_path()); !result) {
+        return result;
+    }
+
+    // writeBinary is atomic (temp + rename), so a reader never maps half a file
+    return file::writeBinary(file, blob.data(), blob.size());
+}
+
+std::vector<PresetInfo> PresetIndex::presets() const {
+    usize total = 0;
+    for (const auto& [rel, dir] : dirs_) {
+        total += dir.presets.size();
+    }
+
+    std::vector<PresetInfo> result;
+    result.reserve(total);
+    for (const auto& [rel, dir] : dirs_) {
+        result.insert(result.end(), dir.presets.begin(), dir.presets.end());
+    }
+    return result;
+}
+
+} // namespace vc
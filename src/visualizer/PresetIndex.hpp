@@ -0,0 +1,74 @@
+#pragma once
+// PresetIndex.hpp - Preset tree cached in one memory-mapped file
+// Walking 50k files every launch is a lifestyle choice. We chose differently.
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "PresetManager.hpp"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vc {
+
+// Every directory under the root, with its mtime and the presets directly
+// in it. A directory's mtime changes when entries are added, removed or
+// renamed, so on load only directories whose mtime moved are listed again.
+// Favorites and blacklist stay in the state file, the one source of truth.
+class PresetIndex {
+public:
+    using Describe = std::function<void(PresetInfo&)>;
+
+    PresetIndex(fs::path root, bool recursive);
+
+    // Map and decode an index file. False (and empty) if it's missing,
+    // from another format version, or for a different root.
+    bool load(const fs::path& file);
+
+    // Re-list changed directories, pick up new ones, drop deleted ones.
+    // With nothing loaded this is a full scan. describe fills in what's
+    // derived from the file (author, features) for new entries, and is
+    // called from several threads at once. Returns the number of
+    // directories listed.
+    usize refresh(const Describe& describe);
+
+    // A file in the directory was rewritten in place, which doesn't move
+    // the directory's mtime: have the next refresh list it again anyway.
+    // rel as in the index, "." for the root.
+    void invalidate(const std::string& rel);
+
+    Result<void> save(const fs::path& file) const;
+    bool dirty() const { return dirty_; }
+
+    // All presets, unsorted
+    std::vector<PresetInfo> presets() const;
+
+private:
+    struct Dir {
+        i64 mtime{0};
+        std::vector<PresetInfo> presets;
+    };
+
+    // One directory's worth of scan results, before describing
+    struct Listing {
+        std::string rel;
+        i64 mtime{0};
+        std::vector<fs::path> files;
+    };
+
+    void scan(const std::string& rel, bool recursive, std::vector<Listing>& out) const;
+    void apply(std::vector<Listing>& listings, const Describe& describe);
+    std::string category(const std::string& rel) const;
+    u64 rootKey() const;
+
+    fs::path root_;
+    bool recursive_;
+    std::map<std::string, Dir> dirs_;  // Keyed by path relative to root, "." for root
+    bool dirty_{false};
+
+    static constexpr u32 VERSION = 2;   // 2: preset features
+};
+
+} // namespace vc
@@ -1,8 +1,14 @@
 #include "PresetManager.hpp"
+#include "PresetIndex.hpp"
 #include "core/Logger.hpp"
 #include "util/FileUtils.hpp"
+#include "util/FileWatcher.hpp"
+#include "util/ParallelScan.hpp"
 #include <algorithm>
+#include <cstdio>
+#include <format>
 #include <fstream>
+#include <limits>
 #include <regex>
 
 namespace vc {
@@ -15,23 +21,24 @@ Result<void> PresetManager::scan(const fs::path& directory, bool recursive) {
     }
     
     scanDirectory_ = directory;
+    scanRecursive_ = recursive;
     presets_.clear();
     
-    auto files = file::listFiles(directory, file::presetExtensions, recursive);
+    // The cached index only lists directories whose mtime moved; without
+    // one (or for another root) this is a full walk, and writes the index
+    auto indexPath = file::cacheDir() / "preset_index.bin";
+    PresetIndex index(directory, recursive);
+    bool cached = index.load(indexPath);
+    usize listed = index.refresh([this](PresetInfo& info) { parsePresetInfo(info); });
     
-    for (const auto& path : files) {
-        PresetInfo info;
-        info.path = path;
-        info.name = path.stem().string();
-        
-        // Category is parent folder relative to scan directory
-        auto rel = fs::relative(path.parent_path(), directory);
-        info.category = rel.string();
-        if (info.category == ".") info.category = "Uncategorized";
-        
-        // Parse preset file for author info
-        parsePresetInfo(info);
-        
+    if (index.dirty()) {
+        if (auto result = index.save(indexPath); !result) {
+            LOG_WARN("Failed to save preset index: {}", result.error().message);
+        }
+    }
+    
+    presets_ = index.presets();
+    for (auto& info : presets_) {
         // Apply saved state
         if (favoriteNames_.contains(info.name)) {
             info.favorite = true;
@@ -39,16 +46,29 @@ Result<void> PresetManager::scan(const fs::path& directory, bool recursive) {
         if (blacklistedNames_.contains(info.name)) {
             info.blacklisted = true;
         }
-        
-        presets_.push_back(std::move(info));
+        applyCost(info);
     }
     
     // Sort by name
-    std::sort(presets_.begin(), presets_.end(), [](const auto& a, const auto& b) {
+    parallelSort(presets_, [](const auto& a, const auto& b) {
         return a.name < b.name;
     });
     
-    LOG_INFO("Scanned {} presets from {}", presets_.size(), directory.string());
+    // Ids follow name order, so equally ranked search hits come out sorted
+    searchIndex_.clear();
+    searchIndex_.reserve(presets_.size());
+    for (u32 i = 0; i < presets_.size(); ++i) {
+        presets_[i].id = i;
+        searchIndex_.add(i, presets_[i].name);
+    }
+    nextId_ = static_cast<u32>(presets_.size());
+    ++generation_;
+    reindex();
+    
+    rollRandom();
+    
+    LOG_INFO("Scanned {} presets from {} ({})", presets_.size(), directory.string(),
+             cached ? std::format("index, {} directories changed", listed) : std::string("full scan"));
     listChanged.emitSignal();
     
     return Result<void>::ok();
@@ -56,19 +76,143 @@ Result<void> PresetManager::scan(const fs::path& directory, bool recursive) {
 
 void PresetManager::rescan() {
     if (!scanDirectory_.empty()) {
-        scan(scanDirectory_);
+        scan(scanDirectory_, scanRecursive_);
+    }
+}
+
+void PresetManager::applyChanges(const FileChanges& changes) {
+    if (scanDirectory_.empty() || changes.empty()) return;
+    if (changes.overflow) {
+        rescan();  // Events were lost; nothing short of a walk is reliable
+        return;
+    }
+    
+    // The current preset keeps playing if it's still there, wherever it moved to
+    fs::path currentPath = currentIndex_ < presets_.size() ? presets_[currentIndex_].path : fs::path();
+    
+    usize before = presets_.size();
+    if (!changes.removed.empty() || !changes.removedDirs.empty()) {
+        std::erase_if(presets_, [this, &changes](const auto& p) {
+            if (!changes.isRemoved(p.path)) return false;
+            searchIndex_.remove(p.id);
+            return true;
+        });
+    }
+    usize removed = before - presets_.size();
+    
+    std::map<fs::path, usize> known;
+    for (usize i = 0; i < presets_.size(); ++i) {
+        known.emplace(presets_[i].path, i);
+    }
+    
+    std::vector<PresetInfo> added;
+    std::vector<usize> rewritten;       // Same entry, new contents
+    std::set<std::string> rewrittenDirs;
+    for (const auto& path : changes.added) {
+        fs::path rel = path.parent_path().lexically_relative(scanDirectory_);
+        if (rel.empty() || *rel.begin() == "..") continue;     // Not under our root
+        if (!scanRecursive_ && rel != ".") continue;
+        if (auto it = known.find(path); it != known.end()) {
+            rewritten.push_back(it->second);
+            rewrittenDirs.insert(rel.string());
+            continue;
+        }
+        
+        PresetInfo info;
+        info.path = path;
+        info.name = path.stem().string();
+        info.category = rel == "." ? "Uncategorized" : rel.string();
+        added.push_back(std::move(info));
+    }
+    
+    // Reading the files is the slow part; an unpacked pack can be thousands
+    parallelFor(added.size() + rewritten.size(), [this, &added, &rewritten](usize begin, usize end) {
+        for (usize i = begin; i < end; ++i) {
+            parsePresetInfo(i < added.size() ? added[i] : presets_[rewritten[i - added.size()]]);
+        }
+    });
+    if (!rewrittenDirs.empty()) {
+        invalidateIndex(rewrittenDirs);
+    }
+    
+    for (auto& info : added) {
+        info.favorite = favoriteNames_.contains(info.name);
+        info.blacklisted = blacklistedNames_.contains(info.name);
+        applyCost(info);
+        info.id = nextId_++;
+        searchIndex_.add(info.id, info.name);
+    }
+    
+    if (removed == 0 && added.empty()) return;
+    
+    // Sorted by name like a scan: sort the few new ones, merge them in
+    auto byName = [](const auto& a, const auto& b) { return a.name < b.name; };
+    std::sort(added.begin(), added.end(), byName);
+    usize middle = presets_.size();
+    presets_.insert(presets_.end(), std::make_move_iterator(added.begin()),
+                    std::make_move_iterator(added.end()));
+    std::inplace_merge(presets_.begin(), presets_.begin() + middle, presets_.end(), byName);
+    reindex();
+    
+    currentIndex_ = 0;
+    for (usize i = 0; i < presets_.size(); ++i) {
+        if (presets_[i].path == currentPath) {
+            currentIndex_ = i;
+            break;
+        }
+    }
+    
+    rollRandom();
+    
+    LOG_INFO("Presets updated: {} added, {} removed ({} total)", added.size(), removed, presets_.size());
+    listChanged.emitSignal();
+}
+
+void PresetManager::invalidateIndex(const std::set<std::string>& dirs) {
+    // Rare (someone edited a preset), so a load and save here is fine; without
+    // it the next launch would take the old features from the index
+    auto indexPath = file::cacheDir() / "preset_index.bin";
+    PresetIndex index(scanDirectory_, scanRecursive_);
+    if (!index.load(indexPath)) return;  // No index, or another root: the next scan is a full one
+    
+    for (const auto& dir : dirs) {
+        index.invalidate(dir);
+    }
+    if (auto result = index.save(indexPath); !result) {
+        LOG_WARN("Failed to save preset index: {}", result.error().message);
     }
 }
 
 void PresetManager::clear() {
     presets_.clear();
+    searchIndex_.clear();
+    reindex();
     currentIndex_ = 0;
+    nextRandom_ = 0;
     listChanged.emitSignal();
 }
 
 usize PresetManager::activeCount() const {
-    return std::count_if(presets_.begin(), presets_.end(), 
-        [](const auto& p) { return !p.blacklisted; });
+    return activeCount_;
+}
+
+std::optional<usize> PresetManager::indexOf(const fs::path& path) const {
+    auto it = byPath_.find(path.native());
+    if (it == byPath_.end()) return std::nullopt;
+    return it->second;
+}
+
+std::string PresetManager::keyOf(const fs::path& path) const {
+    fs::path rel = path.lexically_relative(scanDirectory_);
+    if (rel.empty() || *rel.begin() == "..") {
+        return path.generic_string();  // Not under our root, the full path is still unique
+    }
+    return rel.generic_string();
+}
+
+const PresetInfo* PresetManager::byId(u32 id) const {
+    if (id >= indexById_.size() || indexById_[id] >= presets_.size()) return nullptr;
+    return &presets_[indexById_[id]];
 }
 
 std::vector<const PresetInfo*> PresetManager::activePresets() const {
@@ -117,46 +261,133 @@ bool PresetManager::selectByIndex(usize index) {
 }
 
 bool PresetManager::selectByName(const std::string& name) {
-    for (usize i = 0; i < presets_.size(); ++i) {
-        if (presets_[i].name == name && !presets_[i].blacklisted) {
-            return selectByIndex(i);
-        }
-    }
-    return false;
+    // Blacklisting goes by name, so the first of a name stands for the rest
+    auto it = byName_.find(name);
+    return it != byName_.end() && selectByIndex(it->second);
 }
 
 bool PresetManager::selectByPath(const fs::path& path) {
-    for (usize i = 0; i < presets_.size(); ++i) {
-        if (presets_[i].path == path && !presets_[i].blacklisted) {
-            return selectByIndex(i);
+    auto index = indexOf(path);
+    return index && selectByIndex(*index);
+}
+
+bool PresetManager::selectRandom() {
+    // Take the pick rolled in advance (it may already be preloaded),
+    // unless it was blacklisted since
+    if (nextRandom_ >= presets_.size() || !isPlayable(presets_[nextRandom_])) {
+        rollRandom();
+    }
+    if (nextRandom_ >= presets_.size()) return false;
+    
+    usize index = nextRandom_;
+    rollRandom(index);
+    return selectByIndex(index);
+}
+
+void PresetManager::rollRandom(usize after) {
+    nextRandom_ = presets_.size();
+    if (playable_.empty()) return;
+    
+    std::uniform_int_distribution<usize> dist(0, playable_.size() - 1);
+    if (!pacing_) {
+        nextRandom_ = playable_[dist(rng_)];
+        return;
+    }
+    
+    // Rejection sampling keeps this O(1): heavy presets are accepted less
+    // often, and rarely right after another heavy one
+    constexpr int ATTEMPTS = 8;
+    bool afterHeavy = after < presets_.size() && isHeavy(presets_[after]);
+    std::uniform_real_distribution<f32> coin(0.0f, 1.0f);
+    f32 bestWeight = -1.0f;
+    
+    for (int i = 0; i < ATTEMPTS; ++i) {
+        usize candidate = playable_[dist(rng_)];
+        f32 weight = 1.0f;
+        if (isHeavy(presets_[candidate])) {
+            weight = afterHeavy ? 0.1f : 0.4f;
+        }
+        if (weight > bestWeight) {
+            bestWeight = weight;
+            nextRandom_ = candidate;
+        }
+        if (coin(rng_) < weight) {
+            nextRandom_ = candidate;
+            return;
         }
     }
-    return false;
 }
 
-bool PresetManager::selectRandom() {
-    auto active = activePresets();
-    if (active.empty()) return false;
+bool PresetManager::isHeavy(const PresetInfo& preset) const {
+    // A measured cost beats a guess from the source
+    if (preset.cost && frameBudgetMs_ > 0.0f) {
+        return preset.cost->avgFrameMs > frameBudgetMs_ * 0.6f;
+    }
+    return preset.features.heavy();
+}
+
+std::vector<fs::path> PresetManager::upcoming(usize count) const {
+    std::vector<fs::path> result;
+    if (presets_.empty()) return result;
     
-    std::uniform_int_distribution<usize> dist(0, active.size() - 1);
-    const auto* preset = active[dist(rng_)];
+    auto add = [&](usize index) {
+        const auto& path = presets_[index].path;
+        if (index != currentIndex_ && std::find(result.begin(), result.end(), path) == result.end()) {
+            result.push_back(path);
+        }
+    };
     
-    // Find index in main list
-    for (usize i = 0; i < presets_.size(); ++i) {
-        if (&presets_[i] == preset) {
-            return selectByIndex(i);
+    // Most likely first: the pre-rolled random pick, then next, then previous
+    if (nextRandom_ < presets_.size()) {
+        add(nextRandom_);
+    }
+    
+    usize index = currentIndex_;
+    for (usize found = 0, steps = 0; found < count && steps < presets_.size(); ++steps) {
+        index = (index + 1) % presets_.size();
+        if (isPlayable(presets_[index])) {
+            add(index);
+            ++found;
         }
     }
-    return false;
+    
+    index = currentIndex_;
+    for (usize steps = 0; steps < presets_.size(); ++steps) {
+        index = index == 0 ? presets_.size() - 1 : index - 1;
+        if (isPlayable(presets_[index])) {
+            add(index);
+            break;
+        }
+    }
+    
+    return result;
 }
 
-bool PresetManager::selectNext() {
+bool PresetManager::selectNext(bool paced) {
     if (presets_.empty()) return false;
     
+    if (paced && pacing_ && currentIndex_ < presets_.size() && isHeavy(presets_[currentIndex_])) {
+        // Look a few playable presets ahead for a light one; if there's
+        // none close by, plain order wins
+        constexpr usize LOOKAHEAD = 4;
+        usize index = currentIndex_;
+        for (usize found = 0, steps = 0; found < LOOKAHEAD && steps < presets_.size(); ++steps) {
+            index = (index + 1) % presets_.size();
+            if (!isPlayable(presets_[index])) continue;
+            if (!isHeavy(presets_[index])) {
+                currentIndex_ = index;
+                presets_[currentIndex_].playCount++;
+                presetChanged.emitSignal(&presets_[currentIndex_]);
+                return true;
+            }
+            ++found;
+        }
+    }
+    
     usize start = currentIndex_;
     do {
         currentIndex_ = (currentIndex_ + 1) % presets_.size();
-        if (!presets_[currentIndex_].blacklisted) {
+        if (isPlayable(presets_[currentIndex_])) {
             presets_[currentIndex_].playCount++;
             presetChanged.emitSignal(&presets_[currentIndex_]);
             return true;
@@ -172,7 +403,7 @@ bool PresetManager::selectPrevious() {
     usize start = currentIndex_;
     do {
         currentIndex_ = (currentIndex_ == 0) ? presets_.size() - 1 : currentIndex_ - 1;
-        if (!presets_[currentIndex_].blacklisted) {
+        if (isPlayable(presets_[currentIndex_])) {
             presets_[currentIndex_].playCount++;
             presetChanged.emitSignal(&presets_[currentIndex_]);
             return true;
@@ -196,6 +427,9 @@ void PresetManager::setFavorite(usize index, bool favorite) {
 
 void PresetManager::setBlacklisted(usize index, bool blacklisted) {
     if (index >= presets_.size()) return;
+    if (presets_[index].blacklisted != blacklisted) {
+        blacklisted ? --activeCount_ : ++activeCount_;
+    }
     
     presets_[index].blacklisted = blacklisted;
     if (blacklisted) {
@@ -203,6 +437,7 @@ void PresetManager::setBlacklisted(usize index, bool blacklisted) {
     } else {
         blacklistedNames_.erase(presets_[index].name);
     }
+    updatePlayable(index);
     listChanged.emitSignal();
 }
 
@@ -219,21 +454,57 @@ void PresetManager::toggleBlacklisted(usize index) {
 std::vector<const PresetInfo*> PresetManager::search(const std::string& query) const {
     std::vector<const PresetInfo*> result;
     
-    std::string lowerQuery = query;
-    std::transform(lowerQuery.begin(), lowerQuery.end(), lowerQuery.begin(), ::tolower);
-    
-    for (const auto& p : presets_) {
-        std::string lowerName = p.name;
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-        
-        if (lowerName.find(lowerQuery) != std::string::npos) {
-            result.push_back(&p);
+    auto ids = searchIndex_.search(query);
+    result.reserve(ids.size());
+    for (u32 id : ids) {
+        if (id < indexById_.size() && indexById_[id] < presets_.size()) {
+            result.push_back(&presets_[indexById_[id]]);
         }
     }
     
     return result;
 }
 
+void PresetManager::reindex() {
+    constexpr usize NONE = std::numeric_limits<usize>::max();
+    
+    indexById_.assign(nextId_, NONE);
+    byName_.clear();
+    byPath_.clear();
+    byName_.reserve(presets_.size());
+    byPath_.reserve(presets_.size());
+    playable_.clear();
+    playableSlot_.assign(presets_.size(), NONE);
+    activeCount_ = 0;
+    
+    for (usize i = 0; i < presets_.size(); ++i) {
+        const auto& p = presets_[i];
+        indexById_[p.id] = i;
+        byName_.try_emplace(p.name, i);  // First wins, as the linear scan did
+        byPath_.try_emplace(p.path.native(), i);
+        if (!p.blacklisted) ++activeCount_;
+        updatePlayable(i);
+    }
+}
+
+void PresetManager::updatePlayable(usize index) {
+    constexpr usize NONE = std::numeric_limits<usize>::max();
+    
+    usize& slot = playableSlot_[index];
+    bool playable = isPlayable(presets_[index]);
+    if (playable && slot == NONE) {
+        slot = playable_.size();
+        playable_.push_back(index);
+    } else if (!playable && slot != NONE) {
+        // Swap-remove: the last entry takes this one's slot
+        usize last = playable_.back();
+        playable_[slot] = last;
+        playableSlot_[last] = slot;
+        playable_.pop_back();
+        slot = NONE;
+    }
+}
+
 std::vector<const PresetInfo*> PresetManager::byCategory(const std::string& category) const {
     std::vector<const PresetInfo*> result;
     for (const auto& p : presets_) {
@@ -245,8 +516,9 @@ std::vector<const PresetInfo*> PresetManager::byCategory(const std::string& cate
 }
 
 void PresetManager::parsePresetInfo(PresetInfo& info) {
+    // Runs on scan worker threads: touch nothing but info
     // Try to extract author from filename pattern "Author - Name"
-    std::regex authorPattern(R"(^(.+?)\s*-\s*(.+)$)");
+    static const std::regex authorPattern(R"(^(.+?)\s*-\s*(.+)$)");
     std::smatch match;
     
     if (std::regex_match(info.name, match, authorPattern)) {
@@ -254,8 +526,9 @@ void PresetManager::parsePresetInfo(PresetInfo& info) {
         // Keep full name for display
     }
     
-    // Could also parse the actual preset file here for metadata
-    // but most presets don't have standardized metadata
+    // No standard metadata in .milk files, but the equations and shaders
+    // tell us roughly what a preset costs to render
+    info.features = readFeatures(info.path);
 }
 
 Result<void> PresetManager::loadState(const fs::path& path) {
@@ -286,6 +559,7 @@ Result<void> PresetManager::loadState(const fs::path& path) {
         p.favorite = favoriteNames_.contains(p.name);
         p.blacklisted = blacklistedNames_.contains(p.name);
     }
+    reindex();
     
     return Result<void>::ok();
 }
@@ -309,4 +583,85 @@ Result<void> PresetManager::saveState(const fs::path& path) const {
     return Result<void>::ok();
 }
 
+Result<void> PresetManager::loadCensus(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return Result<void>::ok();  // No census run yet
+    }
+    
+    // key \t compile \t avg \t p99 \t width \t height
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        
+        auto tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        
+        PresetCost cost;
+        if (std::sscanf(line.c_str() + tab + 1, "%f\t%f\t%f\t%u\t%u",
+                        &cost.compileMs, &cost.avgFrameMs, &cost.p99FrameMs,
+                        &cost.width, &cost.height) != 5) {
+            continue;
+        }
+        census_[line.substr(0, tab)] = cost;
+    }
+    
+    for (usize i = 0; i < presets_.size(); ++i) {
+        applyCost(presets_[i]);
+        updatePlayable(i);
+    }
+    rollRandom();
+    
+    return Result<void>::ok();
+}
+
+Result<void> PresetManager::saveCensus(const fs::path& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        return Result<void>::err("Failed to open file for writing");
+    }
+    
+    file << "# preset\tcompile_ms\tavg_ms\tp99_ms\twidth\theight\n";
+    for (const auto& [key, cost] : census_) {
+        file << std::format("{}\t{:.3f}\t{:.3f}\t{:.3f}\t{}\t{}\n", key,
+                            cost.compileMs, cost.avgFrameMs, cost.p99FrameMs,
+                            cost.width, cost.height);
+    }
+    
+    return Result<void>::ok();
+}
+
+void PresetManager::setCost(const fs::path& preset, const PresetCost& cost) {
+    census_[keyOf(preset)] = cost;
+    if (auto index = indexOf(preset)) {
+        applyCost(presets_[*index]);
+        updatePlayable(*index);
+    }
+}
+
+void PresetManager::setFrameBudget(f32 maxFrameMs, bool skipSlow) {
+    frameBudgetMs_ = maxFrameMs;
+    skipSlow_ = skipSlow;
+    for (usize i = 0; i < presets_.size(); ++i) {
+        applyCost(presets_[i]);
+        updatePlayable(i);
+    }
+    rollRandom();
+}
+
+bool PresetManager::isPlayable(const PresetInfo& preset) const {
+    return !preset.blacklisted && !(skipSlow_ && preset.slow);
+}
+
+void PresetManager::applyCost(PresetInfo& info) const {
+    auto it = census_.find(keyOf(info.path));
+    if (it == census_.end()) {
+        info.cost.reset();
+        info.slow = false;
+        return;
+    }
+    info.cost = it->second;
+    info.slow = frameBudgetMs_ > 0.0f && it->second.p99FrameMs > frameBudgetMs_;
+}
+
 } // namespace vc
\ No newline at end of file
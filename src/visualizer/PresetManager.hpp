@@ -5,12 +5,28 @@
 #include "util/Types.hpp"
 #include "util/Result.hpp"
 #include "util/Signal.hpp"
+#include "PresetSearch.hpp"
+#include "PresetFeatures.hpp"
+#include <map>
+#include <optional>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <random>
 
 namespace vc {
 
+struct FileChanges;
+
+// Offscreen render cost measured by the preset census
+struct PresetCost {
+    f32 compileMs{0.0f};        // Load plus first frame
+    f32 avgFrameMs{0.0f};
+    f32 p99FrameMs{0.0f};
+    u32 width{0};               // Resolution it was measured at
+    u32 height{0};
+};
+
 struct PresetInfo {
     fs::path path;
     std::string name;
@@ -19,6 +35,10 @@ struct PresetInfo {
     bool favorite{false};
     bool blacklisted{false};
     u32 playCount{0};
+    std::optional<PresetCost> cost;
+    bool slow{false};      // Census says it can't hold the frame rate
+    u32 id{0};             // Stable while the list changes in place; keys the search index
+    PresetFeatures features;  // Parsed from the file once, kept in the preset index
 };
 
 class PresetManager {
@@ -30,12 +50,27 @@ public:
     void rescan();
     void clear();
     
+    // Apply a watcher batch in place: one listChanged, selection kept
+    void applyChanges(const FileChanges& changes);
+    const fs::path& directory() const { return scanDirectory_; }
+    bool isRecursive() const { return scanRecursive_; }
+    
     // Access
     usize count() const { return presets_.size(); }
     usize activeCount() const;  // Excludes blacklisted
     bool empty() const { return presets_.empty(); }
     
     const std::vector<PresetInfo>& allPresets() const { return presets_; }
+    std::optional<usize> indexOf(const fs::path& path) const;
+    
+    // Path under the scanned root, '/'-separated. Names repeat across
+    // packs, this doesn't, so per-preset caches on disk key by it.
+    std::string keyOf(const fs::path& path) const;
+    const PresetInfo* byId(u32 id) const;  // Null once the preset is gone
+    
+    // A scan numbers presets afresh, so an id means something else after
+    // one. Bumped by every scan; ids from another generation are stale.
+    u32 generation() const { return generation_; }
     std::vector<const PresetInfo*> activePresets() const;
     std::vector<const PresetInfo*> favoritePresets() const;
     std::vector<std::string> categories() const;
@@ -48,16 +83,21 @@ public:
     bool selectByName(const std::string& name);
     bool selectByPath(const fs::path& path);
     bool selectRandom();
-    bool selectNext();
+    bool selectNext(bool paced = false);  // Paced: step over a heavy preset after a heavy one
     bool selectPrevious();
     
+    // What could play next: the following `count` presets in order, the
+    // previous one, and the next random pick (rolled ahead of time so it
+    // can be preloaded). Copies, safe to hand to another thread.
+    std::vector<fs::path> upcoming(usize count) const;
+    
     // Favorites & Blacklist
     void setFavorite(usize index, bool favorite);
     void setBlacklisted(usize index, bool blacklisted);
     void toggleFavorite(usize index);
     void toggleBlacklisted(usize index);
     
-    // Search
+    // Search: trigram index over names, ranked, tolerates a typo or two
     std::vector<const PresetInfo*> search(const std::string& query) const;
     std::vector<const PresetInfo*> byCategory(const std::string& category) const;
     
@@ -65,21 +105,61 @@ public:
     Result<void> loadState(const fs::path& path);
     Result<void> saveState(const fs::path& path) const;
     
+    // Census results, one tab-separated line per preset, keyed by keyOf()
+    Result<void> loadCensus(const fs::path& path);
+    Result<void> saveCensus(const fs::path& path) const;
+    void setCost(const fs::path& preset, const PresetCost& cost);
+    
+    // Presets whose census p99 exceeds the budget are flagged slow; with
+    // skipSlow they're passed over by next/previous/random (picking one
+    // by hand still works). Unmeasured presets are never slow.
+    void setFrameBudget(f32 maxFrameMs, bool skipSlow);
+    bool isPlayable(const PresetInfo& preset) const;
+    
+    // Weighted sequencing for long unattended runs: random picks favour
+    // presets within the frame budget and avoid two heavy ones in a row
+    void setPacing(bool enabled) { pacing_ = enabled; }
+    bool isHeavy(const PresetInfo& preset) const;
+    
     // Signals
     Signal<const PresetInfo*> presetChanged;
     Signal<> listChanged;
     
 private:
     void parsePresetInfo(PresetInfo& info);
+    void invalidateIndex(const std::set<std::string>& dirs);  // Relative to the root
+    void applyCost(PresetInfo& info) const;
+    void rollRandom() { rollRandom(currentIndex_); }
+    void rollRandom(usize after);           // Pick what follows the preset at `after`
+    void reindex();                         // Rebuild every lookup below from presets_
+    void updatePlayable(usize index);       // After blacklist or cost changes
     
     std::vector<PresetInfo> presets_;
     usize currentIndex_{0};
     fs::path scanDirectory_;
+    bool scanRecursive_{true};
     
     std::set<std::string> favoriteNames_;
     std::set<std::string> blacklistedNames_;
+    std::map<std::string, PresetCost> census_;    // Keyed by keyOf(path)
+    f32 frameBudgetMs_{0.0f};
+    bool skipSlow_{false};
+    bool pacing_{true};
     
     std::mt19937 rng_{std::random_device{}()};
+    usize nextRandom_{0};  // Index into presets_, valid when < size
+    
+    PresetSearchIndex searchIndex_;
+    std::vector<usize> indexById_;  // PresetInfo::id -> index into presets_
+    u32 nextId_{0};
+    u32 generation_{0};
+    
+    // Selection is O(1) however big the list gets
+    std::unordered_map<std::string, usize> byName_;     // First preset with the name
+    std::unordered_map<std::string, usize> byPath_;     // Keyed by path.native()
+    std::vector<usize> playable_;                       // Dense, for random picks
+    std::vector<usize> playableSlot_;                   // Index -> position in playable_
+    usize activeCount_{0};
 };
 
 } // namespace vc
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "PresetPreloader.hpp"
+#include "core/Logger.hpp"
+#include "util/FileUtils.hpp"
+
+#include <QCoreApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QThread>
+#include <algorithm>
+
+namespace vc {
+
+PresetPreloader::PresetPreloader() = default;
+
+PresetPreloader::~PresetPreloader() {
+    stop();
+}
+
+Result<void> PresetPreloader::start(const QSurfaceFormat& format) {
+    if (running_) {
+        return Result<void>::ok();
+    }
+
+    surface_ = std::make_unique<QOffscreenSurface>();
+    surface_->setFormat(format);
+    surface_->create();
+
+    context_ = std::make_unique<QOpenGLContext>();
+    context_->setFormat(format);
+    context_->setShareContext(QOpenGLContext::globalShareContext());
+    if (!context_->create()) {
+        context_.reset();
+        surface_.reset();
+        return Result<void>::err("Failed to create preloader GL context");
+    }
+
+    stopping_ = false;
+    thread_.reset(QThread::create([this] { run(); }));
+    thread_->setObjectName("vc-preload");
+    context_->moveToThread(thread_.get());
+    thread_->start(QThread::LowestPriority);
+
+    running_ = true;
+    return Result<void>::ok();
+}
+
+void PresetPreloader::stop() {
+    if (!thread_) return;
+
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    cond_.notify_all();
+
+    thread_->wait();
+    thread_.reset();
+    context_.reset();
+    surface_.reset();
+    running_ = false;
+}
+
+void PresetPreloader::request(std::vector<fs::path> paths) {
+    {
+        std::lock_guard lock(mutex_);
+        queue_.clear();
+        for (auto& path : paths) {
+            bool cached = std::any_of(cache_.begin(), cache_.end(),
+                                      [&](const Entry& e) { return e.path == path; });
+            if (!cached) {
+                queue_.push_back(std::move(path));
+            }
+        }
+        if (queue_.empty()) return;
+    }
+    cond_.notify_one();
+}
+
+std::shared_ptr<const std::string> PresetPreloader::find(const fs::path& path) {
+    std::lock_guard lock(mutex_);
+
+    auto it = std::find_if(cache_.begin(), cache_.end(),
+                           [&](const Entry& e) { return e.path == path; });
+    if (it == cache_.end()) {
+        return nullptr;
+    }
+
+    // Touch: move to the back so it survives eviction a while longer
+    auto data = it->data;
+    std::rotate(it, it + 1, cache_.end());
+    return data;
+}
+
+void PresetPreloader::run() {
+    bool haveContext = context_->makeCurrent(surface_.get());
+    if (haveContext) {
+        warmInstance_ = projectm_create();
+        if (warmInstance_) {
+            projectm_set_window_size(warmInstance_, WARM_SIZE, WARM_SIZE);
+            projectm_set_mesh_size(warmInstance_, 16, 12);
+            warmTarget_.create(WARM_SIZE, WARM_SIZE);
+        }
+    } else {
+        LOG_WARN("Preset preloader: no GL context, reading ahead only");
+    }
+
+    while (true) {
+        fs::path path;
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) break;
+
+            path = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        warm(path);
+    }
+
+    if (warmInstance_) {
+        projectm_destroy(warmInstance_);
+        warmInstance_ = nullptr;
+    }
+    warmTarget_.destroy();
+
+    if (haveContext) {
+        context_->doneCurrent();
+    }
+    context_->moveToThread(QCoreApplication::instance()->thread());
+}
+
+void PresetPreloader::warm(const fs::path& path) {
+    auto text = file::readText(path);
+    if (!text) {
+        LOG_DEBUG("Preset preloader: {}", text.error().message);
+        return;
+    }
+    auto data = std::make_shared<const std::string>(std::move(text.value()));
+
+    // Parse and compile, then draw once: some shaders are only built on first use.
+    // glFinish so the compile is really done here and not deferred into the driver.
+    if (warmInstance_) {
+        projectm_load_preset_data(warmInstance_, data->c_str(), false);
+        warmTarget_.bind();
+        projectm_opengl_render_frame(warmInstance_);
+        warmTarget_.unbind();
+        glFinish();
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        cache_.push_back({path, std::move(data)});
+        if (cache_.size() > CACHE_SIZE) {
+            cache_.erase(cache_.begin());
+        }
+    }
+    ++warmed_;
+
+    LOG_DEBUG("Preloaded preset: {}", path.filename().string());
+}
+
+} // namespace vc
@@ -0,0 +1,79 @@
+#pragma once
+// PresetPreloader.hpp - Read and warm up upcoming presets in the background
+// So the transition costs a frame, not a hitch
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "RenderTarget.hpp"
+#include "projectM-4/projectM.h"
+
+#include <QSurfaceFormat>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QThread;
+
+namespace vc {
+
+class PresetPreloader {
+public:
+    PresetPreloader();
+    ~PresetPreloader();
+
+    // Non-copyable
+    PresetPreloader(const PresetPreloader&) = delete;
+    PresetPreloader& operator=(const PresetPreloader&) = delete;
+
+    // GUI thread (the offscreen surface must be created there)
+    Result<void> start(const QSurfaceFormat& format);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Replace the wish list, most likely first. Any thread.
+    void request(std::vector<fs::path> paths);
+
+    // Preset source if it has been read ahead, null otherwise. Any thread.
+    std::shared_ptr<const std::string> find(const fs::path& path);
+
+    usize warmedCount() const { return warmed_; }
+
+private:
+    struct Entry {
+        fs::path path;
+        std::shared_ptr<const std::string> data;
+    };
+
+    void run();
+    void warm(const fs::path& path);
+
+    std::unique_ptr<QThread> thread_;
+    std::unique_ptr<QOpenGLContext> context_;
+    std::unique_ptr<QOffscreenSurface> surface_;
+
+    // Throwaway instance on the preloader's context; compiling a preset's
+    // shaders here leaves them in the driver's shader cache for the real one
+    projectm_handle warmInstance_{nullptr};
+    RenderTarget warmTarget_;
+
+    std::deque<fs::path> queue_;
+    std::vector<Entry> cache_;  // Most recently used at the back
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<usize> warmed_{0};
+
+    // Enough for next/previous/random plus a few recently played
+    static constexpr usize CACHE_SIZE = 12;
+
+    // The warm-up instance only needs to compile shaders, not look good
+    static constexpr u32 WARM_SIZE = 64;
+};
+
+} // namespace vc
@@ -0,0 +1,230 @@
+#include "PresetSearch.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+
+namespace vc {
+
+namespace {
+
+constexpr usize FUZZY_BELOW = 50;       // Look for typos only when exact hits are this few
+constexpr usize FUZZY_CANDIDATES = 1000; // Most trigram-overlap candidates worth verifying
+
+std::string lower(std::string_view s) {
+    std::string out(s);
+    for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+u32 trigram(std::string_view s, usize i) {
+    return static_cast<u32>(static_cast<u8>(s[i])) << 16 |
+           static_cast<u32>(static_cast<u8>(s[i + 1])) << 8 |
+           static_cast<u32>(static_cast<u8>(s[i + 2]));
+}
+
+std::vector<u32> trigrams(std::string_view s) {
+    std::vector<u32> grams;
+    for (usize i = 0; i + 3 <= s.size(); ++i) {
+        grams.push_back(trigram(s, i));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+// Fewest edits turning the query into any substring of text (Sellers):
+// free to start and end anywhere in text. Gives up above maxEdits.
+u32 substringDistance(std::string_view query, std::string_view text, u32 maxEdits,
+                      std::vector<u32>& column) {
+    column.resize(query.size() + 1);
+    std::iota(column.begin(), column.end(), 0u);
+    u32 best = column.back();
+
+    for (char t : text) {
+        u32 diagonal = 0;   // D[0][j-1]: the match may start here
+        column[0] = 0;
+        for (usize i = 1; i <= query.size(); ++i) {
+            u32 above = column[i];
+            u32 cost = query[i - 1] == t ? 0 : 1;
+            column[i] = std::min({column[i - 1] + 1, above + 1, diagonal + cost});
+            diagonal = above;
+        }
+        best = std::min(best, column.back());
+        if (best == 0) break;
+    }
+    return best <= maxEdits ? best : maxEdits + 1;
+}
+
+} // namespace
+
+void PresetSearchIndex::clear() {
+    arena_.clear();
+    docs_.clear();
+    postings_.clear();
+    live_ = dead_ = 0;
+}
+
+void PresetSearchIndex::reserve(usize count) {
+    docs_.reserve(count);
+    arena_.reserve(count * 24);
+}
+
+void PresetSearchIndex::add(u32 id, std::string_view name) {
+    if (id < docs_.size() && docs_[id].live) remove(id);
+    if (id >= docs_.size()) docs_.resize(id + 1);
+
+    std::string lowered = lower(name);
+    docs_[id] = {static_cast<u32>(arena_.size()), static_cast<u32>(lowered.size()), true};
+    arena_.append(lowered);
+    ++live_;
+
+    for (u32 gram : trigrams(lowered)) {
+        auto& list = postings_[gram];
+        if (list.empty() || list.back() < id) {
+            list.push_back(id);
+        } else {
+            // Re-added under an old id: keep the list sorted. Removal left the
+            // id in the lists its old name shared, so don't add it twice.
+            auto it = std::lower_bound(list.begin(), list.end(), id);
+            if (it == list.end() || *it != id) {
+                list.insert(it, id);
+            }
+        }
+    }
+}
+
+void PresetSearchIndex::remove(u32 id) {
+    if (!isLive(id)) return;
+
+    // Postings are filtered lazily; searches skip dead ids
+    docs_[id].live = false;
+    --live_;
+    ++dead_;
+
+    if (dead_ > live_ && dead_ > 1024) {
+        compact();
+    }
+}
+
+void PresetSearchIndex::compact() {
+    std::string arena;
+    arena.reserve(arena_.size());
+    for (auto& doc : docs_) {
+        if (!doc.live) {
+            doc = {};
+            continue;
+        }
+        u32 offset = static_cast<u32>(arena.size());
+        arena.append(arena_, doc.offset, doc.length);
+        doc.offset = offset;
+    }
+    arena_ = std::move(arena);
+
+    for (auto it = postings_.begin(); it != postings_.end();) {
+        std::erase_if(it->second, [this](u32 id) { return !docs_[id].live; });
+        it = it->second.empty() ? postings_.erase(it) : std::next(it);
+    }
+    dead_ = 0;
+}
+
+std::vector<u32> PresetSearchIndex::search(std::string_view rawQuery) const {
+    std::vector<u32> result;
+    std::string query = lower(rawQuery);
+    if (query.empty() || live_ == 0) return result;
+
+    // Rank packed into one integer so sorting 50k hits stays cheap:
+    // edits, not-a-prefix, position, length, then id as the tie-break
+    auto rank = [](u64 distance, u64 position, u64 length, u32 id) {
+        return distance << 61 | u64{position != 0} << 60 | std::min<u64>(position, 0x3FFF) << 46 |
+               std::min<u64>(length, 0x3FFF) << 32 | id;
+    };
+    std::vector<u64> hits;
+    usize exactCount = 0;
+
+    auto addExact = [&](u32 id) {
+        auto pos = name(id).find(query);
+        if (pos != std::string_view::npos) {
+            hits.push_back(rank(0, pos, docs_[id].length, id));
+        }
+    };
+
+    auto grams = trigrams(query);
+    if (grams.empty()) {
+        // One or two characters: no trigram to go on, scan the arena
+        for (u32 id = 0; id < docs_.size(); ++id) {
+            if (docs_[id].live) addExact(id);
+        }
+    } else {
+        // Every trigram of the query must be in the name: intersect, shortest list first
+        std::vector<const std::vector<u32>*> lists;
+        for (u32 gram : grams) {
+            auto it = postings_.find(gram);
+            lists.push_back(it == postings_.end() ? nullptr : &it->second);
+        }
+
+        if (std::none_of(lists.begin(), lists.end(), [](auto* l) { return l == nullptr; })) {
+            std::sort(lists.begin(), lists.end(),
+                      [](auto* a, auto* b) { return a->size() < b->size(); });
+            std::vector<u32> candidates = *lists[0];
+            std::vector<u32> next;
+            for (usize i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                next.clear();
+                std::set_intersection(candidates.begin(), candidates.end(),
+                                      lists[i]->begin(), lists[i]->end(), std::back_inserter(next));
+                candidates.swap(next);
+            }
+            for (u32 id : candidates) {
+                if (isLive(id)) addExact(id);  // Trigrams can match out of order
+            }
+        }
+
+        // Typos: each edit breaks at most three trigrams, so a name within
+        // k edits still shares at least (grams - 3k) of them
+        u32 maxEdits = query.size() >= 8 ? 2 : query.size() >= 4 ? 1 : 0;
+        exactCount = hits.size();
+        if (maxEdits > 0 && exactCount < FUZZY_BELOW) {
+            usize total = grams.size();
+            usize needed = total > 3 * maxEdits ? total - 3 * maxEdits : 1;
+
+            std::vector<u16> counts(docs_.size(), 0);
+            for (auto* list : lists) {
+                if (!list) continue;
+                for (u32 id : *list) ++counts[id];
+            }
+
+            std::vector<u32> exact;
+            for (u64 h : hits) exact.push_back(static_cast<u32>(h));
+            std::sort(exact.begin(), exact.end());
+
+            std::vector<u32> fuzzy;
+            for (u32 id = 0; id < counts.size(); ++id) {
+                if (counts[id] >= needed && docs_[id].live &&
+                    !std::binary_search(exact.begin(), exact.end(), id)) {
+                    fuzzy.push_back(id);
+                }
+            }
+            if (fuzzy.size() > FUZZY_CANDIDATES) {
+                std::partial_sort(fuzzy.begin(), fuzzy.begin() + FUZZY_CANDIDATES, fuzzy.end(),
+                                  [&counts](u32 a, u32 b) { return counts[a] > counts[b]; });
+                fuzzy.resize(FUZZY_CANDIDATES);
+            }
+
+            std::vector<u32> column;
+            for (u32 id : fuzzy) {
+                u32 distance = substringDistance(query, name(id), maxEdits, column);
+                if (distance <= maxEdits) {
+                    hits.push_back(rank(distance, 0, docs_[id].length, id));
+                }
+            }
+        }
+    }
+
+    std::sort(hits.begin(), hits.end());
+
+    result.reserve(hits.size());
+    for (u64 h : hits) result.push_back(static_cast<u32>(h));
+    return result;
+}
+
+} // namespace vc
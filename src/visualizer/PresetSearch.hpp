@@ -0,0 +1,52 @@
+#pragma once
+// PresetSearch.hpp - Trigram index over preset names
+// Typing "fractl" at 100k presets should still find the fractals, instantly
+
+#include "util/Types.hpp"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vc {
+
+// Lowercased names packed in one arena, plus a posting list of document
+// ids per trigram. Ids belong to the caller and must only grow, so
+// posting lists stay sorted by appending. Removal leaves a tombstone;
+// the arena and postings are compacted once the dead outnumber the live.
+class PresetSearchIndex {
+public:
+    void clear();
+    void reserve(usize count);
+
+    void add(u32 id, std::string_view name);
+    void remove(u32 id);
+    usize size() const { return live_; }
+
+    // Ids ranked best first. Substring matches come first (prefix, then
+    // earlier position, then shorter name); when there are few of them,
+    // names within one or two typos of the query follow.
+    std::vector<u32> search(std::string_view query) const;
+
+private:
+    struct Doc {
+        u32 offset{0};
+        u32 length{0};
+        bool live{false};
+    };
+
+    std::string_view name(u32 id) const {
+        return {arena_.data() + docs_[id].offset, docs_[id].length};
+    }
+    bool isLive(u32 id) const { return id < docs_.size() && docs_[id].live; }
+    void compact();
+
+    std::string arena_;
+    std::vector<Doc> docs_;                                 // Indexed by id
+    std::unordered_map<u32, std::vector<u32>> postings_;    // Trigram -> ids
+    usize live_{0};
+    usize dead_{0};
+};
+
+} // namespace vc
@@ -0,0 +1,381 @@
+#include "PresetThumbnailer.hpp"
+#include "PresetCensus.hpp"
+#include "core/Logger.hpp"
+#include "util/FileUtils.hpp"
+
+#include <QCoreApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QThread>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <format>
+
+namespace vc {
+
+namespace {
+
+i64 mtimeOf(const fs::path& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<i64>(time.time_since_epoch().count());
+}
+
+} // namespace
+
+ThumbnailAtlas::ThumbnailAtlas(fs::path dir)
+    : dir_(std::move(dir))
+{
+}
+
+void ThumbnailAtlas::load() {
+    std::lock_guard lock(mutex_);
+    slots_.clear();
+    nextIndex_ = 0;
+
+    auto text = file::readText(dir_ / "index.tsv");
+    if (!text) return;  // First run
+
+    // index \t mtime \t path
+    std::string_view rest = *text;
+    while (!rest.empty()) {
+        usize eol = rest.find('\n');
+        std::string_view line = rest.substr(0, eol);
+        rest = eol == std::string_view::npos ? std::string_view() : rest.substr(eol + 1);
+        if (line.empty() || line[0] == '#') continue;
+
+        usize tab1 = line.find('\t');
+        usize tab2 = tab1 == std::string_view::npos ? tab1 : line.find('\t', tab1 + 1);
+        if (tab2 == std::string_view::npos) continue;
+
+        Slot slot;
+        auto r1 = std::from_chars(line.data(), line.data() + tab1, slot.index);
+        auto r2 = std::from_chars(line.data() + tab1 + 1, line.data() + tab2, slot.mtime);
+        if (r1.ec != std::errc() || r2.ec != std::errc()) continue;
+
+        slots_[std::string(line.substr(tab2 + 1))] = slot;
+        nextIndex_ = std::max(nextIndex_, slot.index + 1);
+    }
+}
+
+Result<void> ThumbnailAtlas::flush() {
+    // Snapshot under the lock (QImage copies share pixels until written),
+    // encode outside it, so the browser's find() never waits on a JPEG
+    std::vector<std::pair<u32, QImage>> pages;
+    std::string index = "# index\tmtime\tpath\n";
+    {
+        std::lock_guard lock(mutex_);
+        if (dirtyPages_.empty() && !indexDirty_) return Result<void>::ok();
+
+        for (u32 number : dirtyPages_) {
+            pages.emplace_back(number, pages_[number]);
+        }
+        for (const auto& [path, slot] : slots_) {
+            index += std::format("{}\t{}\t{}\n", slot.index, slot.mtime, path);
+        }
+        dirtyPages_.clear();
+        indexDirty_ = false;
+    }
+
+    if (auto result = file::ensureDir(dir_); !result) {
+        return result;
+    }
+    for (const auto& [number, image] : pages) {
+        if (auto result = writePage(number, image); !result) {
+            return result;
+        }
+    }
+    return file::writeText(dir_ / "index.tsv", index);
+}
+
+Result<void> ThumbnailAtlas::writePage(u32 number, const QImage& image) const {
+    // Write beside and rename, so a crash never leaves half a page
+    fs::path path = pagePath(number);
+    fs::path temp = path;
+    temp += ".tmp";
+    if (!image.save(QString::fromStdString(temp.string()), "JPG", JPEG_QUALITY)) {
+        return Result<void>::err("Failed to write thumbnail page " + path.string());
+    }
+
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        return Result<void>::err("Failed to write thumbnail page: " + ec.message());
+    }
+    return Result<void>::ok();
+}
+
+std::optional<QImage> ThumbnailAtlas::find(const fs::path& preset, i64 mtime) {
+    std::lock_guard lock(mutex_);
+    auto it = slots_.find(preset.native());
+    if (it == slots_.end() || it->second.mtime != mtime) return std::nullopt;
+
+    u32 perPage = COLUMNS * ROWS;
+    u32 within = it->second.index % perPage;
+    auto loaded = pages_.find(it->second.index / perPage);
+    if (loaded == pages_.end()) return std::nullopt;
+
+    const QImage& sheet = loaded->second;
+    return sheet.copy(static_cast<int>((within % COLUMNS) * THUMB_WIDTH),
+                      static_cast<int>((within / COLUMNS) * THUMB_HEIGHT),
+                      THUMB_WIDTH, THUMB_HEIGHT);
+}
+
+bool ThumbnailAtlas::prepare(const fs::path& preset, i64 mtime) {
+    u32 number;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = slots_.find(preset.native());
+        if (it == slots_.end() || it->second.mtime != mtime) return false;
+        number = it->second.index / (COLUMNS * ROWS);
+    }
+    loadPage(number);
+    return true;
+}
+
+void ThumbnailAtlas::add(const fs::path& preset, i64 mtime, const QImage& thumbnail) {
+    QImage thumb = thumbnail.size() == QSize(THUMB_WIDTH, THUMB_HEIGHT)
+        ? thumbnail.convertToFormat(QImage::Format_RGB888)
+        : thumbnail.scaled(THUMB_WIDTH, THUMB_HEIGHT, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                   .convertToFormat(QImage::Format_RGB888);
+
+    // A re-rendered preset keeps its slot. Slots and pages only change on
+    // this thread, so what we see here still holds once we relock.
+    u32 index;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = slots_.find(preset.native());
+        index = it != slots_.end() ? it->second.index : nextIndex_;
+    }
+
+    u32 perPage = COLUMNS * ROWS;
+    u32 number = index / perPage;
+    u32 within = index % perPage;
+    loadPage(number);
+
+    std::lock_guard lock(mutex_);
+    QImage& sheet = pages_[number];
+
+    usize x = (within % COLUMNS) * THUMB_WIDTH;
+    usize y = (within / COLUMNS) * THUMB_HEIGHT;
+    for (u32 row = 0; row < THUMB_HEIGHT; ++row) {
+        std::memcpy(sheet.scanLine(static_cast<int>(y + row)) + x * 3,
+                    thumb.constScanLine(static_cast<int>(row)), THUMB_WIDTH * 3);
+    }
+
+    // Published after the pixels, so find() never sees the slot blank
+    auto [it, added] = slots_.try_emplace(preset.native(), Slot{index, mtime});
+    if (added) {
+        ++nextIndex_;
+    }
+    it->second.mtime = mtime;
+
+    dirtyPages_.insert(number);
+    indexDirty_ = true;
+}
+
+void ThumbnailAtlas::loadPage(u32 number) {
+    // Make room first; a dirty page is written before it's dropped (the
+    // index follows at the next flush, until then its new slots just miss).
+    // Evicted pages are taken out under the lock and written outside it.
+    std::vector<std::pair<u32, QImage>> evicted;
+    {
+        std::lock_guard lock(mutex_);
+        if (pages_.contains(number)) {
+            pageOrder_.remove(number);
+            pageOrder_.push_back(number);
+            return;
+        }
+
+        while (pages_.size() >= MAX_LOADED_PAGES && !pageOrder_.empty()) {
+            u32 victim = pageOrder_.front();
+            if (dirtyPages_.erase(victim) > 0) {
+                evicted.emplace_back(victim, std::move(pages_[victim]));
+            }
+            pages_.erase(victim);
+            pageOrder_.pop_front();
+        }
+    }
+
+    if (!evicted.empty() && file::ensureDir(dir_)) {
+        for (const auto& [victim, image] : evicted) {
+            if (auto result = writePage(victim, image); !result) {
+                LOG_WARN("Thumbnail atlas: {}", result.error().message);
+            }
+        }
+    }
+
+    QImage image(QString::fromStdString(pagePath(number).string()));
+    QSize size(COLUMNS * THUMB_WIDTH, ROWS * THUMB_HEIGHT);
+    if (image.size() != size) {
+        image = QImage(size, QImage::Format_RGB888);
+        image.fill(Qt::black);
+    } else {
+        image = image.convertToFormat(QImage::Format_RGB888);
+    }
+
+    std::lock_guard lock(mutex_);
+    pageOrder_.push_back(number);
+    pages_[number] = std::move(image);
+}
+
+fs::path ThumbnailAtlas::pagePath(u32 number) const {
+    return dir_ / std::format("page_{}.jpg", number);
+}
+
+PresetThumbnailer::PresetThumbnailer()
+    : atlas_(file::cacheDir() / "thumbnails")
+{
+}
+
+PresetThumbnailer::~PresetThumbnailer() {
+    stop();
+}
+
+Result<void> PresetThumbnailer::start(const QSurfaceFormat& format) {
+    if (running_) {
+        return Result<void>::ok();
+    }
+
+    surface_ = std::make_unique<QOffscreenSurface>();
+    surface_->setFormat(format);
+    surface_->create();
+
+    // Not shared with the live context: nothing here is ever drawn there
+    context_ = std::make_unique<QOpenGLContext>();
+    context_->setFormat(format);
+    if (!context_->create()) {
+        context_.reset();
+        surface_.reset();
+        return Result<void>::err("Failed to create thumbnail GL context");
+    }
+
+    stopping_ = false;
+    thread_.reset(QThread::create([this] { run(); }));
+    thread_->setObjectName("vc-thumbs");
+    context_->moveToThread(thread_.get());
+    thread_->start(QThread::LowestPriority);
+
+    running_ = true;
+    return Result<void>::ok();
+}
+
+void PresetThumbnailer::stop() {
+    if (!thread_) return;
+
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    cond_.notify_all();
+
+    thread_->wait();
+    thread_.reset();
+    context_.reset();
+    surface_.reset();
+    running_ = false;
+}
+
+void PresetThumbnailer::request(std::vector<fs::path> paths) {
+    {
+        std::lock_guard lock(mutex_);
+        queue_.assign(std::make_move_iterator(paths.begin()), std::make_move_iterator(paths.end()));
+        if (queue_.empty()) return;
+    }
+    cond_.notify_one();
+}
+
+std::optional<QImage> PresetThumbnailer::find(const fs::path& path) {
+    return atlas_.find(path, mtimeOf(path));
+}
+
+void PresetThumbnailer::run() {
+    atlas_.load();
+    clip_ = PresetCensus::referenceClip(PresetCensus::SAMPLE_RATE, 4.0f);
+
+    if (!context_->makeCurrent(surface_.get())) {
+        LOG_WARN("Preset thumbnails: no GL context");
+        context_->moveToThread(QCoreApplication::instance()->thread());
+        return;
+    }
+    target_.create(ThumbnailAtlas::THUMB_WIDTH, ThumbnailAtlas::THUMB_HEIGHT);
+
+    usize unsaved = 0;
+    while (true) {
+        fs::path path;
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) break;
+
+            path = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        i64 mtime = mtimeOf(path);
+        if (!atlas_.prepare(path, mtime)) {
+            render(path, mtime);
+            if (stopping_) break;
+            ++unsaved;
+        }
+        thumbnailReady.emitSignal(path);
+
+        if (unsaved >= FLUSH_EVERY) {
+            if (auto result = atlas_.flush(); !result) {
+                LOG_WARN("Thumbnail atlas: {}", result.error().message);
+            }
+            unsaved = 0;
+        }
+    }
+
+    if (auto result = atlas_.flush(); !result) {
+        LOG_WARN("Thumbnail atlas: {}", result.error().message);
+    }
+
+    target_.destroy();
+    context_->doneCurrent();
+    context_->moveToThread(QCoreApplication::instance()->thread());
+}
+
+void PresetThumbnailer::render(const fs::path& path, i64 mtime) {
+    constexpr u32 W = ThumbnailAtlas::THUMB_WIDTH;
+    constexpr u32 H = ThumbnailAtlas::THUMB_HEIGHT;
+
+    // A fresh instance per preset, like the census: nothing carries over
+    projectm_handle pm = projectm_create();
+    if (!pm) return;
+    projectm_set_window_size(pm, W, H);
+    projectm_set_fps(pm, FPS);
+    projectm_set_mesh_size(pm, 32, 24);
+    projectm_set_preset_locked(pm, true);
+    projectm_load_preset_file(pm, path.c_str(), false);
+
+    const usize frameSamples = PresetCensus::SAMPLE_RATE / FPS;
+    usize cursor = 0;
+    for (u32 f = 0; f < FRAMES && !stopping_; ++f) {
+        usize count = std::min(frameSamples * 2, clip_.size() - cursor);
+        projectm_pcm_add_float(pm, clip_.data() + cursor, count / 2, PROJECTM_STEREO);
+        cursor = (cursor + count) % clip_.size();
+
+        target_.bind();
+        projectm_opengl_render_frame(pm);
+        target_.unbind();
+
+        // Finish and step aside, so this never queues up work in front of a live frame
+        glFinish();
+        QThread::msleep(FRAME_PAUSE_MS);
+    }
+
+    if (!stopping_) {
+        QImage image(W, H, QImage::Format_RGBA8888);
+        target_.readPixels(image.bits());
+        atlas_.add(path, mtime, image.mirrored());  // GL rows are bottom-up
+    }
+
+    projectm_destroy(pm);
+    LOG_DEBUG("Rendered thumbnail: {}", path.filename().string());
+}
+
+} // namespace vc
@@ -0,0 +1,129 @@
+#pragma once
+// PresetThumbnailer.hpp - Preset previews rendered offscreen, kept in a JPEG atlas
+// Browsing 50k presets by name is archaeology. By picture it's shopping.
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "util/Signal.hpp"
+#include "RenderTarget.hpp"
+#include "projectM-4/projectM.h"
+
+#include <QImage>
+#include <QSurfaceFormat>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QThread;
+
+namespace vc {
+
+// Fixed-size thumbnails packed into JPEG pages under one directory, with a
+// text index. Entries are keyed by preset path and file mtime, so an
+// edited preset gets rendered again. Pages load lazily, a few at a time,
+// and only on the thumbnailer thread: JPEG work never lands on the GUI.
+class ThumbnailAtlas {
+public:
+    static constexpr u32 THUMB_WIDTH = 160;
+    static constexpr u32 THUMB_HEIGHT = 90;
+    static constexpr u32 COLUMNS = 16;
+    static constexpr u32 ROWS = 16;
+
+    explicit ThumbnailAtlas(fs::path dir);
+
+    void load();
+    Result<void> flush();   // Write changed pages, then the index
+
+    // Any thread. Looks at loaded pages only, so a preset whose page is
+    // on disk misses until prepare() has brought it in.
+    std::optional<QImage> find(const fs::path& preset, i64 mtime);
+
+    // Thumbnailer thread
+    bool prepare(const fs::path& preset, i64 mtime);   // Load its page; false if not in the atlas
+    void add(const fs::path& preset, i64 mtime, const QImage& thumbnail);
+
+private:
+    struct Slot {
+        u32 index{0};   // page = index / per page, then row-major within it
+        i64 mtime{0};
+    };
+
+    void loadPage(u32 number);  // Mutex not held; decodes, and writes the dirty pages it evicts
+    fs::path pagePath(u32 number) const;
+    Result<void> writePage(u32 number, const QImage& image) const;
+
+    fs::path dir_;
+    std::unordered_map<std::string, Slot> slots_;   // Keyed by path.native()
+    u32 nextIndex_{0};
+
+    std::map<u32, QImage> pages_;   // Loaded pages
+    std::list<u32> pageOrder_;      // Most recently used at the back
+    std::set<u32> dirtyPages_;
+    bool indexDirty_{false};
+    mutable std::mutex mutex_;
+
+    static constexpr usize MAX_LOADED_PAGES = 6;
+    static constexpr int JPEG_QUALITY = 85;
+};
+
+// Renders requested presets at thumbnail size on its own thread and GL
+// context, at the lowest thread priority, with a short pause between
+// frames so the live renderer always gets the GPU first.
+class PresetThumbnailer {
+public:
+    PresetThumbnailer();
+    ~PresetThumbnailer();
+
+    // Non-copyable
+    PresetThumbnailer(const PresetThumbnailer&) = delete;
+    PresetThumbnailer& operator=(const PresetThumbnailer&) = delete;
+
+    // GUI thread (the offscreen surface must be created there)
+    Result<void> start(const QSurfaceFormat& format);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Replace the wish list, most wanted first (e.g. the rows on screen).
+    // Any thread; fine to call before start().
+    void request(std::vector<fs::path> paths);
+
+    // A thumbnail already in the atlas. Any thread.
+    std::optional<QImage> find(const fs::path& path);
+
+    // Thumbnailer thread: a preset's thumbnail is available through find()
+    Signal<const fs::path&> thumbnailReady;
+
+private:
+    void run();
+    void render(const fs::path& path, i64 mtime);
+
+    std::unique_ptr<QThread> thread_;
+    std::unique_ptr<QOpenGLContext> context_;
+    std::unique_ptr<QOffscreenSurface> surface_;
+    ThumbnailAtlas atlas_;
+
+    RenderTarget target_;
+    std::vector<f32> clip_;     // Reference audio shared with the preset census
+
+    std::deque<fs::path> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> running_{false};
+
+    static constexpr u32 FPS = 30;
+    static constexpr u32 FRAMES = 75;           // 2.5 s in, past the first-beat flash
+    static constexpr u32 FRAME_PAUSE_MS = 2;    // Yield the GPU between frames
+    static constexpr u32 FLUSH_EVERY = 16;      // Thumbnails between atlas writes
+};
+
+} // namespace vc
@@ -3,6 +3,8 @@
 #include "core/Config.hpp"
 #include "core/Logger.hpp"
 
+#include <chrono>
+
 namespace vc {
 
 ProjectMBridge::ProjectMBridge() = default;
@@ -31,11 +33,24 @@ Result<void> ProjectMBridge::init(const ProjectMConfig& config) {
     projectm_set_beat_sensitivity(projectM_, config.beatSensitivity);
     projectm_set_preset_duration(projectM_, config.presetDuration);
     projectm_set_soft_cut_duration(projectM_, config.transitionDuration);
-    projectm_set_mesh_size(projectM_, config.meshX, config.meshY);
+    mesh_ = {config.meshX, config.meshY};
+    projectm_set_mesh_size(projectM_, mesh_.x, mesh_.y);
     projectm_set_preset_locked(projectM_, false);
     
-    // Load presets
-    if (!config.presetPath.empty() && fs::exists(config.presetPath)) {
+    // Without a playlist ProjectM only asks for the next preset; the
+    // preset manager answers, on the GUI thread that owns it
+    shuffle_ = config.shufflePresets;
+    persistState_ = config.persistState;
+    projectm_set_preset_switch_requested_event_callback(projectM_, &ProjectMBridge::onSwitchRequested, this);
+    
+    meshTuner_.configure(config.autoMesh, mesh_, config.fps, config.transitionDuration);
+    if (meshTuner_.enabled()) {
+        meshTuner_.load(file::cacheDir() / "preset_mesh.txt");
+    }
+    
+    // Load presets. Extra instances get theirs from the owner of the one
+    // real list, which also keeps preset_index.bin to a single writer.
+    if (persistState_ && !config.presetPath.empty() && fs::exists(config.presetPath)) {
         auto result = presets_.scan(config.presetPath);
         if (!result) {
             LOG_WARN("Failed to scan presets: {}", result.error().message);
@@ -44,6 +59,11 @@ Result<void> ProjectMBridge::init(const ProjectMConfig& config) {
         // Load state (favorites/blacklist)
         auto statePath = file::configDir() / "preset_state.txt";
         presets_.loadState(statePath);
+        
+        // Render costs from the last `--preset-census`, if any
+        presets_.loadCensus(file::cacheDir() / "preset_census.tsv");
+        presets_.setFrameBudget(1000.0f / std::max(config.fps, 1u), config.skipSlowPresets);
+        presets_.setPacing(config.pacePresets);
     }
     
     // Connect preset manager
@@ -66,13 +86,23 @@ Result<void> ProjectMBridge::init(const ProjectMConfig& config) {
 
 void ProjectMBridge::shutdown() {
     if (projectM_) {
-        // Save preset state
-        auto statePath = file::configDir() / "preset_state.txt";
-        presets_.saveState(statePath);
+        // Save preset state; an extra instance never loaded it, so writing
+        // would wipe the user's favorites
+        if (persistState_) {
+            auto statePath = file::configDir() / "preset_state.txt";
+            presets_.saveState(statePath);
+            
+            if (auto result = meshTuner_.save(file::cacheDir() / "preset_mesh.txt"); !result) {
+                LOG_WARN("Failed to save preset mesh sizes: {}", result.error().message);
+            }
+        }
         
         projectm_destroy(projectM_);
         projectM_ = nullptr;
         
+        std::lock_guard lock(pendingMutex_);
+        pending_.clear();
+        
         LOG_INFO("ProjectM shutdown");
     }
 }
@@ -85,36 +115,79 @@ void ProjectMBridge::render() {
 void ProjectMBridge::renderToTarget(RenderTarget& target) {
     if (!projectM_) return;
     
+    runPending();
+    
     // Resize if needed
     if (target.width() != width_ || target.height() != height_) {
         resize(target.width(), target.height());
     }
     
+    // Per-vertex equations run on the CPU inside this call
+    auto start = std::chrono::steady_clock::now();
     target.bind();
     projectm_opengl_render_frame(projectM_);
     target.unbind();
+    f32 ms = std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    if (meshTuner_.update(ms)) {
+        applyMesh(meshTuner_.size());
+    }
+}
+
+void ProjectMBridge::applyMesh(MeshSize size) {
+    if (size.x == mesh_.x && size.y == mesh_.y) return;
+    mesh_ = size;
+    projectm_set_mesh_size(projectM_, mesh_.x, mesh_.y);
+}
+
+void ProjectMBridge::runPending() {
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard lock(pendingMutex_);
+        pending.swap(pending_);
+    }
+    
+    for (auto& fn : pending) {
+        fn();
+    }
+}
+
+void ProjectMBridge::dispatch(std::function<void()> fn) {
+    auto renderThread = renderThread_.load();
+    if (renderThread == std::thread::id{} || renderThread == std::this_thread::get_id()) {
+        fn();
+        return;
+    }
+    
+    std::lock_guard lock(pendingMutex_);
+    pending_.push_back(std::move(fn));
 }
 
 void ProjectMBridge::addPCMData(const f32* data, u32 samples, u32 channels) {
     if (!projectM_) return;
     
-    if (channels == 1) {
-        projectm_pcm_add_float(projectM_, data, samples, PROJECTM_MONO);
-    } else {
-        // v4 API: pass interleaved stereo directly
-        projectm_pcm_add_float(projectM_, data, samples * channels, PROJECTM_STEREO);
-    }
+    u32 count = channels == 1 ? samples : samples * channels;
+    dispatch([this, pcm = std::vector<f32>(data, data + count), channels] {
+        if (!projectM_) return;
+        if (channels == 1) {
+            projectm_pcm_add_float(projectM_, pcm.data(), pcm.size(), PROJECTM_MONO);
+        } else {
+            // v4 API: pass interleaved stereo directly
+            projectm_pcm_add_float(projectM_, pcm.data(), pcm.size(), PROJECTM_STEREO);
+        }
+    });
 }
 
 void ProjectMBridge::addPCMDataInterleaved(const f32* data, u32 frames, u32 channels) {
     if (!projectM_) return;
+    if (channels != 1 && channels != 2) return;
     
-    if (channels == 1) {
-        projectm_pcm_add_float(projectM_, data, frames, PROJECTM_MONO);
-    } else if (channels == 2) {
+    dispatch([this, pcm = std::vector<f32>(data, data + frames * channels), channels] {
+        if (!projectM_) return;
         // v4 API: pass interleaved stereo directly
-        projectm_pcm_add_float(projectM_, data, frames * 2, PROJECTM_STEREO);
-    }
+        projectm_pcm_add_float(projectM_, pcm.data(), pcm.size(),
+                               channels == 1 ? PROJECTM_MONO : PROJECTM_STEREO);
+    });
 }
 
 void ProjectMBridge::resize(u32 width, u32 height) {
@@ -129,24 +202,33 @@ void ProjectMBridge::resize(u32 width, u32 height) {
 }
 
 void ProjectMBridge::setFPS(u32 fps) {
-    if (projectM_) {
-        projectm_set_fps(projectM_, fps);
-    }
+    dispatch([this, fps] {
+        if (projectM_) {
+            projectm_set_fps(projectM_, fps);
+            meshTuner_.setFps(fps);
+        }
+    });
 }
 
 void ProjectMBridge::setBeatSensitivity(f32 sensitivity) {
-    if (projectM_) {
-        projectm_set_beat_sensitivity(projectM_, sensitivity);
-    }
+    dispatch([this, sensitivity] {
+        if (projectM_) {
+            projectm_set_beat_sensitivity(projectM_, sensitivity);
+        }
+    });
 }
 
 void ProjectMBridge::loadPreset(const fs::path& path, bool smooth) {
     if (!projectM_) return;
     
-    projectm_load_preset_file(projectM_, path.c_str(), smooth);
-    presetChanged.emitSignal(path.stem().string());
-    
-    LOG_DEBUG("Loaded preset: {}", path.filename().string());
+    dispatch([this, path, smooth, key = presets_.keyOf(path)] {
+        if (!projectM_) return;
+        applyMesh(meshTuner_.beginPreset(key));
+        projectm_load_preset_file(projectM_, path.c_str(), smooth);
+        presetChanged.emitSignal(path.stem().string());
+        
+        LOG_DEBUG("Loaded preset: {}", path.filename().string());
+    });
 }
 
 void ProjectMBridge::nextPreset(bool smooth) {
@@ -173,11 +255,27 @@ void ProjectMBridge::randomPreset(bool smooth) {
     }
 }
 
+void ProjectMBridge::advancePreset() {
+    if (presetLocked_) return;
+    
+    if (shuffle_) {
+        presets_.selectRandom();
+    } else {
+        presets_.selectNext(true);
+    }
+}
+
+void ProjectMBridge::onSwitchRequested(bool /*hardCut*/, void* user) {
+    static_cast<ProjectMBridge*>(user)->presetSwitchRequested.emitSignal();
+}
+
 void ProjectMBridge::lockPreset(bool locked) {
     presetLocked_ = locked;
-    if (projectM_) {
-        projectm_set_preset_locked(projectM_, locked);
-    }
+    dispatch([this, locked] {
+        if (projectM_) {
+            projectm_set_preset_locked(projectM_, locked);
+        }
+    });
 }
 
 std::string ProjectMBridge::currentPresetName() const {
@@ -187,11 +285,39 @@ std::string ProjectMBridge::currentPresetName() const {
     return "No preset";
 }
 
+void ProjectMBridge::setPreloader(PresetPreloader* preloader, u32 count) {
+    preloadCount_ = count;
+    preloader_ = count > 0 ? preloader : nullptr;
+    
+    if (auto* p = preloader_.load()) {
+        p->request(presets_.upcoming(preloadCount_));
+    }
+}
+
 void ProjectMBridge::onPresetManagerChanged(const PresetInfo* preset) {
     if (!preset || !projectM_) return;
     
-    projectm_load_preset_file(projectM_, preset->path.c_str(), true);
-    presetChanged.emitSignal(preset->name);
+    // The PresetInfo may move if the list changes before the render thread gets to it
+    dispatch([this, path = preset->path, name = preset->name, key = presets_.keyOf(preset->path)] {
+        if (!projectM_) return;
+        
+        applyMesh(meshTuner_.beginPreset(key));
+        
+        // Preloaded source skips the disk, and its shaders are already in
+        // the driver's cache, so this is mostly a cache lookup
+        auto* preloader = preloader_.load();
+        auto data = preloader ? preloader->find(path) : nullptr;
+        if (data) {
+            projectm_load_preset_data(projectM_, data->c_str(), true);
+        } else {
+            projectm_load_preset_file(projectM_, path.c_str(), true);
+        }
+        presetChanged.emitSignal(name);
+    });
+    
+    if (auto* preloader = preloader_.load()) {
+        preloader->request(presets_.upcoming(preloadCount_));
+    }
 }
 
 } // namespace vc
\ No newline at end of file
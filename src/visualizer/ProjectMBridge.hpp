@@ -7,12 +7,18 @@
 #include "util/Signal.hpp"
 #include "PresetManager.hpp"
 #include "RenderTarget.hpp"
+#include "PresetPreloader.hpp"
+#include "MeshTuner.hpp"
 
 // include <projectM-4/projectM.h>
 // include <external/projectm-install/include/projectM-4/projectM.h>
 // #include "external/projectm-install/include/projectM-4/projectM.h"
 #include "projectM-4/projectM.h"
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
 
 namespace vc {
 
@@ -27,6 +33,13 @@ struct ProjectMConfig {
     bool shufflePresets{true};
     u32 meshX{128};
     u32 meshY{96};
+    bool autoMesh{true};        // Lower the mesh for presets that can't keep up
+    bool skipSlowPresets{true}; // Per the preset census, see PresetManager::setFrameBudget
+    bool pacePresets{true};     // Keep heavy presets apart, see PresetManager::setPacing
+    u32 preloadCount{3};        // Upcoming presets to read and warm up, 0 = off
+    u32 shaderCacheMB{512};     // Shared with the driver cache, see ProgramBinaryCache::shareOf; 0 = off
+    bool persistState{true};    // Off for extra instances (ProjectMHost): no preset scan, and
+                                // favorites, blacklist and mesh sizes are never written back
 };
 
 class ProjectMBridge {
@@ -47,6 +60,16 @@ public:
     void render();
     void renderToTarget(RenderTarget& target);
     
+    // ProjectM isn't thread-safe and needs the GL context. Once a render
+    // thread is set, calls from other threads are queued and run before
+    // its next frame.
+    void setRenderThread(std::thread::id id) { renderThread_ = id; }
+    void runPending();
+    
+    // Preset switches use preloaded source when available, and each switch
+    // queues the next candidates. Null detaches.
+    void setPreloader(PresetPreloader* preloader, u32 count);
+    
     // Audio input
     void addPCMData(const f32* data, u32 samples, u32 channels);
     void addPCMDataInterleaved(const f32* data, u32 frames, u32 channels);
@@ -67,6 +90,9 @@ public:
     void lockPreset(bool locked);
     bool isPresetLocked() const { return presetLocked_; }
     
+    // Timed switch: random or next per the shuffle setting, paced
+    void advancePreset();
+    
     // Info
     u32 width() const { return width_; }
     u32 height() const { return height_; }
@@ -74,9 +100,13 @@ public:
     
     // Signals
     Signal<std::string> presetChanged;
+    Signal<> presetSwitchRequested;  // Preset duration ran out (render thread)
     
 private:
     void onPresetManagerChanged(const PresetInfo* preset);
+    void dispatch(std::function<void()> fn);
+    void applyMesh(MeshSize size);
+    static void onSwitchRequested(bool hardCut, void* user);
     
     projectm_handle projectM_{nullptr};
     PresetManager presets_;
@@ -84,6 +114,16 @@ private:
     u32 width_{1920};
     u32 height_{1080};
     bool presetLocked_{false};
+    bool shuffle_{true};
+    bool persistState_{true};
+    MeshTuner meshTuner_;
+    MeshSize mesh_;
+    
+    std::atomic<std::thread::id> renderThread_{};
+    std::atomic<PresetPreloader*> preloader_{nullptr};
+    u32 preloadCount_{0};
+    std::vector<std::function<void()>> pending_;
+    std::mutex pendingMutex_;
 };
 
 } // namespace vc
@@ -0,0 +1,317 @@
+#include "ProjectMHost.hpp"
+#include "core/Logger.hpp"
+
+#include <QCoreApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QThread>
+#include <algorithm>
+#include <future>
+
+namespace vc {
+
+ProjectMHost::ProjectMHost() = default;
+
+ProjectMHost::~ProjectMHost() {
+    stop();
+}
+
+Result<void> ProjectMHost::start(const QSurfaceFormat& format, u32 fps) {
+    if (running_) {
+        return Result<void>::ok();
+    }
+
+    surface_ = std::make_unique<QOffscreenSurface>();
+    surface_->setFormat(format);
+    surface_->create();
+
+    context_ = std::make_unique<QOpenGLContext>();
+    context_->setFormat(format);
+    context_->setShareContext(QOpenGLContext::globalShareContext());
+    if (!context_->create()) {
+        context_.reset();
+        surface_.reset();
+        return Result<void>::err("Failed to create ProjectM host GL context");
+    }
+
+    fps_ = fps;
+    stopping_ = false;
+    thread_.reset(QThread::create([this] { run(); }));
+    thread_->setObjectName("vc-pmhost");
+    context_->moveToThread(thread_.get());
+    thread_->start();
+
+    running_ = true;
+    return Result<void>::ok();
+}
+
+void ProjectMHost::stop() {
+    if (!thread_) return;
+
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    cond_.notify_all();
+
+    thread_->wait();
+    thread_.reset();
+    context_.reset();
+    surface_.reset();
+    running_ = false;
+}
+
+Result<u32> ProjectMHost::addInstance(const ProjectMConfig& config) {
+    if (!running_) {
+        return Result<u32>::err("ProjectM host not running");
+    }
+
+    // One PresetManager writes the shared state files; it isn't us
+    ProjectMConfig instanceConfig = config;
+    instanceConfig.persistState = false;
+    instanceConfig.presetPath.clear();
+
+    Result<u32> result = Result<u32>::err("ProjectM host stopped");
+    invoke([this, &config = instanceConfig, &result] {
+        auto instance = std::make_unique<Instance>();
+        instance->bridge = std::make_unique<ProjectMBridge>();
+        instance->width = std::max(2u, config.width);
+        instance->height = std::max(2u, config.height);
+
+        // Set before init so nothing queues: we are the render thread
+        instance->bridge->setRenderThread(std::this_thread::get_id());
+        if (auto init = instance->bridge->init(config); !init) {
+            result = Result<u32>::err(init.error().message);
+            return;
+        }
+        if (auto created = instance->target.create(instance->width, instance->height); !created) {
+            instance->bridge->shutdown();
+            result = Result<u32>::err(created.error().message);
+            return;
+        }
+
+        // Raised inside the render call; load outside it, on the next command pass
+        u32 id = nextId_++;
+        instance->id = id;
+        instance->bridge->presetSwitchRequested.connect([this, id] {
+            post([this, id] { switchPreset(id); });
+        });
+
+        std::lock_guard lock(instancesMutex_);
+        result = Result<u32>::ok(id);
+        instances_.push_back(std::move(instance));
+    });
+
+    if (result) {
+        LOG_INFO("ProjectM host: instance {} added ({}x{})", result.value(),
+                 config.width, config.height);
+    }
+    return result;
+}
+
+void ProjectMHost::removeInstance(u32 id) {
+    invoke([this, id] {
+        std::unique_ptr<Instance> removed;
+        {
+            std::lock_guard lock(instancesMutex_);
+            auto it = std::find_if(instances_.begin(), instances_.end(),
+                                   [id](const auto& i) { return i->id == id; });
+            if (it == instances_.end()) return;
+            removed = std::move(*it);
+            instances_.erase(it);
+        }
+
+        // GL teardown needs the context, so it happens here, not in the caller
+        removed->bridge->shutdown();
+        removed->target.destroy();
+    });
+}
+
+usize ProjectMHost::instanceCount() const {
+    std::lock_guard lock(instancesMutex_);
+    return instances_.size();
+}
+
+void ProjectMHost::feedAudio(u32 id, const f32* data, u32 frames, u32 channels) {
+    std::lock_guard lock(instancesMutex_);
+    for (auto& instance : instances_) {
+        if (instance->id == id) {
+            instance->bridge->addPCMDataInterleaved(data, frames, channels);
+            return;
+        }
+    }
+}
+
+void ProjectMHost::loadPreset(u32 id, const fs::path& path, bool smooth) {
+    post([this, id, path, smooth] {
+        if (auto* instance = find(id)) {
+            load(*instance, path, smooth);
+        }
+    });
+}
+
+void ProjectMHost::setPresets(std::vector<fs::path> paths) {
+    std::lock_guard lock(presetsMutex_);
+    presets_ = std::move(paths);
+}
+
+ProjectMHost::Instance* ProjectMHost::find(u32 id) {
+    for (auto& instance : instances_) {
+        if (instance->id == id) return instance.get();
+    }
+    return nullptr;
+}
+
+void ProjectMHost::load(Instance& instance, const fs::path& path, bool smooth) {
+    instance.bridge->loadPreset(path, smooth);
+    presetLoaded.emitSignal(instance.id, path);
+}
+
+void ProjectMHost::switchPreset(u32 id) {
+    auto* instance = find(id);
+    if (!instance) return;
+
+    fs::path next;
+    {
+        std::lock_guard lock(presetsMutex_);
+        if (presets_.empty()) return;
+        std::uniform_int_distribution<usize> pick(0, presets_.size() - 1);
+        next = presets_[pick(rng_)];
+    }
+    load(*instance, next, true);
+}
+
+void ProjectMHost::step() {
+    invoke([this] { renderAll(); });
+}
+
+void ProjectMHost::post(std::function<void()> fn) {
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_) return;  // Dropping fn breaks any promise it holds
+        commands_.push_back(std::move(fn));
+    }
+    cond_.notify_one();
+}
+
+void ProjectMHost::invoke(std::function<void()> fn) {
+    if (!running_ || stopping_) return;
+
+    // From a frameRendered handler: we're already there
+    if (hostThread_.load() == std::this_thread::get_id()) {
+        fn();
+        return;
+    }
+
+    // If the host stops first the command is dropped along with the
+    // promise, which wakes us with broken_promise
+    auto done = std::make_shared<std::promise<void>>();
+    auto future = done->get_future();
+    post([fn = std::move(fn), done] {
+        fn();
+        done->set_value();
+    });
+
+    try {
+        future.get();
+    } catch (const std::future_error&) {
+    }
+}
+
+bool ProjectMHost::runCommands() {
+    std::deque<std::function<void()>> commands;
+    {
+        std::lock_guard lock(mutex_);
+        commands.swap(commands_);
+    }
+    for (auto& fn : commands) {
+        fn();
+    }
+    return !commands.empty();
+}
+
+void ProjectMHost::run() {
+    hostThread_ = std::this_thread::get_id();
+    bool haveContext = context_->makeCurrent(surface_.get());
+    bool ready = haveContext;
+    if (!haveContext) {
+        LOG_ERROR("ProjectM host: failed to make context current");
+    } else {
+        // Batch jobs have no widget to have resolved GLEW's entry points;
+        // re-running it with a context from the same share group is harmless
+        glewExperimental = GL_TRUE;
+        if (GLenum err = glewInit(); err != GLEW_OK) {
+            LOG_ERROR("ProjectM host: GLEW init failed: {}",
+                      reinterpret_cast<const char*>(glewGetErrorString(err)));
+            ready = false;
+        }
+    }
+
+    if (fps_ > 0) {
+        pacer_.start(fps_);
+    }
+
+    while (ready && !stopping_) {
+        runCommands();
+
+        if (fps_ == 0) {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this] { return stopping_ || !commands_.empty(); });
+            continue;
+        }
+
+        pacer_.beginFrame();
+        renderAll();
+
+        // Commands wake us early; the deadline stays where it was
+        auto deadline = pacer_.nextDeadline();
+        std::unique_lock lock(mutex_);
+        while (!stopping_ && FramePacer::Clock::now() < deadline) {
+            if (!commands_.empty()) {
+                lock.unlock();
+                runCommands();
+                lock.lock();
+                continue;
+            }
+            cond_.wait_until(lock, deadline);
+        }
+    }
+
+    // Drop queued work and refuse more (invoke() callers see a broken
+    // promise and return), also when we bail out early without a context
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        commands_.clear();
+    }
+
+    {
+        std::lock_guard lock(instancesMutex_);
+        for (auto& instance : instances_) {
+            instance->bridge->shutdown();
+            instance->target.destroy();
+        }
+        instances_.clear();
+    }
+
+    if (haveContext) {
+        context_->doneCurrent();
+    }
+    context_->moveToThread(QCoreApplication::instance()->thread());
+    hostThread_ = std::thread::id{};
+}
+
+void ProjectMHost::renderAll() {
+    // Only this thread changes the list, so iterating without the lock is safe
+    for (auto& instance : instances_) {
+        instance->bridge->renderToTarget(instance->target);
+
+        // Kick the GPU now so it works on this instance while the CPU
+        // evaluates the next one's equations
+        glFlush();
+
+        frameRendered.emitSignal(instance->id, instance->target);
+    }
+}
+
+} // namespace vc
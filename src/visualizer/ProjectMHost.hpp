@@ -0,0 +1,119 @@
+#pragma once
+// ProjectMHost.hpp - Several ProjectM instances, one GL context
+// Why run eight copies of Qt when one can juggle
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "util/Signal.hpp"
+#include "ProjectMBridge.hpp"
+#include "RenderTarget.hpp"
+#include "FramePacer.hpp"
+
+#include <QSurfaceFormat>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QThread;
+
+namespace vc {
+
+// Drives K independent ProjectM instances (own preset, own audio) into
+// their own RenderTargets from a single thread and context in the global
+// share group. Frames are interleaved: each instance's draw calls are
+// flushed before the next one's CPU work starts, so the GPU chews on one
+// while the per-vertex equations of the next run.
+//
+// Instances are created with persistState off and own no preset list:
+// when one asks for a new preset the host picks from setPresets(), a copy
+// of the application's single PresetManager.
+class ProjectMHost {
+public:
+    ProjectMHost();
+    ~ProjectMHost();
+
+    // Non-copyable
+    ProjectMHost(const ProjectMHost&) = delete;
+    ProjectMHost& operator=(const ProjectMHost&) = delete;
+
+    // GUI thread (the offscreen surface must be created there).
+    // fps > 0 renders continuously (grid previews); 0 renders only on
+    // step(), for batch jobs that feed audio frame by frame.
+    Result<void> start(const QSurfaceFormat& format, u32 fps);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Any thread; block until the host thread has done the work.
+    // persistState is forced off, presetPath is ignored.
+    Result<u32> addInstance(const ProjectMConfig& config);
+    void removeInstance(u32 id);
+    usize instanceCount() const;
+
+    // Any thread. Queued on the instance and consumed by its next frame.
+    void feedAudio(u32 id, const f32* data, u32 frames, u32 channels);
+    void loadPreset(u32 id, const fs::path& path, bool smooth = false);
+
+    // What instances switch to when their preset runs out, picked at
+    // random. Any thread; the PresetManager itself stays with its owner.
+    void setPresets(std::vector<fs::path> paths);
+
+    // Batch mode: render one frame of every instance, returns when done
+    // (after all frameRendered handlers ran)
+    void step();
+
+    // Host thread with its context current; read back or copy here
+    Signal<u32, RenderTarget&> frameRendered;
+
+    // Host thread: an instance started loading a preset
+    Signal<u32, const fs::path&> presetLoaded;
+
+private:
+    struct Instance {
+        u32 id;
+        std::unique_ptr<ProjectMBridge> bridge;
+        RenderTarget target;
+        u32 width;
+        u32 height;
+    };
+
+    void run();
+    void renderAll();
+    Instance* find(u32 id);                   // Host thread
+    void load(Instance& instance, const fs::path& path, bool smooth);
+    void switchPreset(u32 id);
+    void post(std::function<void()> fn);      // Fire and forget
+    void invoke(std::function<void()> fn);    // Wait for completion
+    bool runCommands();
+
+    std::unique_ptr<QThread> thread_;
+    std::unique_ptr<QOpenGLContext> context_;
+    std::unique_ptr<QOffscreenSurface> surface_;
+    FramePacer pacer_;
+    u32 fps_{0};
+
+    // Owned by the host thread; mutex_ guards the list for lookups elsewhere
+    std::vector<std::unique_ptr<Instance>> instances_;
+    mutable std::mutex instancesMutex_;
+    u32 nextId_{1};
+
+    std::vector<fs::path> presets_;
+    std::mt19937 rng_{std::random_device{}()};
+    std::mutex presetsMutex_;
+
+    std::deque<std::function<void()>> commands_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::atomic<std::thread::id> hostThread_{};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> running_{false};
+};
+
+} // namespace vc
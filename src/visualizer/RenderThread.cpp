@@ -0,0 +1,385 @@
+#include "RenderThread.hpp"
+#include "core/Logger.hpp"
+#include "overlay/OverlayEngine.hpp"
+#include "util/FileUtils.hpp"
+
+#include <QCoreApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QThread>
+#include <algorithm>
+
+namespace vc {
+
+RenderThread::RenderThread(ProjectMBridge& projectM)
+    : projectM_(projectM)
+{
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+Result<void> RenderThread::start(const ProjectMConfig& config, const QSurfaceFormat& format) {
+    if (running_) {
+        return Result<void>::ok();
+    }
+
+    config_ = config;
+    fps_ = config.fps;
+    {
+        std::lock_guard lock(settingsMutex_);
+        viewWidth_ = std::max(1u, config.width);
+        viewHeight_ = std::max(1u, config.height);
+    }
+
+    // Surface and context are created here, the context then moves over.
+    // Sharing with the global context keeps textures valid across widget
+    // reparenting (fullscreen toggles recreate the widget's context).
+    surface_ = std::make_unique<QOffscreenSurface>();
+    surface_->setFormat(format);
+    surface_->create();
+
+    context_ = std::make_unique<QOpenGLContext>();
+    context_->setFormat(format);
+    context_->setShareContext(QOpenGLContext::globalShareContext());
+    if (!context_->create()) {
+        context_.reset();
+        surface_.reset();
+        return Result<void>::err("Failed to create render thread GL context");
+    }
+
+    programCache_.reset();
+    if (config.shaderCacheMB > 0) {
+        programCache_ = std::make_unique<ProgramBinaryCache>(
+            file::cacheDir() / "programs", ProgramBinaryCache::shareOf(config.shaderCacheMB));
+    }
+
+    initDone_ = false;
+    initError_.clear();
+    stopping_ = false;
+    framesRendered_ = 0;
+
+    thread_.reset(QThread::create([this] { run(); }));
+    thread_->setObjectName("vc-render");
+    context_->moveToThread(thread_.get());
+    thread_->start(QThread::HighPriority);
+
+    std::unique_lock lock(stateMutex_);
+    stateCond_.wait(lock, [this] { return initDone_; });
+
+    if (!initError_.empty()) {
+        lock.unlock();
+        stop();
+        return Result<void>::err(initError_);
+    }
+
+    running_ = true;
+    
+    if (config.preloadCount > 0) {
+        if (auto result = preloader_.start(format); result) {
+            projectM_.setPreloader(&preloader_, config.preloadCount);
+        } else {
+            LOG_WARN("Preset preloading disabled: {}", result.error().message);
+        }
+    }
+    
+    return Result<void>::ok();
+}
+
+void RenderThread::stop() {
+    if (!thread_) return;
+
+    projectM_.setPreloader(nullptr, 0);
+    preloader_.stop();
+
+    {
+        std::lock_guard lock(stateMutex_);
+        stopping_ = true;
+    }
+    stateCond_.notify_all();
+
+    thread_->wait();
+    thread_.reset();
+    context_.reset();
+    surface_.reset();
+    running_ = false;
+}
+
+void RenderThread::setViewSize(u32 width, u32 height) {
+    std::lock_guard lock(settingsMutex_);
+    viewWidth_ = std::max(1u, width);
+    viewHeight_ = std::max(1u, height);
+}
+
+void RenderThread::setRecording(bool recording, u32 width, u32 height) {
+    std::lock_guard lock(settingsMutex_);
+    recording_ = recording;
+    recordWidth_ = width;
+    recordHeight_ = height;
+    if (!recording) {
+        renderScale_ = 1.0f;
+    }
+}
+
+void RenderThread::setRenderScale(f32 scale) {
+    std::lock_guard lock(settingsMutex_);
+    renderScale_ = std::clamp(scale, 0.25f, 1.0f);
+}
+
+void RenderThread::setDynamicResolution(const DynamicResolutionSettings& settings, f32 sharpness) {
+    std::lock_guard lock(settingsMutex_);
+    dynamicSettings_ = settings;
+    upscaleSharpness_ = std::clamp(sharpness, 0.0f, 1.0f);
+    dynamicChanged_ = true;
+}
+
+FrameTimeStats RenderThread::frameStats() const {
+    auto stats = pacer_.stats();
+    stats.renderScale = effectiveScale_;
+    return stats;
+}
+
+void RenderThread::setFps(u32 fps) {
+    {
+        std::lock_guard lock(stateMutex_);
+        fps_ = fps;
+    }
+    stateCond_.notify_all();
+}
+
+void RenderThread::setOverlayEngine(OverlayEngine* engine) {
+    std::lock_guard lock(settingsMutex_);
+    overlayEngine_ = engine;
+}
+
+void RenderThread::run() {
+    if (!context_->makeCurrent(surface_.get())) {
+        std::lock_guard lock(stateMutex_);
+        initError_ = "Failed to make render context current";
+        initDone_ = true;
+        stateCond_.notify_all();
+        context_->moveToThread(QCoreApplication::instance()->thread());
+        return;
+    }
+
+    // GLEW's entry points are process-wide and were resolved by the widget
+    projectM_.setRenderThread(std::this_thread::get_id());
+    auto result = projectM_.init(config_);
+    if (result) {
+        if (programCache_ && !programCache_->init()) {
+            programCache_.reset();
+        }
+        result = compositor_.init(programCache_.get());
+    }
+    if (result) {
+        profiler_.initGL();
+    }
+
+    {
+        std::lock_guard lock(stateMutex_);
+        if (!result) {
+            initError_ = "Render thread init failed: " + result.error().message;
+        }
+        initDone_ = true;
+    }
+    stateCond_.notify_all();
+
+    if (result) {
+        LOG_INFO("Render thread started");
+
+        pacer_.start(fps_);
+
+        while (!stopping_) {
+            u32 fps = fps_;
+            if (fps == 0) {
+                std::unique_lock lock(stateMutex_);
+                stateCond_.wait(lock, [this] { return stopping_ || fps_ > 0; });
+                pacer_.start(std::max<u32>(fps_, 1));
+                continue;
+            }
+            pacer_.setRate(fps);
+
+            pacer_.beginFrame();
+            renderFrame();
+            ++framesRendered_;
+            frameFinished.emitSignal();
+
+            // Sleep most of the way to the deadline, spin the rest
+            auto deadline = pacer_.nextDeadline();
+            {
+                std::unique_lock lock(stateMutex_);
+                if (stateCond_.wait_until(lock, deadline - FramePacer::SPIN_WINDOW,
+                                          [this] { return stopping_.load(); })) {
+                    break;
+                }
+            }
+            FramePacer::spinUntil(deadline);
+        }
+    }
+
+    projectM_.shutdown();
+    projectM_.setRenderThread({});
+    releaseGL();
+
+    context_->doneCurrent();
+    context_->moveToThread(QCoreApplication::instance()->thread());
+    LOG_INFO("Render thread stopped");
+}
+
+void RenderThread::renderFrame() {
+    auto frameStart = FramePacer::Clock::now();
+    profiler_.beginFrame();
+
+    u32 targetW, targetH;
+    f32 scale;
+    bool dynamic;
+    OverlayEngine* overlay;
+    {
+        std::lock_guard lock(settingsMutex_);
+        targetW = recording_ ? recordWidth_ : viewWidth_;
+        targetH = recording_ ? recordHeight_ : viewHeight_;
+        scale = renderScale_;
+        overlay = overlayEngine_;
+        if (dynamicChanged_) {
+            scaler_.configure(dynamicSettings_);
+            compositor_.setSharpness(upscaleSharpness_);
+            dynamicChanged_ = false;
+        }
+        dynamic = dynamicSettings_.enabled && (!recording_ || dynamicSettings_.whileRecording);
+    }
+
+    // The recording governor's scale (encoder pressure) and the dynamic
+    // one (render pressure) both cap the resolution; the lower one wins
+    if (dynamic) {
+        scale = std::min(scale, scaler_.scale());
+    }
+    effectiveScale_ = scale;
+
+    // ProjectM may run below output resolution; the composite scales it back up
+    u32 internalW = std::max(2u, static_cast<u32>(targetW * scale)) & ~1u;
+    u32 internalH = std::max(2u, static_cast<u32>(targetH * scale)) & ~1u;
+
+    if (sceneTarget_.width() != internalW || sceneTarget_.height() != internalH) {
+        sceneTarget_.resize(internalW, internalH);
+    }
+
+    {
+        StageScope stage(profiler_, RenderStage::ProjectM);
+        projectM_.renderToTarget(sceneTarget_);
+    }
+
+    // Claim the back slot: drop a frame nobody presented, and wait (on the
+    // GPU) for the presenter to finish reading what it last showed
+    Slot& slot = slots_[back_];
+    {
+        std::lock_guard lock(swapMutex_);
+        if (slot.rendered) {
+            glDeleteSync(slot.rendered);
+            slot.rendered = nullptr;
+        }
+        if (slot.presented) {
+            glWaitSync(slot.presented, 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(slot.presented);
+            slot.presented = nullptr;
+        }
+    }
+
+    if (slot.target.width() != targetW || slot.target.height() != targetH) {
+        slot.target.resize(targetW, targetH);
+    }
+
+    // Overlay is rasterized at output size, then scene and overlay are
+    // combined in a single pass that writes the output exactly once
+    {
+        StageScope stage(profiler_, RenderStage::Overlay);
+        if (overlay && overlay->render(targetW, targetH)) {
+            compositor_.updateOverlay(*overlay->canvas());
+        } else {
+            compositor_.clearOverlay();
+        }
+    }
+
+    {
+        StageScope stage(profiler_, RenderStage::Composite);
+        compositor_.composite(sceneTarget_, slot.target);
+    }
+
+    {
+        StageScope stage(profiler_, RenderStage::Readback);
+        frameComposited.emitSignal(slot.target);
+    }
+    publish();
+
+    if (dynamic) {
+        f32 cpuMs = std::chrono::duration<f32, std::milli>(
+            FramePacer::Clock::now() - frameStart).count();
+        scaler_.update(cpuMs, profiler_.latestGpuMs(RenderStage::ProjectM),
+                       1000.0f / std::max<u32>(pacer_.rate(), 1));
+    }
+}
+
+void RenderThread::publish() {
+    // Flush so the fence actually reaches the GPU before another context waits on it
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    std::lock_guard lock(swapMutex_);
+    slots_[back_].rendered = fence;
+    std::swap(back_, ready_);
+    fresh_ = true;
+}
+
+bool RenderThread::acquire(PresentedFrame& frame) {
+    std::lock_guard lock(swapMutex_);
+
+    if (fresh_) {
+        std::swap(front_, ready_);
+        fresh_ = false;
+    }
+
+    Slot& slot = slots_[front_];
+    if (!slot.target.isValid()) {
+        return false;
+    }
+
+    if (slot.rendered) {
+        glWaitSync(slot.rendered, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.rendered);
+        slot.rendered = nullptr;
+    }
+
+    frame.texture = slot.target.texture();
+    frame.width = slot.target.width();
+    frame.height = slot.target.height();
+    return true;
+}
+
+void RenderThread::release() {
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    std::lock_guard lock(swapMutex_);
+    Slot& slot = slots_[front_];
+    if (slot.presented) {
+        glDeleteSync(slot.presented);
+    }
+    slot.presented = fence;
+}
+
+void RenderThread::releaseGL() {
+    std::lock_guard lock(swapMutex_);
+    for (auto& slot : slots_) {
+        if (slot.rendered) glDeleteSync(slot.rendered);
+        if (slot.presented) glDeleteSync(slot.presented);
+        slot.rendered = nullptr;
+        slot.presented = nullptr;
+        slot.target.destroy();
+    }
+    sceneTarget_.destroy();
+    compositor_.shutdown();
+    profiler_.releaseGL();
+    fresh_ = false;
+}
+
+} // namespace vc
@@ -0,0 +1,144 @@
+#pragma once
+// RenderThread.hpp - ProjectM rendering off the GUI thread
+// The playlist can take its sweet time, the visuals won't wait
+
+#include "util/Types.hpp"
+#include "util/Result.hpp"
+#include "util/Signal.hpp"
+#include "ProjectMBridge.hpp"
+#include "RenderTarget.hpp"
+#include "FramePacer.hpp"
+#include "Compositor.hpp"
+#include "ShaderCache.hpp"
+#include "DynamicResolution.hpp"
+#include "StageProfiler.hpp"
+
+#include <QSurfaceFormat>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+class QOpenGLContext;
+class QOffscreenSurface;
+class QThread;
+
+namespace vc {
+
+class OverlayEngine;
+
+// A finished frame as seen by the presenting context
+struct PresentedFrame {
+    GLuint texture{0};
+    u32 width{0};
+    u32 height{0};
+};
+
+class RenderThread {
+public:
+    explicit RenderThread(ProjectMBridge& projectM);
+    ~RenderThread();
+
+    // Non-copyable
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // GUI thread. Blocks until ProjectM is initialized, so the preset list
+    // isn't being scanned while the UI reads it.
+    Result<void> start(const ProjectMConfig& config, const QSurfaceFormat& format);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Any thread, picked up at the start of the next frame
+    void setViewSize(u32 width, u32 height);
+    void setRecording(bool recording, u32 width, u32 height);
+    void setRenderScale(f32 scale);
+    void setDynamicResolution(const DynamicResolutionSettings& settings, f32 sharpness);
+    void setFps(u32 fps);  // 0 pauses
+    void setOverlayEngine(OverlayEngine* engine);
+
+    // Render thread: the frame being composited (valid during frameComposited)
+    RenderTarget& currentTarget() { return slots_[back_].target; }
+
+    // Presenting thread, with a context in the global share group.
+    // acquire() promotes the newest finished frame to the front buffer;
+    // its texture stays untouched until the matching release().
+    bool acquire(PresentedFrame& frame);
+    void release();
+
+    u64 framesRendered() const { return framesRendered_; }
+
+    // Frame pacing; notePresent is fed from the widget's buffer swaps
+    FrameTimeStats frameStats() const;
+    
+    // Per-stage CPU/GPU timings of the render thread's stages
+    ProfileReport profile() const { return profiler_.report(); }
+    void notePresent() { pacer_.notePresent(FramePacer::Clock::now()); }
+    void setVsyncAlign(bool enabled) { pacer_.setVsyncAlign(enabled); }
+
+    // Emitted on the render thread with its context current
+    Signal<RenderTarget&> frameComposited;  // Before publishing, readbacks go here
+    Signal<> frameFinished;                 // New frame available to acquire()
+
+private:
+    struct Slot {
+        RenderTarget target;
+        GLsync rendered{nullptr};   // Render thread done writing
+        GLsync presented{nullptr};  // Presenter done reading
+    };
+
+    void run();
+    void renderFrame();
+    void publish();
+    void releaseGL();
+
+    ProjectMBridge& projectM_;
+    ProjectMConfig config_;
+
+    std::unique_ptr<QThread> thread_;
+    std::unique_ptr<QOpenGLContext> context_;
+    std::unique_ptr<QOffscreenSurface> surface_;
+
+    // Triple buffer: the render thread owns back, ready holds the newest
+    // finished frame, the presenter owns front. Indices swap under swapMutex_.
+    std::array<Slot, 3> slots_;
+    u32 back_{0};
+    u32 ready_{1};
+    u32 front_{2};
+    bool fresh_{false};
+    std::mutex swapMutex_;
+
+    RenderTarget sceneTarget_;  // ProjectM output, possibly below output size
+    PresetPreloader preloader_;
+    Compositor compositor_;
+    std::unique_ptr<ProgramBinaryCache> programCache_;
+    FramePacer pacer_;
+    ResolutionScaler scaler_;
+    StageProfiler profiler_;
+
+    // Written from other threads
+    std::mutex settingsMutex_;
+    u32 viewWidth_{1};
+    u32 viewHeight_{1};
+    bool recording_{false};
+    u32 recordWidth_{1920};
+    u32 recordHeight_{1080};
+    f32 renderScale_{1.0f};
+    DynamicResolutionSettings dynamicSettings_;
+    f32 upscaleSharpness_{0.0f};
+    bool dynamicChanged_{true};
+    OverlayEngine* overlayEngine_{nullptr};
+    std::atomic<u32> fps_{60};
+
+    std::mutex stateMutex_;
+    std::condition_variable stateCond_;
+    bool initDone_{false};
+    std::string initError_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<u64> framesRendered_{0};
+    std::atomic<f32> effectiveScale_{1.0f};
+};
+
+} // namespace vc
@@ -0,0 +1,183 @@
+#include "ShaderCache.hpp"
+#include "core/Logger.hpp"
+#include "util/FileUtils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <vector>
+
+namespace vc {
+
+namespace {
+
+constexpr u32 BINARY_MAGIC = 0x56434250;  // "VCBP"
+
+struct BinaryHeader {
+    u32 magic;
+    u32 format;     // GLenum from glGetProgramBinary
+    u64 length;
+};
+
+u64 fnv1a(std::string_view data, u64 hash = 14695981039346656037ull) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string glString(GLenum name) {
+    const auto* s = reinterpret_cast<const char*>(glGetString(name));
+    return s ? s : "";
+}
+
+} // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(fs::path dir, u64 maxBytes)
+    : dir_(std::move(dir))
+    , maxBytes_(maxBytes)
+{
+}
+
+bool ProgramBinaryCache::init() {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        LOG_DEBUG("Program binaries not supported by this driver");
+        enabled_ = false;
+        return false;
+    }
+
+    driverKey_ = glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION);
+    enabled_ = file::ensureDir(dir_).isOk();
+    return enabled_;
+}
+
+GLuint ProgramBinaryCache::load(std::string_view vertexSource, std::string_view fragmentSource) {
+    if (!enabled_) return 0;
+
+    fs::path path = pathFor(vertexSource, fragmentSource);
+    std::lock_guard lock(mutex_);
+
+    auto bytes = file::readBinary(path);
+    if (!bytes) return 0;
+
+    const auto& blob = bytes.value();
+    BinaryHeader header{};
+    if (blob.size() < sizeof(header)) return 0;
+    std::memcpy(&header, blob.data(), sizeof(header));
+    if (header.magic != BINARY_MAGIC || header.length != blob.size() - sizeof(header)) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, blob.data() + sizeof(header),
+                    static_cast<GLsizei>(header.length));
+
+    // Drivers may reject their own old binaries (e.g. after an update with
+    // the same version string); that's a miss, not an error
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        glDeleteProgram(program);
+        std::error_code ec;
+        fs::remove(path, ec);
+        return 0;
+    }
+
+    // mtime is the LRU clock
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return program;
+}
+
+void ProgramBinaryCache::store(std::string_view vertexSource, std::string_view fragmentSource,
+                               GLuint program) {
+    if (!enabled_ || !program) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<u8> blob(sizeof(BinaryHeader) + static_cast<usize>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, blob.data() + sizeof(BinaryHeader));
+    if (written <= 0) return;
+
+    BinaryHeader header{BINARY_MAGIC, format, static_cast<u64>(written)};
+    std::memcpy(blob.data(), &header, sizeof(header));
+    blob.resize(sizeof(header) + static_cast<usize>(written));
+
+    std::lock_guard lock(mutex_);
+    if (auto result = file::writeBinary(pathFor(vertexSource, fragmentSource), blob.data(), blob.size());
+        !result) {
+        LOG_DEBUG("Program binary not cached: {}", result.error().message);
+        return;
+    }
+    evict();
+}
+
+void ProgramBinaryCache::configureDriverCache(const fs::path& dir, u64 maxBytes) {
+    if (file::ensureDir(dir).isErr()) return;
+
+    auto setDefault = [](const char* name, const std::string& value) {
+        ::setenv(name, value.c_str(), 0);
+    };
+
+    // Mesa keys entries by source, driver build and GPU; size takes K/M/G
+    setDefault("MESA_SHADER_CACHE_DIR", dir.string());
+    setDefault("MESA_SHADER_CACHE_MAX_SIZE", std::to_string(maxBytes / (1024 * 1024)) + "M");
+
+    // NVIDIA: default cache is small and pruned aggressively
+    setDefault("__GL_SHADER_DISK_CACHE", "1");
+    setDefault("__GL_SHADER_DISK_CACHE_PATH", dir.string());
+    setDefault("__GL_SHADER_DISK_CACHE_SIZE", std::to_string(maxBytes));
+    setDefault("__GL_SHADER_DISK_CACHE_SKIP_CLEANUP", "1");
+}
+
+fs::path ProgramBinaryCache::pathFor(std::string_view vertexSource,
+                                     std::string_view fragmentSource) const {
+    u64 hash = fnv1a(driverKey_);
+    hash = fnv1a(vertexSource, hash);
+    hash = fnv1a("\x1f", hash);  // Keep "ab"+"c" and "a"+"bc" apart
+    hash = fnv1a(fragmentSource, hash);
+    return dir_ / std::format("{:016x}.bin", hash);
+}
+
+void ProgramBinaryCache::evict() {
+    struct CachedFile {
+        fs::path path;
+        u64 size;
+        fs::file_time_type used;
+    };
+
+    std::vector<CachedFile> files;
+    u64 total = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir_, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".bin") continue;
+        u64 size = entry.file_size(ec);
+        files.push_back({entry.path(), size, entry.last_write_time(ec)});
+        total += size;
+    }
+
+    if (total <= maxBytes_) return;
+
+    // Oldest use first
+    std::sort(files.begin(), files.end(),
+              [](const auto& a, const auto& b) { return a.used < b.used; });
+
+    for (const auto& f : files) {
+        if (total <= maxBytes_) break;
+        if (fs::remove(f.path, ec)) {
+            total -= f.size;
+        }
+    }
+}
+
+} // namespace vc
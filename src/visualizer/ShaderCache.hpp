@@ -0,0 +1,50 @@
+#pragma once
+// ShaderCache.hpp - Linked GL programs persisted across runs
+// The GLSL compiler is fast. It's just not "every launch" fast.
+
+#include "util/Types.hpp"
+#include "util/GLIncludes.hpp"
+
+#include <mutex>
+#include <string_view>
+
+namespace vc {
+
+class ProgramBinaryCache {
+public:
+    // Files land in dir as <hash>.bin; total size kept under maxBytes
+    ProgramBinaryCache(fs::path dir, u64 maxBytes);
+
+    // With a context current: checks program binary support and records the
+    // renderer/driver so a GPU or driver change never loads a stale binary
+    bool init();
+    bool enabled() const { return enabled_; }
+
+    // Linked program for these sources, or 0 on a miss (the caller compiles)
+    GLuint load(std::string_view vertexSource, std::string_view fragmentSource);
+
+    // Persist a linked program. Set GL_PROGRAM_BINARY_RETRIEVABLE_HINT before linking.
+    void store(std::string_view vertexSource, std::string_view fragmentSource, GLuint program);
+
+    // Point Mesa's and NVIDIA's own shader disk caches (which cover shaders
+    // we don't compile ourselves, i.e. ProjectM's) at our cache directory
+    // with a bigger budget. Must run before the first GL context exists;
+    // variables the user already set are left alone.
+    static void configureDriverCache(const fs::path& dir, u64 maxBytes);
+
+    // shader_cache_mb covers both caches: our binaries and the driver's
+    // each get half, so the disk total stays what the user asked for
+    static constexpr u64 shareOf(u32 budgetMB) { return static_cast<u64>(budgetMB) * 1024 * 1024 / 2; }
+
+private:
+    fs::path pathFor(std::string_view vertexSource, std::string_view fragmentSource) const;
+    void evict();
+
+    fs::path dir_;
+    u64 maxBytes_;
+    std::string driverKey_;
+    bool enabled_{false};
+    std::mutex mutex_;
+};
+
+} // namespace vc
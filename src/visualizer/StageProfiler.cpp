@@ -0,0 +1,152 @@
+#include "StageProfiler.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace vc {
+
+namespace {
+
+struct Summary {
+    f32 avg{0.0f};
+    f32 p95{0.0f};
+    f32 max{0.0f};
+};
+
+Summary summarize(std::vector<f32> samples) {
+    Summary s;
+    if (samples.empty()) return s;
+
+    s.avg = std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();
+    s.max = *std::max_element(samples.begin(), samples.end());
+    auto p95 = samples.begin() + static_cast<std::ptrdiff_t>((samples.size() - 1) * 95 / 100);
+    std::nth_element(samples.begin(), p95, samples.end());
+    s.p95 = *p95;
+    return s;
+}
+
+} // namespace
+
+const char* renderStageName(RenderStage stage) {
+    switch (stage) {
+        case RenderStage::ProjectM:  return "ProjectM";
+        case RenderStage::Overlay:   return "Overlay";
+        case RenderStage::Composite: return "Composite";
+        case RenderStage::Readback:  return "Readback";
+        case RenderStage::Present:   return "Present";
+        default:                     return "?";
+    }
+}
+
+void StageProfiler::Ring::push(f32 ms) {
+    if (samples.size() < SAMPLE_COUNT) {
+        samples.push_back(ms);
+    } else {
+        samples[next] = ms;
+    }
+    next = (next + 1) % SAMPLE_COUNT;
+}
+
+void StageProfiler::initGL() {
+    for (auto& set : sets_) {
+        glGenQueries(static_cast<GLsizei>(set.queries.size()), set.queries.data());
+        set.issued.fill(false);
+    }
+    haveQueries_ = glGetError() == GL_NO_ERROR && sets_[0].queries[0] != 0;
+    latestGpu_.fill(-1.0f);
+    current_ = 0;
+    timingGpu_ = false;
+}
+
+void StageProfiler::releaseGL() {
+    if (haveQueries_) {
+        for (auto& set : sets_) {
+            glDeleteQueries(static_cast<GLsizei>(set.queries.size()), set.queries.data());
+            set.queries.fill(0);
+            set.issued.fill(false);
+        }
+    }
+    haveQueries_ = false;
+    timingGpu_ = false;
+}
+
+void StageProfiler::beginFrame() {
+    if (!haveQueries_) return;
+
+    // Oldest set first: by now its results are usually in
+    current_ = (current_ + 1) % FRAMES_IN_FLIGHT;
+    collect(current_);
+
+    auto& issued = sets_[current_].issued;
+    timingGpu_ = std::none_of(issued.begin(), issued.end(), [](bool b) { return b; });
+}
+
+void StageProfiler::collect(usize setIndex) {
+    auto& set = sets_[setIndex];
+    for (usize i = 0; i < RENDER_STAGE_COUNT; ++i) {
+        if (!set.issued[i]) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(set.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(set.queries[i], GL_QUERY_RESULT, &ns);
+        set.issued[i] = false;
+
+        f32 ms = static_cast<f32>(ns) / 1e6f;
+        latestGpu_[i] = ms;
+        std::lock_guard lock(mutex_);
+        gpu_[i].push(ms);
+    }
+}
+
+void StageProfiler::begin(RenderStage stage) {
+    usize i = index(stage);
+    cpuStart_[i] = std::chrono::steady_clock::now();
+    if (timingGpu_) {
+        glBeginQuery(GL_TIME_ELAPSED, sets_[current_].queries[i]);
+    }
+}
+
+void StageProfiler::end(RenderStage stage) {
+    usize i = index(stage);
+    if (timingGpu_) {
+        glEndQuery(GL_TIME_ELAPSED);
+        sets_[current_].issued[i] = true;
+    }
+
+    f32 ms = std::chrono::duration<f32, std::milli>(
+        std::chrono::steady_clock::now() - cpuStart_[i]).count();
+    std::lock_guard lock(mutex_);
+    cpu_[i].push(ms);
+}
+
+ProfileReport StageProfiler::report() const {
+    std::array<std::vector<f32>, RENDER_STAGE_COUNT> cpu, gpu;
+    {
+        std::lock_guard lock(mutex_);
+        for (usize i = 0; i < RENDER_STAGE_COUNT; ++i) {
+            cpu[i] = cpu_[i].samples;
+            gpu[i] = gpu_[i].samples;
+        }
+    }
+
+    ProfileReport report;
+    for (usize i = 0; i < RENDER_STAGE_COUNT; ++i) {
+        auto& stage = report.stages[i];
+        stage.samples = static_cast<u32>(cpu[i].size());
+        stage.hasGpu = !gpu[i].empty();
+
+        auto c = summarize(std::move(cpu[i]));
+        auto g = summarize(std::move(gpu[i]));
+        stage.cpuAvgMs = c.avg;
+        stage.cpuP95Ms = c.p95;
+        stage.gpuAvgMs = g.avg;
+        stage.gpuP95Ms = g.p95;
+        stage.gpuMaxMs = g.max;
+    }
+    return report;
+}
+
+} // namespace vc
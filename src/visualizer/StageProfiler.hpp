@@ -0,0 +1,114 @@
+#pragma once
+// StageProfiler.hpp - CPU and GPU time per render stage
+// "It's slow" is a feeling. "Overlay p95 is 9 ms" is a bug report.
+
+#include "util/Types.hpp"
+#include "util/GLIncludes.hpp"
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace vc {
+
+enum class RenderStage : u32 {
+    ProjectM,   // Preset equations and draw
+    Overlay,    // Rasterize and upload
+    Composite,  // Scene + overlay into the output target
+    Readback,   // Recorder capture (frameComposited handlers)
+    Present,    // Blit to the window, on the GUI context
+    Count
+};
+
+constexpr usize RENDER_STAGE_COUNT = static_cast<usize>(RenderStage::Count);
+
+const char* renderStageName(RenderStage stage);
+
+struct StageStats {
+    f32 cpuAvgMs{0.0f};
+    f32 cpuP95Ms{0.0f};
+    f32 gpuAvgMs{0.0f};
+    f32 gpuP95Ms{0.0f};
+    f32 gpuMaxMs{0.0f};
+    u32 samples{0};
+    bool hasGpu{false};
+};
+
+struct ProfileReport {
+    std::array<StageStats, RENDER_STAGE_COUNT> stages{};
+};
+
+// One per GL context: query objects aren't shared between contexts.
+// GL_TIME_ELAPSED queries can't nest, so stages must not overlap.
+// Results are read back FRAMES_IN_FLIGHT frames later, never stalling;
+// if they still aren't in, that frame simply goes untimed on the GPU.
+class StageProfiler {
+public:
+    StageProfiler() = default;
+
+    // With the context current. initGL() always makes fresh query objects,
+    // so call it again after a context is recreated (the old ones died with it).
+    void initGL();
+    void releaseGL();
+
+    // Owning thread, once per frame before the first stage
+    void beginFrame();
+    void begin(RenderStage stage);
+    void end(RenderStage stage);
+
+    // Most recent GPU time of a stage, negative until one has resolved
+    f32 latestGpuMs(RenderStage stage) const { return latestGpu_[index(stage)]; }
+
+    // Any thread: stats over the last SAMPLE_COUNT frames
+    ProfileReport report() const;
+
+private:
+    static usize index(RenderStage stage) { return static_cast<usize>(stage); }
+    void collect(usize set);
+
+    static constexpr usize FRAMES_IN_FLIGHT = 3;
+    static constexpr usize SAMPLE_COUNT = 240;
+
+    struct QuerySet {
+        std::array<GLuint, RENDER_STAGE_COUNT> queries{};
+        std::array<bool, RENDER_STAGE_COUNT> issued{};
+    };
+
+    struct Ring {
+        std::vector<f32> samples;
+        usize next{0};
+        void push(f32 ms);
+    };
+
+    std::array<QuerySet, FRAMES_IN_FLIGHT> sets_{};
+    usize current_{0};
+    bool haveQueries_{false};
+    bool timingGpu_{false};  // Current set's queries are free to use
+
+    std::array<std::chrono::steady_clock::time_point, RENDER_STAGE_COUNT> cpuStart_{};
+    std::array<f32, RENDER_STAGE_COUNT> latestGpu_{};
+
+    mutable std::mutex mutex_;
+    std::array<Ring, RENDER_STAGE_COUNT> cpu_{};
+    std::array<Ring, RENDER_STAGE_COUNT> gpu_{};
+};
+
+// Times a stage for the rest of the scope
+class StageScope {
+public:
+    StageScope(StageProfiler& profiler, RenderStage stage)
+        : profiler_(profiler), stage_(stage) {
+        profiler_.begin(stage_);
+    }
+    ~StageScope() { profiler_.end(stage_); }
+
+    StageScope(const StageScope&) = delete;
+    StageScope& operator=(const StageScope&) = delete;
+
+private:
+    StageProfiler& profiler_;
+    RenderStage stage_;
+};
+
+} // namespace vc
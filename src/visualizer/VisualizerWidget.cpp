@@ -7,6 +7,7 @@
 #include <QMouseEvent>
 #include <QScreen>
 #include <QGuiApplication>
+#include <algorithm>
 #include "util/GLIncludes.hpp"
 
 namespace vc {
@@ -16,13 +17,12 @@ VisualizerWidget::VisualizerWidget(QWidget* parent)
 {
     setAttribute(Qt::WA_OpaquePaintEvent);
 
-    // Set OpenGL format
+    // Set OpenGL format. No MSAA: the widget only blits finished frames.
     QSurfaceFormat format;
     format.setVersion(3, 3);
     format.setProfile(QSurfaceFormat::CoreProfile);
     format.setSwapBehavior(QSurfaceFormat::DoubleBuffer);
     format.setSwapInterval(1);  // VSync
-    format.setSamples(4);  // MSAA
     setFormat(format);
     
     // Focus for keyboard input
@@ -31,13 +31,59 @@ VisualizerWidget::VisualizerWidget(QWidget* parent)
     // FPS counter
     fpsTimer_.setInterval(1000);
     connect(&fpsTimer_, &QTimer::timeout, this, &VisualizerWidget::updateFPS);
+    
+    renderThread_ = std::make_unique<RenderThread>(projectM_);
+    
+    // Stage timings drawn over the visuals; child widgets follow us into fullscreen
+    debugLabel_ = new QLabel(this);
+    debugLabel_->setStyleSheet(
+        "background-color: rgba(0, 0, 0, 170); color: #00ff88;"
+        "font-family: monospace; font-size: 11px; padding: 6px;");
+    debugLabel_->setAttribute(Qt::WA_TransparentForMouseEvents);
+    debugLabel_->move(8, 8);
+    debugLabel_->setVisible(CONFIG.ui().showDebugPanel);
+    
+    // Recording readback runs on the render thread, context current
+    renderThread_->frameComposited.connect([this](RenderTarget&) {
+        if (recording_) {
+            emit frameReady();
+        }
+    });
+    
+    // Timed preset switches are picked on this thread, which owns the list
+    projectM_.presetSwitchRequested.connect([this] {
+        QMetaObject::invokeMethod(this, [this] { projectM_.advancePreset(); });
+    });
+    
+    // Swap timing feeds the pacer's vsync alignment
+    connect(this, &QOpenGLWidget::frameSwapped, this, [this] {
+        renderThread_->notePresent();
+    });
+    
+    // One pending repaint at a time; a stalled GUI thread just presents
+    // the newest frame when it comes back
+    renderThread_->frameFinished.connect([this] {
+        if (!updatePending_.exchange(true)) {
+            QMetaObject::invokeMethod(this, [this] {
+                updatePending_ = false;
+                update();
+            }, Qt::QueuedConnection);
+        }
+    });
 }
 
 VisualizerWidget::~VisualizerWidget() {
+    thumbnailer_.stop();
+    
+    // Shuts ProjectM down on the thread that owns it
+    renderThread_->stop();
+    
     makeCurrent();
-    projectM_.shutdown();
-    renderTarget_.destroy();
-    overlayTarget_.destroy();
+    presentProfiler_.releaseGL();
+    if (presentFbo_) {
+        glDeleteFramebuffers(1, &presentFbo_);
+        presentFbo_ = 0;
+    }
     doneCurrent();
 }
 
@@ -52,6 +98,13 @@ void VisualizerWidget::initializeGL() {
     
     initializeOpenGLFunctions();
     
+    // Reparenting (fullscreen) recreates this context; the render thread
+    // shares with the global context, so only the wrapper FBO is redone
+    glGenFramebuffers(1, &presentFbo_);
+    presentProfiler_.initGL();
+    
+    if (initialized_) return;
+    
     LOG_INFO("OpenGL: {} - {}", 
              reinterpret_cast<const char*>(glGetString(GL_VERSION)),
              reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
@@ -68,18 +121,33 @@ void VisualizerWidget::initializeGL() {
     pmConfig.presetDuration = vizConfig.presetDuration;
     pmConfig.transitionDuration = vizConfig.smoothPresetDuration;
     pmConfig.shufflePresets = vizConfig.shufflePresets;
+    pmConfig.preloadCount = vizConfig.preloadPresets;
+    pmConfig.shaderCacheMB = vizConfig.shaderCacheMB;
+    pmConfig.meshX = vizConfig.meshWidth;
+    pmConfig.meshY = vizConfig.meshHeight;
+    pmConfig.autoMesh = vizConfig.autoMesh;
+    pmConfig.skipSlowPresets = vizConfig.skipSlowPresets;
+    pmConfig.pacePresets = vizConfig.pacePresets;
+    
+    targetFps_ = vizConfig.fps;
+    renderThread_->setOverlayEngine(overlayEngine_);
+    renderThread_->setVsyncAlign(vizConfig.vsyncAlign);
     
-    if (auto result = projectM_.init(pmConfig); !result) {
-        LOG_ERROR("ProjectM init failed: {}", result.error().message);
+    const auto& dynCfg = vizConfig.dynamicResolution;
+    renderThread_->setDynamicResolution(
+        {dynCfg.enabled, dynCfg.minScale, dynCfg.maxScale, dynCfg.whileRecording},
+        dynCfg.sharpness);
+    
+    if (auto result = renderThread_->start(pmConfig, format()); !result) {
+        LOG_ERROR("Render thread failed to start: {}", result.error().message);
         return;
     }
     
-    // Create render targets
-    renderTarget_.create(width(), height());
-    overlayTarget_.create(width(), height());
-    
-    // Connect render timer timeout
-    connect(&renderTimer_, &QTimer::timeout, this, &VisualizerWidget::onTimer);
+    if (vizConfig.presetThumbnails) {
+        if (auto result = thumbnailer_.start(format()); !result) {
+            LOG_WARN("Preset thumbnails disabled: {}", result.error().message);
+        }
+    }
     
     fpsTimer_.start();
     
@@ -90,66 +158,52 @@ void VisualizerWidget::initializeGL() {
 void VisualizerWidget::resizeGL(int w, int h) {
     if (!initialized_) return;
     
-    projectM_.resize(w, h);
-    
-    if (!recording_) {
-        renderTarget_.resize(w, h);
-        overlayTarget_.resize(w, h);
-    }
+    // The render thread resizes ProjectM and its targets on the next frame
+    renderThread_->setViewSize(w, h);
 }
 
 void VisualizerWidget::paintGL() {
     if (!initialized_) return;
-    renderFrame();
+    present();
 }
 
-void VisualizerWidget::onTimer() {
-    update();  // Trigger paintGL
-}
-
-void VisualizerWidget::renderFrame() {
-    // Render to target (either widget size or recording size)
-    u32 targetW = recording_ ? recordWidth_ : width();
-    u32 targetH = recording_ ? recordHeight_ : height();
-    
-    // Ensure render target is correct size
-    if (renderTarget_.width() != targetW || renderTarget_.height() != targetH) {
-        renderTarget_.resize(targetW, targetH);
-        overlayTarget_.resize(targetW, targetH);
+void VisualizerWidget::present() {
+    PresentedFrame frame;
+    if (!renderThread_->acquire(frame)) {
+        glClearColor(0, 0, 0, 1);
+        glClear(GL_COLOR_BUFFER_BIT);
+        return;
     }
     
-    // Render ProjectM to target
-    projectM_.renderToTarget(renderTarget_);
+    presentProfiler_.beginFrame();
+    StageScope stage(presentProfiler_, RenderStage::Present);
     
-    // Render overlay on top
-    if (overlayEngine_) {
-        overlayTarget_.bind();
-        glClearColor(0, 0, 0, 0);
-        glClear(GL_COLOR_BUFFER_BIT);
-        
-        // Blit visualizer first
-        renderTarget_.blitTo(overlayTarget_, true);
-        
-        // Then render overlay
-        overlayEngine_->render(overlayTarget_.width(), overlayTarget_.height());
-        overlayTarget_.unbind();
-        
-        // Blit result to screen
-        overlayTarget_.blitToScreen(width(), height(), true);
-    } else {
-        // Just blit visualizer to screen
-        renderTarget_.blitToScreen(width(), height(), true);
-    }
+    // FBOs aren't shared between contexts, textures are
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, presentFbo_);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, frame.texture, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebufferObject());
     
-    ++frameCount_;
+    glBlitFramebuffer(
+        0, 0, frame.width, frame.height,
+        0, 0, width(), height(),
+        GL_COLOR_BUFFER_BIT, GL_LINEAR
+    );
     
-    if (recording_) {
-        emit frameReady();
-    }
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebufferObject());
+    
+    renderThread_->release();
+}
+
+void VisualizerWidget::setOverlayEngine(OverlayEngine* engine) {
+    overlayEngine_ = engine;
+    renderThread_->setOverlayEngine(engine);
 }
 
-void VisualizerWidget::renderOverlay() {
-    // Overlay rendering is handled in renderFrame()
+RenderTarget& VisualizerWidget::outputTarget() {
+    return renderThread_->currentTarget();
 }
 
 void VisualizerWidget::feedAudio(const f32* data, u32 frames, u32 channels) {
@@ -157,15 +211,18 @@ void VisualizerWidget::feedAudio(const f32* data, u32 frames, u32 channels) {
 }
 
 void VisualizerWidget::setRenderRate(int fps) {
+    targetFps_ = std::max(fps, 0);
+    renderThread_->setFps(targetFps_);
     if (fps > 0) {
-        targetFps_ = fps;
-        renderTimer_.start(1000 / fps);
         projectM_.setFPS(fps);
-    } else {
-        renderTimer_.stop();
     }
 }
 
+void VisualizerWidget::setRenderScale(f32 scale) {
+    // Applied on the next frame; the render thread resizes its targets
+    renderThread_->setRenderScale(scale);
+}
+
 void VisualizerWidget::setRecordingSize(u32 width, u32 height) {
     recordWidth_ = width;
     recordHeight_ = height;
@@ -173,19 +230,13 @@ void VisualizerWidget::setRecordingSize(u32 width, u32 height) {
 
 void VisualizerWidget::startRecording() {
     recording_ = true;
-    makeCurrent();
-    renderTarget_.resize(recordWidth_, recordHeight_);
-    overlayTarget_.resize(recordWidth_, recordHeight_);
-    doneCurrent();
+    renderThread_->setRecording(true, recordWidth_, recordHeight_);
     LOG_INFO("Started recording at {}x{}", recordWidth_, recordHeight_);
 }
 
 void VisualizerWidget::stopRecording() {
     recording_ = false;
-    makeCurrent();
-    renderTarget_.resize(width(), height());
-    overlayTarget_.resize(width(), height());
-    doneCurrent();
+    renderThread_->setRecording(false, recordWidth_, recordHeight_);
     LOG_INFO("Stopped recording");
 }
 
@@ -213,9 +264,57 @@ void VisualizerWidget::toggleFullscreen() {
 }
 
 void VisualizerWidget::updateFPS() {
-    actualFps_ = static_cast<f32>(frameCount_);
-    frameCount_ = 0;
+    // Mean over the pacer's window rather than a whole-second frame count
+    auto stats = renderThread_->frameStats();
+    actualFps_ = stats.fps;
     emit fpsChanged(actualFps_);
+    emit frameStatsChanged(stats);
+    
+    // Render thread stages plus our own present
+    auto report = renderThread_->profile();
+    auto present = static_cast<usize>(RenderStage::Present);
+    report.stages[present] = presentProfiler_.report().stages[present];
+    emit profileChanged(report);
+    
+    if (debugLabel_->isVisible()) {
+        updateDebugOverlay(stats, report);
+    }
+}
+
+void VisualizerWidget::toggleDebugOverlay() {
+    debugLabel_->setVisible(!debugLabel_->isVisible());
+    debugLabel_->raise();
+    if (debugLabel_->isVisible()) {
+        updateDebugOverlay(renderThread_->frameStats(), renderThread_->profile());
+    }
+}
+
+void VisualizerWidget::updateDebugOverlay(const FrameTimeStats& stats, const ProfileReport& report) {
+    QString text = QString("%1 fps  p95 %2 ms  p99 %3 ms  scale %4%\n")
+        .arg(stats.fps, 0, 'f', 1)
+        .arg(stats.p95Ms, 0, 'f', 2)
+        .arg(stats.p99Ms, 0, 'f', 2)
+        .arg(qRound(stats.renderScale * 100.0f));
+    text += QString("%1 %2 %3 %4\n")
+        .arg(QString("stage"), -10)
+        .arg(QString("cpu avg/p95"), 14)
+        .arg(QString("gpu avg/p95"), 14)
+        .arg(QString("gpu max"), 8);
+    
+    for (usize i = 0; i < RENDER_STAGE_COUNT; ++i) {
+        const auto& s = report.stages[i];
+        QString cpu = QString("%1/%2").arg(s.cpuAvgMs, 0, 'f', 2).arg(s.cpuP95Ms, 0, 'f', 2);
+        QString gpu = s.hasGpu
+            ? QString("%1/%2").arg(s.gpuAvgMs, 0, 'f', 2).arg(s.gpuP95Ms, 0, 'f', 2)
+            : QString("-");
+        QString max = s.hasGpu ? QString::number(s.gpuMaxMs, 'f', 2) : QString("-");
+        text += QString("%1 %2 %3 %4\n")
+            .arg(QString::fromLatin1(renderStageName(static_cast<RenderStage>(i))), -10)
+            .arg(cpu, 14).arg(gpu, 14).arg(max, 8);
+    }
+    
+    debugLabel_->setText(text.trimmed());
+    debugLabel_->adjustSize();
 }
 
 void VisualizerWidget::keyPressEvent(QKeyEvent* event) {
@@ -242,6 +341,9 @@ void VisualizerWidget::keyPressEvent(QKeyEvent* event) {
     else if (event->key() == Qt::Key_L) {
         projectM_.lockPreset(!projectM_.isPresetLocked());
     }
+    else if (event->key() == Qt::Key_F3) {
+        toggleDebugOverlay();
+    }
     else if (event->key() == Qt::Key_Escape && fullscreen_) {
         toggleFullscreen();
     }
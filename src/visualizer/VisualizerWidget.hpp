@@ -5,10 +5,15 @@
 #include "util/Types.hpp"
 #include "ProjectMBridge.hpp"
 #include "RenderTarget.hpp"
+#include "RenderThread.hpp"
+#include "StageProfiler.hpp"
+#include "PresetThumbnailer.hpp"
 
+#include <QLabel>
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QTimer>
+#include <atomic>
 #include <memory>
 
 namespace vc {
@@ -25,12 +30,16 @@ public:
     // ProjectM access
     ProjectMBridge& projectM() { return projectM_; }
     const ProjectMBridge& projectM() const { return projectM_; }
+    PresetThumbnailer& thumbnailer() { return thumbnailer_; }
     
     // Overlay
-    void setOverlayEngine(OverlayEngine* engine) { overlayEngine_ = engine; }
+    void setOverlayEngine(OverlayEngine* engine);
     
-    // Recording support
-    RenderTarget& renderTarget() { return renderTarget_; }
+    // Recording support. Rendering happens on a dedicated thread: frameReady
+    // is emitted there with its GL context current, so connect with
+    // Qt::DirectConnection and read outputTarget() inside the slot.
+    RenderTarget& outputTarget();  // Final composited frame
+    void setRenderScale(f32 scale);  // ProjectM resolution relative to output
     void setRecordingSize(u32 width, u32 height);
     bool isRecording() const { return recording_; }
     void startRecording();
@@ -40,10 +49,13 @@ public:
 
 public slots:
     void toggleFullscreen();
+    void toggleDebugOverlay();
     
 signals:
-    void frameReady();  // Emitted after each frame render (for recording)
+    void frameReady();  // Emitted on the render thread after each frame (for recording)
     void fpsChanged(f32 actualFps);
+    void frameStatsChanged(const FrameTimeStats& stats);  // Once a second
+    void profileChanged(const ProfileReport& report);     // Once a second, all stages
     
 protected:
     void initializeGL() override;
@@ -54,28 +66,29 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent* event) override;
     
 private slots:
-    void onTimer();
     void updateFPS();
     
 private:
-    void renderFrame();
-    void renderOverlay();
+    void present();
+    void updateDebugOverlay(const FrameTimeStats& stats, const ProfileReport& report);
     
     ProjectMBridge projectM_;
+    std::unique_ptr<RenderThread> renderThread_;
+    PresetThumbnailer thumbnailer_;
     OverlayEngine* overlayEngine_{nullptr};
     
-    RenderTarget renderTarget_;
-    RenderTarget overlayTarget_;
+    GLuint presentFbo_{0};      // Wraps the render thread's texture in this context
+    StageProfiler presentProfiler_;  // This context's half of the stage timings
+    QLabel* debugLabel_{nullptr};
+    std::atomic<bool> updatePending_{false};
     
-    QTimer renderTimer_;
     QTimer fpsTimer_;
     
-    bool recording_{false};
+    std::atomic<bool> recording_{false};
     u32 recordWidth_{1920};
     u32 recordHeight_{1080};
     
     u32 targetFps_{60};
-    u32 frameCount_{0};
     f32 actualFps_{0.0f};
     
     bool initialized_{false};
@@ -0,0 +1,235 @@
+// StreamSinkTest.cpp - StreamSink against real reader processes on a FIFO
+// The slow-reader case is the whole point of the thing, so test that one
+
+#include "recorder/StreamSink.hpp"
+#include "recorder/EncoderSettings.hpp"
+#include "core/Logger.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+using namespace vc;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::cerr << "  FAILED: " #cond " (" << __FILE__ << ":" << __LINE__ << ")\n"; \
+        ++failures; \
+    } \
+} while (0)
+
+using Clock = std::chrono::steady_clock;
+
+f64 secondsSince(Clock::time_point start) {
+    return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+struct Reader {
+    pid_t pid{-1};
+    int result{-1};     // Read end of a pipe the reader reports its byte count on
+};
+
+// Fork a reader that opens the FIFO and runs `body` on it. Forked before
+// the sink starts its thread, so the child is single-threaded.
+Reader spawnReader(const fs::path& fifo, const std::function<u64(int fd)>& body) {
+    int report[2];
+    if (::pipe(report) != 0) std::abort();
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::close(report[0]);
+        int fd = ::open(fifo.c_str(), O_RDONLY);
+        u64 total = fd >= 0 ? body(fd) : 0;
+        [[maybe_unused]] auto n = ::write(report[1], &total, sizeof(total));
+        ::_exit(0);
+    }
+
+    ::close(report[1]);
+    return {pid, report[0]};
+}
+
+u64 finishReader(Reader& reader, bool kill) {
+    if (kill) ::kill(reader.pid, SIGKILL);
+    u64 total = 0;
+    if (!kill && ::read(reader.result, &total, sizeof(total)) != sizeof(total)) total = 0;
+    ::close(reader.result);
+    ::waitpid(reader.pid, nullptr, 0);
+    return total;
+}
+
+// The FIFO open fails until the reader has it open too
+bool openSink(StreamSink& sink, const fs::path& fifo, u32 bufferKB) {
+    StreamSettings settings;
+    settings.target = OutputTarget::Pipe;
+    settings.path = fifo;
+    settings.bufferKB = bufferKB;
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (Clock::now() < deadline) {
+        if (sink.open(settings)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+void testSlowReaderDrainsOnClose(const fs::path& fifo) {
+    std::cout << "slow reader: everything queued arrives, close drains\n";
+
+    // 16 KB every 2 ms: slower than we write, never stalled
+    Reader reader = spawnReader(fifo, [](int fd) {
+        std::vector<u8> buf(16 * 1024);
+        u64 total = 0;
+        ssize_t n;
+        while ((n = ::read(fd, buf.data(), buf.size())) > 0) {
+            total += static_cast<u64>(n);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return total;
+    });
+
+    StreamSink sink;
+    CHECK(openSink(sink, fifo, 64));
+
+    const usize chunkSize = 32 * 1024;
+    const usize chunks = 128;   // 4 MB, well past the pipe and the queue
+    std::vector<u8> chunk(chunkSize, 0x5a);
+    bool allWritten = true;
+    for (usize i = 0; i < chunks; ++i) {
+        allWritten &= sink.write(chunk.data(), chunk.size());
+    }
+    CHECK(allWritten);
+
+    sink.close();
+    CHECK(!sink.failed());
+    CHECK(sink.bytesSent() == chunkSize * chunks);
+    CHECK(finishReader(reader, false) == chunkSize * chunks);
+}
+
+void testStalledReaderFailsWrite(const fs::path& fifo) {
+    std::cout << "stalled reader: write gives up, close returns\n";
+
+    // Opens the FIFO and never reads
+    Reader reader = spawnReader(fifo, [](int) {
+        ::pause();
+        return u64{0};
+    });
+
+    StreamSink sink;
+    CHECK(openSink(sink, fifo, 64));
+
+    std::vector<u8> chunk(32 * 1024, 0xa5);
+    auto start = Clock::now();
+    bool ok = true;
+    while (ok && secondsSince(start) < 30.0) {
+        ok = sink.write(chunk.data(), chunk.size());
+    }
+    CHECK(!ok);
+    CHECK(sink.failed());
+    CHECK(secondsSince(start) < 10.0);
+
+    // The writer is parked on a full pipe: close must not wait on it forever
+    auto closeStart = Clock::now();
+    sink.close();
+    CHECK(secondsSince(closeStart) < 2.0);
+
+    finishReader(reader, true);
+}
+
+void testCloseWhileReaderStalled(const fs::path& fifo) {
+    std::cout << "stalled reader: close with a backlog is bounded\n";
+
+    Reader reader = spawnReader(fifo, [](int) {
+        ::pause();
+        return u64{0};
+    });
+
+    StreamSink sink;
+    CHECK(openSink(sink, fifo, 256));
+
+    // Fill the pipe, then leave the queue backlogged without hitting the
+    // write timeout. Backlogged after a pause means the writer is stuck.
+    std::vector<u8> chunk(16 * 1024, 0x3c);
+    auto start = Clock::now();
+    bool stuck = false;
+    while (!stuck && secondsSince(start) < 10.0) {
+        CHECK(sink.write(chunk.data(), chunk.size()));
+        if (sink.backlogged()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            stuck = sink.backlogged();
+        }
+    }
+    CHECK(stuck);
+
+    auto closeStart = Clock::now();
+    sink.close();
+    f64 closeSeconds = secondsSince(closeStart);
+    CHECK(closeSeconds < 10.0);
+    CHECK(sink.failed());   // Gave up draining
+
+    finishReader(reader, true);
+}
+
+void testReaderHangsUp(const fs::path& fifo) {
+    std::cout << "reader exits: writes fail instead of raising SIGPIPE\n";
+
+    // Reads a little, then goes away
+    Reader reader = spawnReader(fifo, [](int fd) {
+        std::vector<u8> buf(4096);
+        auto n = ::read(fd, buf.data(), buf.size());
+        return static_cast<u64>(std::max<ssize_t>(n, 0));
+    });
+
+    StreamSink sink;
+    CHECK(openSink(sink, fifo, 64));
+
+    std::vector<u8> chunk(32 * 1024, 0x11);
+    auto start = Clock::now();
+    bool ok = true;
+    while (ok && secondsSince(start) < 10.0) {
+        ok = sink.write(chunk.data(), chunk.size());
+    }
+    CHECK(!ok);
+
+    sink.close();
+    finishReader(reader, false);
+}
+
+} // namespace
+
+int main() {
+    auto dir = fs::temp_directory_path() / ("vc-stream-test-" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    auto fifo = dir / "stream.fifo";
+    if (::mkfifo(fifo.c_str(), 0600) != 0) {
+        std::cerr << "mkfifo failed\n";
+        return 1;
+    }
+
+    testSlowReaderDrainsOnClose(fifo);
+    testStalledReaderFailsWrite(fifo);
+    testCloseWhileReaderStalled(fifo);
+    testReaderHangsUp(fifo);
+
+    fs::remove_all(dir);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all passed\n";
+    return 0;
+}